@@ -186,8 +186,8 @@ Objects = [
 	]),
 
 	NetObject("GameDataFlag", [
-		NetIntRange("m_FlagCarrierRed", 'FLAG_MISSING', 'MAX_CLIENTS-1'),
-		NetIntRange("m_FlagCarrierBlue", 'FLAG_MISSING', 'MAX_CLIENTS-1'),
+		NetIntRange("m_FlagCarrierRed", 'FLAG_MISSING', 'PROTOCOL_MAX_CLIENTS-1'),
+		NetIntRange("m_FlagCarrierBlue", 'FLAG_MISSING', 'PROTOCOL_MAX_CLIENTS-1'),
 		NetTick("m_FlagDropTickRed"),
 		NetTick("m_FlagDropTickBlue"),
 	]),
@@ -203,7 +203,7 @@ Objects = [
 		NetIntRange("m_Direction", -1, 1),
 
 		NetIntRange("m_Jumped", 0, 3),
-		NetIntRange("m_HookedPlayer", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_HookedPlayer", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntRange("m_HookState", -1, 5),
 		NetTick("m_HookTick"),
 
@@ -231,7 +231,7 @@ Objects = [
 
 	NetObject("SpectatorInfo", [
 		NetIntRange("m_SpecMode", 0, 'NUM_SPECMODES-1'),
-		NetIntRange("m_SpectatorID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_SpectatorID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntAny("m_X"),
 		NetIntAny("m_Y"),
 	]),
@@ -280,7 +280,7 @@ Objects = [
 	NetEvent("HammerHit:Common", []),
 
 	NetEvent("Death:Common", [
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 	]),
 
 	NetEvent("SoundWorld:Common", [
@@ -288,7 +288,7 @@ Objects = [
 	]),
 
 	NetEvent("Damage:Common", [ # Unused yet
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntAny("m_Angle"),
 		NetIntRange("m_HealthAmount", 0, 9),
 		NetIntRange("m_ArmorAmount", 0, 9),
@@ -371,21 +371,21 @@ Messages = [
 
 	NetMessage("Sv_Chat", [
 		NetIntRange("m_Mode", 0, 'NUM_CHATS-1'),
-		NetIntRange("m_ClientID", -1, 'MAX_CLIENTS-1'),
-		NetIntRange("m_TargetID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
+		NetIntRange("m_TargetID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetStringStrict("m_pMessage"),
 	]),
 
 	NetMessage("Sv_Team", [
-		NetIntRange("m_ClientID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntRange("m_Team", 'TEAM_SPECTATORS', 'TEAM_BLUE'),
 		NetBool("m_Silent"),
 		NetTick("m_CooldownTick"),
 	]),
 
 	NetMessage("Sv_KillMsg", [
-		NetIntRange("m_Killer", -2, 'MAX_CLIENTS-1'),
-		NetIntRange("m_Victim", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_Killer", -2, 'PROTOCOL_MAX_CLIENTS-1'),
+		NetIntRange("m_Victim", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntRange("m_Weapon", -3, 'NUM_WEAPONS-1'),
 		NetIntAny("m_ModeSpecial"),
 	]),
@@ -399,7 +399,7 @@ Messages = [
 	]),
 
 	NetMessage("Sv_Emoticon", [
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetEnum("m_Emoticon", Emoticons),
 	]),
 
@@ -416,7 +416,7 @@ Messages = [
 	]),
 
 	NetMessage("Sv_VoteSet", [
-		NetIntRange("m_ClientID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetEnum("m_Type", Votes),
 		NetIntRange("m_Timeout", 0, 60),
 		NetStringStrict("m_pDescription"),
@@ -424,23 +424,23 @@ Messages = [
 	]),
 
 	NetMessage("Sv_VoteStatus", [
-		NetIntRange("m_Yes", 0, 'MAX_CLIENTS'),
-		NetIntRange("m_No", 0, 'MAX_CLIENTS'),
-		NetIntRange("m_Pass", 0, 'MAX_CLIENTS'),
-		NetIntRange("m_Total", 0, 'MAX_CLIENTS'),
+		NetIntRange("m_Yes", 0, 'PROTOCOL_MAX_CLIENTS'),
+		NetIntRange("m_No", 0, 'PROTOCOL_MAX_CLIENTS'),
+		NetIntRange("m_Pass", 0, 'PROTOCOL_MAX_CLIENTS'),
+		NetIntRange("m_Total", 0, 'PROTOCOL_MAX_CLIENTS'),
 	]),
 
 	NetMessage("Sv_ServerSettings", [
 		NetBool("m_KickVote"),
-		NetIntRange("m_KickMin", 0, 'MAX_CLIENTS'),
+		NetIntRange("m_KickMin", 0, 'PROTOCOL_MAX_CLIENTS'),
 		NetBool("m_SpecVote"),
 		NetBool("m_TeamLock"),
 		NetBool("m_TeamBalance"),
-		NetIntRange("m_PlayerSlots", 0, 'MAX_CLIENTS'),
+		NetIntRange("m_PlayerSlots", 0, 'PROTOCOL_MAX_CLIENTS'),
 	]),
 
 	NetMessage("Sv_ClientInfo", [
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetBool("m_Local"),
 		NetIntRange("m_Team", 'TEAM_SPECTATORS', 'TEAM_BLUE'),
 		NetStringStrict("m_pName"),
@@ -463,7 +463,7 @@ Messages = [
 	]),
 
 	NetMessage("Sv_ClientDrop", [
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetStringStrict("m_pReason"),
 		NetBool("m_Silent"),
 	]),
@@ -473,20 +473,20 @@ Messages = [
 	## Demo messages
 	NetMessage("De_ClientEnter", [
 		NetStringStrict("m_pName"),
-		NetIntRange("m_ClientID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntRange("m_Team", 'TEAM_SPECTATORS', 'TEAM_BLUE'),
 	]),
 
 	NetMessage("De_ClientLeave", [
 		NetStringStrict("m_pName"),
-		NetIntRange("m_ClientID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetStringStrict("m_pReason"),
 	]),
 
 	### Client messages
 	NetMessage("Cl_Say", [
 		NetIntRange("m_Mode", 0, 'NUM_CHATS-1'),
-		NetIntRange("m_Target", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_Target", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetStringStrict("m_pMessage"),
 	]),
 
@@ -496,7 +496,7 @@ Messages = [
 
 	NetMessage("Cl_SetSpectatorMode", [
 		NetIntRange("m_SpecMode", 0, 'NUM_SPECMODES-1'),
-		NetIntRange("m_SpectatorID", -1, 'MAX_CLIENTS-1'),
+		NetIntRange("m_SpectatorID", -1, 'PROTOCOL_MAX_CLIENTS-1'),
 	]),
 
 	NetMessage("Cl_StartInfo", [
@@ -529,7 +529,7 @@ Messages = [
 
 	# todo 0.8: move up
 	NetMessage("Sv_SkinChange", [
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetArray(NetStringStrict("m_apSkinPartNames"), 6),
 		NetArray(NetBool("m_aUseCustomColors"), 6),
 		NetArray(NetIntAny("m_aSkinPartColors"), 6),
@@ -543,7 +543,7 @@ Messages = [
     
 	## Race
 	NetMessage("Sv_RaceFinish", [
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetIntRange("m_Time", -1, 'max_int'),
 		NetIntAny("m_Diff"),
 		NetBool("m_RecordPersonal"),
@@ -594,7 +594,7 @@ Messages = [
     # mmotee send equip items
     NetMessage("Sv_EquipItems", 
 	[
-		NetIntRange("m_ClientID", 0, 'MAX_CLIENTS-1'),
+		NetIntRange("m_ClientID", 0, 'PROTOCOL_MAX_CLIENTS-1'),
 		NetArray(NetIntAny("m_EquipID"),  9),
 		NetArray(NetBool("m_EnchantItem"),  9),
 	]),
@@ -49,9 +49,20 @@ T bezier(const T p0, const T p1, const T p2, const T p3, TB amount)
 	return mix(c20, c21, amount); // c30
 }
 
-inline int random_int() { return (((rand() & 0xffff) << 16) | (rand() & 0xffff)) & 0x7FFFFFFF; };
+// the state is per thread, the game worlds tick in parallel (xorshift seeded by rand once per thread)
+inline unsigned random_bits()
+{
+	static thread_local unsigned s_State = 0;
+	if(!s_State)
+		s_State = ((((unsigned)rand() & 0xffff) << 16) | ((unsigned)rand() & 0xffff)) | 1;
+	s_State ^= s_State << 13;
+	s_State ^= s_State >> 17;
+	s_State ^= s_State << 5;
+	return s_State;
+}
+inline int random_int() { return (int)(random_bits() & 0x7FFFFFFF); };
 inline int random_num(int min, int max) { return (random_int() % (max - min + 1)) + min; }
-inline float frandom() { return rand()/(float)(RAND_MAX); }
+inline float frandom() { return (random_bits() & 0xffffff)/(float)0xffffff; }
 inline float frandom_num(float min, float max) { return (frandom() * (max - min)) + min; }
 inline float centrelized_frandom(float center, float range) { return (center - range) + (frandom() * (range * 2.0f)); }
 
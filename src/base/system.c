@@ -1,5 +1,10 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+/* recvmmsg and sendmmsg */
+#if (defined(__LINUX__) || defined(__linux__)) && !defined(_GNU_SOURCE)
+	#define _GNU_SOURCE
+#endif
+
 #include "system.h"
 
 #include <stdlib.h>
@@ -56,6 +61,11 @@
 	#include <sys/filio.h>
 #endif
 
+#if defined(CONF_PLATFORM_LINUX) && defined(MSG_WAITFORONE)
+	#define CONF_NET_MMSG 1
+	#define NET_UDP_BATCH_SIZE 64
+#endif
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -1136,6 +1146,40 @@ NETSOCKET net_udp_create(NETADDR bindaddr, int use_random_port)
 	return sock;
 }
 
+static int priv_net_udp_target(const NETADDR *addr, int type, struct sockaddr_storage *dest)
+{
+	if(type == NETTYPE_IPV4)
+	{
+		struct sockaddr_in *sa = (struct sockaddr_in *)dest;
+		if(addr->type&NETTYPE_LINK_BROADCAST)
+		{
+			mem_zero(sa, sizeof(*sa));
+			sa->sin_port = htons(addr->port);
+			sa->sin_family = AF_INET;
+			sa->sin_addr.s_addr = INADDR_BROADCAST;
+		}
+		else
+			netaddr_to_sockaddr_in(addr, sa);
+		return sizeof(*sa);
+	}
+	else
+	{
+		struct sockaddr_in6 *sa = (struct sockaddr_in6 *)dest;
+		if(addr->type&NETTYPE_LINK_BROADCAST)
+		{
+			mem_zero(sa, sizeof(*sa));
+			sa->sin6_port = htons(addr->port);
+			sa->sin6_family = AF_INET6;
+			sa->sin6_addr.s6_addr[0] = 0xff; /* multicast */
+			sa->sin6_addr.s6_addr[1] = 0x02; /* link local scope */
+			sa->sin6_addr.s6_addr[15] = 1; /* all nodes */
+		}
+		else
+			netaddr_to_sockaddr_in6(addr, sa);
+		return sizeof(*sa);
+	}
+}
+
 int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size)
 {
 	int d = -1;
@@ -1144,18 +1188,10 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 	{
 		if(sock.ipv4sock >= 0)
 		{
-			struct sockaddr_in sa;
-			if(addr->type&NETTYPE_LINK_BROADCAST)
-			{
-				mem_zero(&sa, sizeof(sa));
-				sa.sin_port = htons(addr->port);
-				sa.sin_family = AF_INET;
-				sa.sin_addr.s_addr = INADDR_BROADCAST;
-			}
-			else
-				netaddr_to_sockaddr_in(addr, &sa);
-
-			d = sendto((int)sock.ipv4sock, (const char*)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+			struct sockaddr_storage sa;
+			int salen = priv_net_udp_target(addr, NETTYPE_IPV4, &sa);
+			d = sendto((int)sock.ipv4sock, (const char*)data, size, 0, (struct sockaddr *)&sa, salen);
+			network_stats.sent_calls++;
 		}
 		else
 			dbg_msg("net", "can't sent ipv4 traffic to this socket");
@@ -1165,20 +1201,10 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 	{
 		if(sock.ipv6sock >= 0)
 		{
-			struct sockaddr_in6 sa;
-			if(addr->type&NETTYPE_LINK_BROADCAST)
-			{
-				mem_zero(&sa, sizeof(sa));
-				sa.sin6_port = htons(addr->port);
-				sa.sin6_family = AF_INET6;
-				sa.sin6_addr.s6_addr[0] = 0xff; /* multicast */
-				sa.sin6_addr.s6_addr[1] = 0x02; /* link local scope */
-				sa.sin6_addr.s6_addr[15] = 1; /* all nodes */
-			}
-			else
-				netaddr_to_sockaddr_in6(addr, &sa);
-
-			d = sendto((int)sock.ipv6sock, (const char*)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+			struct sockaddr_storage sa;
+			int salen = priv_net_udp_target(addr, NETTYPE_IPV6, &sa);
+			d = sendto((int)sock.ipv6sock, (const char*)data, size, 0, (struct sockaddr *)&sa, salen);
+			network_stats.sent_calls++;
 		}
 		else
 			dbg_msg("net", "can't sent ipv6 traffic to this socket");
@@ -1227,6 +1253,7 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, void *data, int maxsize)
 		sockaddr_to_netaddr((struct sockaddr *)&sockaddrbuf, addr);
 		network_stats.recv_bytes += bytes;
 		network_stats.recv_packets++;
+		network_stats.recv_calls++;
 		return bytes;
 	}
 	else if(bytes == 0)
@@ -1234,6 +1261,133 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, void *data, int maxsize)
 	return -1; /* error */
 }
 
+int net_udp_recv_batch(NETSOCKET sock, NETADDR *addrs, unsigned char *data, int *sizes, int maxsize, int max_packets)
+{
+	int num = 0;
+#if defined(CONF_NET_MMSG)
+	struct mmsghdr msgs[NET_UDP_BATCH_SIZE];
+	struct iovec iovecs[NET_UDP_BATCH_SIZE];
+	struct sockaddr_storage sockaddrs[NET_UDP_BATCH_SIZE];
+	int sockets[2];
+	int s, i, count, received;
+
+	sockets[0] = sock.ipv4sock;
+	sockets[1] = sock.ipv6sock;
+	for(s = 0; s < 2 && num < max_packets; s++)
+	{
+		if(sockets[s] < 0)
+			continue;
+
+		count = max_packets - num < NET_UDP_BATCH_SIZE ? max_packets - num : NET_UDP_BATCH_SIZE;
+		mem_zero(msgs, sizeof(struct mmsghdr) * count);
+		for(i = 0; i < count; i++)
+		{
+			iovecs[i].iov_base = data + (num + i) * maxsize;
+			iovecs[i].iov_len = maxsize;
+			msgs[i].msg_hdr.msg_name = &sockaddrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddrs[i]);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		/* the socket is non-blocking, so this returns what is already queued */
+		received = recvmmsg(sockets[s], msgs, count, 0, NULL);
+		if(received <= 0)
+			continue;
+
+		network_stats.recv_calls++;
+		for(i = 0; i < received; i++, num++)
+		{
+			sockaddr_to_netaddr((struct sockaddr *)&sockaddrs[i], &addrs[num]);
+			sizes[num] = msgs[i].msg_len;
+			network_stats.recv_bytes += msgs[i].msg_len;
+			network_stats.recv_packets++;
+		}
+	}
+#else
+	while(num < max_packets)
+	{
+		int bytes = net_udp_recv(sock, &addrs[num], data + num * maxsize, maxsize);
+		if(bytes <= 0)
+			break;
+		sizes[num++] = bytes;
+	}
+#endif
+	return num;
+}
+
+int net_udp_send_batch(NETSOCKET sock, const NETADDR *addrs, const unsigned char *data, const int *sizes, int stride, int num_packets)
+{
+	int sent = 0;
+#if defined(CONF_NET_MMSG)
+	struct mmsghdr msgs[NET_UDP_BATCH_SIZE];
+	struct iovec iovecs[NET_UDP_BATCH_SIZE];
+	struct sockaddr_storage sockaddrs[NET_UDP_BATCH_SIZE];
+	int sockets[2];
+	int types[2];
+	int t, i, count, first, result;
+
+	for(i = 0; i < num_packets; i++)
+	{
+		network_stats.sent_bytes += sizes[i];
+		network_stats.sent_packets++;
+	}
+
+	sockets[0] = sock.ipv4sock;
+	sockets[1] = sock.ipv6sock;
+	types[0] = NETTYPE_IPV4;
+	types[1] = NETTYPE_IPV6;
+	for(t = 0; t < 2; t++)
+	{
+		if(sockets[t] < 0)
+			continue;
+
+		i = 0;
+		while(i < num_packets)
+		{
+			/* collect the next packets of this address family */
+			count = 0;
+			mem_zero(msgs, sizeof(msgs));
+			for(; i < num_packets && count < NET_UDP_BATCH_SIZE; i++)
+			{
+				if(!(addrs[i].type&types[t]))
+					continue;
+
+				iovecs[count].iov_base = (void *)(data + i * stride);
+				iovecs[count].iov_len = sizes[i];
+				msgs[count].msg_hdr.msg_name = &sockaddrs[count];
+				msgs[count].msg_hdr.msg_namelen = priv_net_udp_target(&addrs[i], types[t], &sockaddrs[count]);
+				msgs[count].msg_hdr.msg_iov = &iovecs[count];
+				msgs[count].msg_hdr.msg_iovlen = 1;
+				count++;
+			}
+
+			/* a packet that fails is dropped like with sendto, the rest is sent again */
+			for(first = 0; first < count; )
+			{
+				result = sendmmsg(sockets[t], &msgs[first], count - first, 0);
+				network_stats.sent_calls++;
+				if(result <= 0)
+				{
+					first++;
+					continue;
+				}
+				sent += result;
+				first += result;
+			}
+		}
+	}
+#else
+	int i;
+	for(i = 0; i < num_packets; i++)
+	{
+		if(net_udp_send(sock, &addrs[i], data + i * stride, sizes[i]) >= 0)
+			sent++;
+	}
+#endif
+	return sent;
+}
+
 int net_udp_close(NETSOCKET sock)
 {
 	return priv_net_close_all_sockets(sock);
@@ -685,6 +685,45 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 */
 int net_udp_recv(NETSOCKET sock, NETADDR *addr, void *data, int maxsize);
 
+/*
+	Function: net_udp_recv_batch
+		Recives several packets over an UDP socket with one call per
+		address family (recvmmsg on linux). On other systems the packets
+		are recived one by one.
+
+	Parameters:
+		sock - Socket to use.
+		addrs - Array of max_packets NETADDRs that will recive the addresses.
+		data - Buffer of max_packets * maxsize bytes, packet i is
+			written to data + i * maxsize.
+		sizes - Array of max_packets ints that will recive the sizes.
+		maxsize - Maximum size of one packet.
+		max_packets - Maximum number of packets to recive.
+
+	Returns:
+		The number of packets recived, 0 if there are none.
+*/
+int net_udp_recv_batch(NETSOCKET sock, NETADDR *addrs, unsigned char *data, int *sizes, int maxsize, int max_packets);
+
+/*
+	Function: net_udp_send_batch
+		Sends several packets over an UDP socket with as few calls as
+		possible (sendmmsg on linux). On other systems the packets are
+		sent one by one.
+
+	Parameters:
+		sock - Socket to use.
+		addrs - Where to send the packets.
+		data - Buffer of the packets, packet i starts at data + i * stride.
+		sizes - Sizes of the packets.
+		stride - Distance between the packets in the buffer.
+		num_packets - Number of packets to send.
+
+	Returns:
+		The number of packets sent.
+*/
+int net_udp_send_batch(NETSOCKET sock, const NETADDR *addrs, const unsigned char *data, const int *sizes, int stride, int num_packets);
+
 /*
 	Function: net_udp_close
 		Closes an UDP socket.
@@ -1495,6 +1534,8 @@ typedef struct
 	int sent_bytes;
 	int recv_packets;
 	int recv_bytes;
+	int sent_calls; /* send syscalls, sent_packets / sent_calls are the packets per syscall */
+	int recv_calls; /* receive syscalls that returned packets */
 } NETSTATS;
 
 
@@ -73,7 +73,7 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     return res;
 }
 
-// the destructor joins all threads
+// the destructor joins all threads, the queued tasks are finished first
 inline ThreadPool::~ThreadPool()
 {
     {
@@ -82,7 +82,7 @@ inline ThreadPool::~ThreadPool()
     }
     condition.notify_all();
     for(std::thread &worker: workers)
-        worker.detach();
+        worker.join();
 }
 
 #define sleep_pause(microsec) set_pause_function([](){}, microsec) \
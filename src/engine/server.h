@@ -8,8 +8,11 @@
 
 #include <engine/shared/protocol.h>
 #include <generated/protocol.h>
+#include <teeother/components/localization.h>
 #include <game/version.h>
 
+#include <bitset>
+
 #define DC_SERVER_INFO 13872503
 #define DC_PLAYER_INFO 1346299
 #define DC_JOIN_LEAVE 14494801
@@ -19,6 +22,9 @@
 #define DC_DISCORD_INFO 431050
 #define DC_INVISIBLE_GRAY 3553599
 
+// a bit for every client id, used to select the receivers of messages and events
+typedef std::bitset<MAX_CLIENTS> CClientMask;
+
 class IServer : public IInterface
 {
 	MACRO_INTERFACE("server", 0)
@@ -49,15 +55,15 @@ public:
 	virtual int GetClientInfo(int ClientID, CClientInfo *pInfo) const = 0;
 	virtual void GetClientAddr(int ClientID, char* pAddrStr, int Size) const = 0;
 
-	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, int64 Mask = -1, int WorldID = -1) = 0;
+	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, const CClientMask *pMask = nullptr, int WorldID = -1) = 0;
 
 	template<class T>
-	int SendPackMsgMask(T* pMsg, int Flags, int ClientID, int64 Mask, int WorldID = -1)
+	int SendPackMsgMask(T* pMsg, int Flags, const CClientMask &Mask, int WorldID = -1)
 	{
 		CMsgPacker Packer(pMsg->MsgID(), false);
 		if(pMsg->Pack(&Packer))
 			return -1;
-		return SendMsg(&Packer, Flags, ClientID, Mask, WorldID);
+		return SendMsg(&Packer, Flags, -1, &Mask, WorldID);
 	}
 
 	template<class T>
@@ -67,26 +73,128 @@ public:
 		if(pMsg->Pack(&Packer))
 			return -1;
 
-		auto IsNotVanilaMsg = [=](int CID) -> bool // first mmo msg
+		if(ClientID != -1)
+			return SendMsg(&Packer, Flags, ClientID, nullptr, WorldID);
+
+		const CClientMask Mask = MsgReceivers(pMsg->MsgID(), WorldID);
+		return SendMsg(&Packer, Flags, -1, &Mask, WorldID);
+	}
+
+	// the messages with client ids are packed for every world, the ids are different in every world
+	int SendPackMsg(CNetMsg_Sv_Chat *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_Team *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_Emoticon *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_ClientInfo *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_ClientDrop *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_SkinChange *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_EquipItems *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+	int SendPackMsg(CNetMsg_Sv_TalkText *pMsg, int Flags, int ClientID, int WorldID = -1) { return SendPackMsgTranslate(pMsg, Flags, ClientID, WorldID); }
+
+	// client ids of the protocol, every world maps its players and bots to the ids from 0 to PROTOCOL_MAX_CLIENTS-1
+	virtual int MapClientID(int WorldID, int ClientID) = 0;
+	virtual void UnmapClientID(int WorldID, int ClientID) = 0;
+	virtual int TranslateClientID(int WorldID, int ClientID) const = 0;
+	virtual int ReverseTranslateClientID(int WorldID, int ProtocolID) const = 0;
+
+private:
+	// the ingame players, the mmo messages are only for the mmo clients
+	CClientMask MsgReceivers(int MsgID, int WorldID)
+	{
+		CClientMask Mask;
+		const bool MmoMsg = MsgID >= NETMSGTYPE_CL_ISMMOSERVER;
+		for(int i = 0; i < MAX_PLAYERS; i++)
 		{
-			return  GetClientProtocolVersion(CID) == PROTOCOL_VERSION_MMO && pMsg->MsgID() >= NETMSGTYPE_CL_ISMMOSERVER;
-		};
+			if(!ClientIngame(i) || (WorldID != -1 && GetClientWorldID(i) != WorldID))
+				continue;
+			if(MmoMsg && GetClientProtocolVersion(i) != PROTOCOL_VERSION_MMO)
+				continue;
+			Mask.set(i);
+		}
+		return Mask;
+	}
 
-		int64 Mask = -1;
-		if(ClientID == -1)
+	template<class T>
+	int SendPackMsgTranslate(T *pMsg, int Flags, int ClientID, int WorldID)
+	{
+		char aBuf[512];
+		if(ClientID != -1)
 		{
-			for(int i = 0; i < MAX_PLAYERS; i++)
+			T Msg = *pMsg;
+			if(!TranslateMsg(&Msg, GetClientWorldID(ClientID), aBuf, sizeof(aBuf)))
+				return 0;
+
+			CMsgPacker Packer(Msg.MsgID(), false);
+			if(Msg.Pack(&Packer))
+				return -1;
+			return SendMsg(&Packer, Flags, ClientID, nullptr, WorldID);
+		}
+
+		// one message for the receivers of every world
+		CClientMask Receivers = MsgReceivers(pMsg->MsgID(), WorldID);
+		int aReceiverWorlds[MAX_PLAYERS];
+		for(int i = 0; i < MAX_PLAYERS; i++)
+			aReceiverWorlds[i] = Receivers.test(i) ? GetClientWorldID(i) : -1;
+
+		for(int i = 0; i < MAX_PLAYERS && Receivers.any(); i++)
+		{
+			if(!Receivers.test(i))
+				continue;
+
+			const int ReceiverWorldID = aReceiverWorlds[i];
+			CClientMask WorldMask;
+			for(int j = i; j < MAX_PLAYERS; j++)
 			{
-				if(ClientIngame(i) && (IsNotVanilaMsg(i) || pMsg->MsgID() < NETMSGTYPE_CL_ISMMOSERVER))
-					Mask |= (int64)1 << i;
+				if(Receivers.test(j) && aReceiverWorlds[j] == ReceiverWorldID)
+					WorldMask.set(j);
 			}
+			Receivers &= ~WorldMask;
+
+			T Msg = *pMsg;
+			if(!TranslateMsg(&Msg, ReceiverWorldID, aBuf, sizeof(aBuf)))
+				continue;
+
+			CMsgPacker Packer(Msg.MsgID(), false);
+			if(Msg.Pack(&Packer))
+				return -1;
+			SendMsg(&Packer, Flags, -1, &WorldMask, ReceiverWorldID);
 		}
-		else if(ClientIngame(ClientID) && (IsNotVanilaMsg(ClientID) || pMsg->MsgID() < NETMSGTYPE_CL_ISMMOSERVER))
-			Mask |= (int64)1 << ClientID;
+		return 0;
+	}
+
+	// false when the client of the message has no id in the world
+	bool TranslateMsg(CNetMsg_Sv_Chat *pMsg, int WorldID, char *pBuf, int BufSize)
+	{
+		const int ChatterClientID = pMsg->m_ClientID;
+		pMsg->m_ClientID = TranslateClientID(WorldID, ChatterClientID);
+		pMsg->m_TargetID = TranslateClientID(WorldID, pMsg->m_TargetID);
 
-		return SendMsg(&Packer, Flags, ClientID, Mask, WorldID);
+		// the chatter is in another world, the name is added to the text instead
+		if(ChatterClientID >= 0 && pMsg->m_ClientID == -1)
+		{
+			str_format(pBuf, BufSize, "%s: %s", ClientName(ChatterClientID), pMsg->m_pMessage);
+			pMsg->m_pMessage = pBuf;
+		}
+		return true;
+	}
+	bool TranslateMsg(CNetMsg_Sv_Team *pMsg, int WorldID, char *pBuf, int BufSize)
+	{
+		const int ClientID = pMsg->m_ClientID;
+		pMsg->m_ClientID = TranslateClientID(WorldID, ClientID);
+		return ClientID < 0 || pMsg->m_ClientID >= 0;
+	}
+	bool TranslateMsg(CNetMsg_Sv_TalkText *pMsg, int WorldID, char *pBuf, int BufSize)
+	{
+		pMsg->m_ConversationWithClientID = TranslateClientID(WorldID, pMsg->m_ConversationWithClientID);
+		return true;
+	}
+	template<class T>
+	bool TranslateMsg(T *pMsg, int WorldID, char *pBuf, int BufSize)
+	{
+		pMsg->m_ClientID = TranslateClientID(WorldID, pMsg->m_ClientID);
+		return pMsg->m_ClientID >= 0;
 	}
 
+public:
 	// World Time
 	virtual int GetMinutesWorldTime() const = 0;
 	virtual int GetHourWorldTime() const = 0;
@@ -101,9 +209,15 @@ public:
 	virtual void SetClientClan(int ClientID, char const *pClan) = 0;
 	virtual void SetClientCountry(int ClientID, int Country) = 0;
 	virtual void SetClientScore(int ClientID, int Score) = 0;
+	// the browser info is rebuilt on the next query, for changes the server doesn't see itself like teams
+	virtual void ExpireServerInfo() = 0;
 
 	virtual void ChangeWorld(int ClientID, int NewWorldID) = 0;
 	virtual int GetClientWorldID(int ClientID) = 0;
+	// the function that changes other worlds, while the worlds are ticked in parallel it's delayed until all of them finish the tick
+	virtual void ExecuteOnMainThread(std::function<void()> Func) = 0;
+	// the path searches of all the worlds share the workers of the server (sv_pathfinder_threads)
+	virtual void EnqueuePathSearch(std::function<void()> Func) = 0;
 	virtual const char* GetWorldName(int WorldID) = 0;
 
 	virtual void SetClientProtocolVersion(int ClientID, int Version) = 0;
@@ -111,6 +225,7 @@ public:
 
 	virtual void SetClientLanguage(int ClientID, const char* pLanguage) = 0;
 	virtual const char* GetClientLanguage(int ClientID) const = 0;
+	virtual CLocalization::CLanguage* GetClientLanguageInfo(int ClientID) const = 0;
 
 	// discord
 	virtual void SendDiscordMessage(const char *pChannel, int Color, const char* pTitle, const char* pText) = 0;
@@ -126,6 +241,8 @@ public:
 	virtual void SnapFreeID(int ID) = 0;
 	virtual void *SnapNewItem(int Type, int ID, int Size) = 0;
 	virtual void SnapSetStaticsize(int ItemType, int Size) = 0;
+	virtual int SnapNumItems() const = 0;
+	virtual const void *SnapGetItem(int Index, int *pType, int *pID, int *pSize) const = 0;
 
 	enum
 	{
@@ -161,6 +278,7 @@ public:
 	virtual void ClearClientData(int ClientID) = 0;
 
 	virtual void PrepareClientChangeWorld(int ClientID) = 0;
+	virtual void OnClientChangeWorldRefused(int ClientID, int WorldID) = 0;
 	virtual void UpdateClientInformation(int FakeClientID) = 0;
 
 	virtual void OnClientConnected(int ClientID) = 0;
@@ -171,6 +289,8 @@ public:
 
 	virtual bool IsClientReady(int ClientID) const = 0;
 	virtual bool IsClientPlayer(int ClientID) const = 0;
+	virtual bool IsDormant() const = 0;
+	virtual int GetDormantTicks() const = 0;
 	virtual void FakeChat(const char *pName, const char *pText) = 0;
 
 	virtual const char *Version() const = 0;
@@ -16,6 +16,7 @@
 #include <engine/shared/mapchecker.h>
 #include <engine/shared/network.h>
 #include <engine/shared/packer.h>
+#include <engine/shared/profiler.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/snapshot.h>
 #include <mastersrv/mastersrv.h>
@@ -37,6 +38,9 @@
 
 #include "game/game_context.h"
 
+// marks the threads that tick the worlds in parallel
+static thread_local bool s_WorldTickThread = false;
+
 void CServer::CClient::Reset()
 {
 	// reset input
@@ -69,6 +73,12 @@ CServer::CServer()
 	m_RconPasswordSet = 0;
 	m_GeneratedRconPassword = 0;
 	m_HeavyReload = false;
+	m_WorldsPoolThreads = 0;
+	m_SnapPoolThreads = 0;
+	m_LastProfilerDump = 0;
+	m_LastOverrunMessage = 0;
+	m_OverrunsSinceMessage = 0;
+	m_ServerInfoExpired = true;
 
 	m_pServerBan = new CServerBan;
 	m_pMultiWorlds = new CMultiWorlds;
@@ -84,6 +94,7 @@ CServer::~CServer()
 #endif
 	delete m_pDataMmo;
 	delete m_pMultiWorlds;
+	ResetPathfinderPool();
 	SJK.DisconnectConnectionHeap();
 }
 
@@ -163,6 +174,7 @@ void CServer::SetClientName(int ClientID, const char *pName)
 	const char* pDefaultName = "(1)";
 	pName = str_utf8_skip_whitespaces(pName);
 	str_utf8_copy_num(m_aClients[ClientID].m_aName, *pName ? pName : pDefaultName, sizeof(m_aClients[ClientID].m_aName), MAX_NAME_LENGTH);
+	m_ServerInfoExpired = true;
 }
 
 void CServer::SetClientClan(int ClientID, const char *pClan)
@@ -171,6 +183,7 @@ void CServer::SetClientClan(int ClientID, const char *pClan)
 		return;
 
 	str_utf8_copy_num(m_aClients[ClientID].m_aClan, pClan, sizeof(m_aClients[ClientID].m_aClan), MAX_CLAN_LENGTH);
+	m_ServerInfoExpired = true;
 }
 
 void CServer::SetClientCountry(int ClientID, int Country)
@@ -178,6 +191,8 @@ void CServer::SetClientCountry(int ClientID, int Country)
 	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 
+	if(m_aClients[ClientID].m_Country != Country)
+		m_ServerInfoExpired = true;
 	m_aClients[ClientID].m_Country = Country;
 }
 
@@ -185,6 +200,10 @@ void CServer::SetClientScore(int ClientID, int Score)
 {
 	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
+
+	// the players set their score every tick
+	if(m_aClients[ClientID].m_Score != Score)
+		m_ServerInfoExpired = true;
 	m_aClients[ClientID].m_Score = Score;
 }
 
@@ -207,6 +226,7 @@ void CServer::SetClientLanguage(int ClientID, const char* pLanguage)
 	if (ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 	str_copy(m_aClients[ClientID].m_aLanguage, pLanguage, sizeof(m_aClients[ClientID].m_aLanguage));
+	m_aClients[ClientID].m_pLanguage = Localization()->GetLanguage(pLanguage);
 }
 
 const char *CServer::GetWorldName(int WorldID)
@@ -223,23 +243,129 @@ const char* CServer::GetClientLanguage(int ClientID) const
 	return m_aClients[ClientID].m_aLanguage;
 }
 
+CLocalization::CLanguage* CServer::GetClientLanguageInfo(int ClientID) const
+{
+	if (ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
+		return nullptr;
+	return m_aClients[ClientID].m_pLanguage;
+}
+
 void CServer::ChangeWorld(int ClientID, int NewWorldID)
 {
+	// the player is moved between the worlds only when they are not ticking
+	if(s_WorldTickThread)
+	{
+		ExecuteOnMainThread([this, ClientID, NewWorldID]() { ChangeWorld(ClientID, NewWorldID); });
+		return;
+	}
+
 	if(!MultiWorlds()->IsValid(NewWorldID) || NewWorldID == m_aClients[ClientID].m_WorldID || ClientID < 0 || ClientID >= MAX_PLAYERS || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 
+	// the player stays in the world when the other one has no free client id
+	if(MapClientID(NewWorldID, ClientID) == -1)
+	{
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "client %d can't enter the world %d, it is full", ClientID, NewWorldID);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+		GameServer(m_aClients[ClientID].m_WorldID)->OnClientChangeWorldRefused(ClientID, NewWorldID);
+		return;
+	}
+
 	m_aClients[ClientID].m_OldWorldID = m_aClients[ClientID].m_WorldID;
 	GameServer(m_aClients[ClientID].m_OldWorldID)->PrepareClientChangeWorld(ClientID);
 
 	m_aClients[ClientID].m_WorldID = NewWorldID;
 	GameServer(m_aClients[ClientID].m_WorldID)->PrepareClientChangeWorld(ClientID);
 
+	UnmapClientID(m_aClients[ClientID].m_OldWorldID, ClientID);
+
 	m_aClients[ClientID].Reset();
 	m_aClients[ClientID].m_ChangeMap = true;
 	m_aClients[ClientID].m_State = CClient::STATE_CONNECTING;
 	SendMap(ClientID);
 }
 
+void CServer::ExecuteOnMainThread(std::function<void()> Func)
+{
+	if(!s_WorldTickThread)
+	{
+		Func();
+		return;
+	}
+
+	std::lock_guard<std::mutex> Lock(m_MainThreadTasksLock);
+	m_aMainThreadTasks.push_back(std::move(Func));
+}
+
+void CServer::EnqueuePathSearch(std::function<void()> Func)
+{
+	std::lock_guard<std::mutex> Lock(m_PathfinderPoolLock);
+	if(!m_pPathfinderPool)
+		m_pPathfinderPool.reset(new ThreadPool(g_Config.m_SvPathfinderThreads));
+	m_pPathfinderPool->enqueue(std::move(Func));
+}
+
+// the queued searches are finished by the old workers, the new pool is created by the next search
+void CServer::ResetPathfinderPool()
+{
+	std::lock_guard<std::mutex> Lock(m_PathfinderPoolLock);
+	m_pPathfinderPool.reset();
+}
+
+void CServer::TickWorlds()
+{
+	const int NumWorlds = MultiWorlds()->GetSizeInitilized();
+	if(g_Config.m_SvWorldThreads <= 0 || NumWorlds <= 1)
+	{
+		for(int i = 0; i < NumWorlds; i++)
+		{
+			IGameServer* pGameServer = MultiWorlds()->GetWorld(i)->m_pGameServer;
+			pGameServer->OnTick();
+		}
+		return;
+	}
+
+	if(!m_pWorldsPool || m_WorldsPoolThreads != g_Config.m_SvWorldThreads)
+	{
+		m_pWorldsPool.reset(new ThreadPool(g_Config.m_SvWorldThreads));
+		m_WorldsPoolThreads = g_Config.m_SvWorldThreads;
+	}
+
+	// the main world is ticked by this thread, the others by the pool
+	std::vector<std::future<void>> aTicks;
+	aTicks.reserve(NumWorlds - 1);
+	for(int i = 0; i < NumWorlds; i++)
+	{
+		if(i == MAIN_WORLD_ID)
+			continue;
+
+		IGameServer* pGameServer = MultiWorlds()->GetWorld(i)->m_pGameServer;
+		aTicks.push_back(m_pWorldsPool->enqueue([pGameServer]()
+		{
+			s_WorldTickThread = true;
+			pGameServer->OnTick();
+			s_WorldTickThread = false;
+		}));
+	}
+
+	s_WorldTickThread = true;
+	MultiWorlds()->GetWorld(MAIN_WORLD_ID)->m_pGameServer->OnTick();
+	s_WorldTickThread = false;
+
+	// the barrier, snapshots and network see the worlds only when all of them have finished the tick
+	for(auto& Tick : aTicks)
+		Tick.get();
+
+	std::vector<std::function<void()>> aTasks;
+	{
+		std::lock_guard<std::mutex> Lock(m_MainThreadTasksLock);
+		aTasks.swap(m_aMainThreadTasks);
+	}
+	for(auto& Task : aTasks)
+		Task();
+}
+
 void CServer::BackInformationFakeClient(int FakeClientID)
 {
 	for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
@@ -257,6 +383,94 @@ int CServer::GetClientWorldID(int ClientID)
 	return m_aClients[ClientID].m_WorldID;
 }
 
+CServer::CClientIDMap::CClientIDMap()
+{
+	for(auto &ProtocolID : m_aProtocolIDs)
+		ProtocolID = -1;
+	for(auto &ClientID : m_aClientIDs)
+		ClientID = -1;
+}
+
+int CServer::CClientIDMap::Map(int ClientID)
+{
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	if(m_aProtocolIDs[ClientID] != -1)
+		return m_aProtocolIDs[ClientID];
+
+	// the players take the free ids from the start, the bots from the end
+	const bool Player = ClientID < MAX_PLAYERS;
+	int ProtocolID = -1;
+	for(int i = 0; i < PROTOCOL_MAX_CLIENTS && ProtocolID == -1; i++)
+	{
+		const int ID = Player ? i : PROTOCOL_MAX_CLIENTS - 1 - i;
+		if(m_aClientIDs[ID] == -1)
+			ProtocolID = ID;
+	}
+
+	// the world is full, the player takes the id of a bot and the bot is hidden until an id is free
+	for(int i = PROTOCOL_MAX_CLIENTS - 1; i >= 0 && ProtocolID == -1 && Player; i--)
+	{
+		if(m_aClientIDs[i] >= MAX_PLAYERS)
+		{
+			m_aProtocolIDs[m_aClientIDs[i]] = -1;
+			ProtocolID = i;
+		}
+	}
+
+	if(ProtocolID == -1)
+		return -1;
+
+	m_aClientIDs[ProtocolID] = ClientID;
+	m_aProtocolIDs[ClientID] = ProtocolID;
+	return ProtocolID;
+}
+
+void CServer::CClientIDMap::Unmap(int ClientID)
+{
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	const int ProtocolID = m_aProtocolIDs[ClientID];
+	if(ProtocolID == -1)
+		return;
+
+	m_aClientIDs[ProtocolID] = -1;
+	m_aProtocolIDs[ClientID] = -1;
+}
+
+int CServer::MapClientID(int WorldID, int ClientID)
+{
+	if(WorldID < 0 || WorldID >= ENGINE_MAX_WORLDS || ClientID < 0 || ClientID >= MAX_CLIENTS)
+		return -1;
+
+	const int ProtocolID = m_aClientIDMaps[WorldID].Map(ClientID);
+	if(ProtocolID == -1 && ClientID < MAX_PLAYERS)
+		dbg_msg("server", "no free client id in world %d for client %d", WorldID, ClientID);
+	return ProtocolID;
+}
+
+void CServer::UnmapClientID(int WorldID, int ClientID)
+{
+	if(WorldID < 0 || WorldID >= ENGINE_MAX_WORLDS || ClientID < 0 || ClientID >= MAX_CLIENTS)
+		return;
+
+	m_aClientIDMaps[WorldID].Unmap(ClientID);
+}
+
+int CServer::TranslateClientID(int WorldID, int ClientID) const
+{
+	if(WorldID < 0 || WorldID >= ENGINE_MAX_WORLDS || ClientID < 0 || ClientID >= MAX_CLIENTS)
+		return -1;
+
+	return m_aClientIDMaps[WorldID].ProtocolID(ClientID);
+}
+
+int CServer::ReverseTranslateClientID(int WorldID, int ProtocolID) const
+{
+	if(WorldID < 0 || WorldID >= ENGINE_MAX_WORLDS || ProtocolID < 0 || ProtocolID >= PROTOCOL_MAX_CLIENTS)
+		return -1;
+
+	return m_aClientIDMaps[WorldID].ClientID(ProtocolID);
+}
+
 void CServer::SendDiscordGenerateMessage(const char *pTitle, int AccountID, int Color)
 {
 #ifdef CONF_DISCORD
@@ -331,12 +545,15 @@ int CServer::Init()
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		str_copy(m_aClients[i].m_aLanguage, "en", sizeof(m_aClients[i].m_aLanguage));
+		m_aClients[i].m_pLanguage = nullptr;
 		m_aClients[i].m_State = CClient::STATE_EMPTY;
 		m_aClients[i].m_aName[0] = 0;
 		m_aClients[i].m_aClan[0] = 0;
 		m_aClients[i].m_Country = -1;
 		m_aClients[i].m_Snapshots.Init();
 	}
+	mem_zero(m_aInfoQueryLimits, sizeof(m_aInfoQueryLimits));
+	m_ServerInfoExpired = true;
 	return 0;
 }
 
@@ -472,7 +689,7 @@ void CServer::InitRconPasswordIfUnset()
 	m_GeneratedRconPassword = 1;
 }
 
-int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, int64 Mask, int WorldID)
+int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, const CClientMask *pMask, int WorldID)
 {
 	if (!pMsg)
 		return -1;
@@ -491,6 +708,8 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, int64 Mask, int
 	if(Flags&MSGFLAG_FLUSH)
 		Packet.m_Flags |= NETSENDFLAG_FLUSH;
 
+	// the worlds can send messages at the same time
+	std::lock_guard<std::mutex> Lock(m_SendLock);
 	if(!(Flags&MSGFLAG_NOSEND))
 	{
 		if(ClientID == -1)
@@ -500,7 +719,7 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, int64 Mask, int
 				if (m_aClients[i].m_State == CClient::STATE_INGAME && !m_aClients[i].m_Quitting)
 				{
 					// skip what is not included in the mask
-					if(Mask != -1 && (Mask & ((int64)1 << ClientID)) == 0)
+					if(pMask && !pMask->test(i))
 						continue;
 
 					if (WorldID != -1)
@@ -526,6 +745,12 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID, int64 Mask, int
 
 void CServer::DoSnapshot(int WorldID)
 {
+	static CSnapshot EmptySnap;
+	EmptySnap.Clear();
+
+	// the snapshots are built by the game in this thread
+	CProfilerScope ProfilerScope(ProfilerSection(WorldID, "snap/build"));
+	int NumJobs = 0;
 	GameServer(WorldID)->OnPreSnap();
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
@@ -541,99 +766,182 @@ void CServer::DoSnapshot(int WorldID)
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick()%10) != 0)
 			continue;
 
-		{
-			char aData[CSnapshot::MAX_SIZE];
-			CSnapshot *pData = (CSnapshot*)aData;	// Fix compiler warning for strict-aliasing
-			char aDeltaData[CSnapshot::MAX_SIZE];
-			char aCompData[CSnapshot::MAX_SIZE];
-			int SnapshotSize;
-			int Crc;
-			static CSnapshot EmptySnap;
-			CSnapshot *pDeltashot = &EmptySnap;
-			int DeltashotSize;
-			int DeltaTick = -1;
-			int DeltaSize;
-
-			m_SnapshotBuilder.Init();
-			GameServer(WorldID)->OnSnap(i);
-
-			// finish snapshot
-			SnapshotSize = m_SnapshotBuilder.Finish(pData);
-			Crc = pData->Crc();
-
-			// remove old snapshos
-			// keep 3 seconds worth of snapshots
-			m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - SERVER_TICK_SPEED * 3);
-
-			// save it the snapshot
-			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0);
-
-			// find snapshot that we can preform delta against
-			EmptySnap.Clear();
+		// the jobs grow up to the most players of a world, they are large
+		if(NumJobs == (int)m_aSnapJobs.size())
+			m_aSnapJobs.resize(NumJobs + 1);
 
-			{
-				DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, 0, &pDeltashot, 0);
-				if(DeltashotSize >= 0)
-					DeltaTick = m_aClients[i].m_LastAckedSnapshot;
-				else
-				{
-					// no acked package found, force client to recover rate
-					if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
-						m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
-				}
-			}
+		CSnapJob *pJob = &m_aSnapJobs[NumJobs++];
+		CSnapshot *pData = (CSnapshot*)pJob->m_aData;	// Fix compiler warning for strict-aliasing
+		pJob->m_ClientID = i;
+		pJob->m_DeltaTick = -1;
+		pJob->m_pDeltashot = &EmptySnap;
 
-			// create delta
-			DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+		m_SnapshotBuilder.Init();
+		GameServer(WorldID)->OnSnap(i);
 
-			if(DeltaSize)
-			{
-				// compress it
-				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
-				int NumPackets;
+		// finish snapshot
+		const int SnapshotSize = m_SnapshotBuilder.Finish(pData);
+		pJob->m_Crc = pData->Crc();
 
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
-				NumPackets = (SnapshotSize+MaxSize-1)/MaxSize;
+		// remove old snapshos
+		// keep 3 seconds worth of snapshots
+		m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - SERVER_TICK_SPEED * 3);
 
-				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
-				{
-					int Chunk = Left < MaxSize ? Left : MaxSize;
-					Left -= Chunk;
+		// save it the snapshot
+		m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0);
 
-					if(NumPackets == 1)
-					{
-						CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick-DeltaTick);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n*MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i, -1, WorldID);
-					}
-					else
-					{
-						CMsgPacker Msg(NETMSG_SNAP, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick-DeltaTick);
-						Msg.AddInt(NumPackets);
-						Msg.AddInt(n);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n*MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i, -1, WorldID);
-					}
-				}
-			}
-			else
-			{
-				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
-				Msg.AddInt(m_CurrentGameTick);
-				Msg.AddInt(m_CurrentGameTick-DeltaTick);
-				SendMsg(&Msg, MSGFLAG_FLUSH, i, -1, WorldID);
-			}
+		// find snapshot that we can preform delta against
+		CSnapshot *pDeltashot = nullptr;
+		if(m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, 0, &pDeltashot, 0) >= 0)
+		{
+			pJob->m_DeltaTick = m_aClients[i].m_LastAckedSnapshot;
+			pJob->m_pDeltashot = pDeltashot;
+		}
+		else
+		{
+			// no acked package found, force client to recover rate
+			if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
+				m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
 		}
 	}
 	GameServer(WorldID)->OnPostSnap();
+
+	// the delta and the compression only read the snapshots, they are done by the pool
+	ProfilerScope.Switch(ProfilerSection(WorldID, "snap/compress"));
+	if(g_Config.m_SvSnapThreads > 0 && NumJobs > 1)
+	{
+		// the jobs of the previous snapshot are done, the old workers are joined before the new ones start
+		if(!m_pSnapPool || m_SnapPoolThreads != g_Config.m_SvSnapThreads)
+		{
+			m_pSnapPool.reset();
+			m_pSnapPool.reset(new ThreadPool(g_Config.m_SvSnapThreads));
+			m_SnapPoolThreads = g_Config.m_SvSnapThreads;
+		}
+
+		std::vector<std::future<void>> aJobs;
+		aJobs.reserve(NumJobs);
+		for(int i = 0; i < NumJobs; i++)
+		{
+			CSnapJob *pJob = &m_aSnapJobs[i];
+			aJobs.push_back(m_pSnapPool->enqueue([this, pJob]() { CompressSnapshot(pJob); }));
+		}
+		for(auto& Job : aJobs)
+			Job.wait();
+	}
+	else
+	{
+		for(int i = 0; i < NumJobs; i++)
+			CompressSnapshot(&m_aSnapJobs[i]);
+	}
+
+	// sent in the order of the clients
+	ProfilerScope.Switch(ProfilerSection(WorldID, "snap/send"));
+	for(int i = 0; i < NumJobs; i++)
+		SendSnapshot(&m_aSnapJobs[i], WorldID);
+}
+
+CProfilerSection *CServer::ProfilerSection(int WorldID, const char *pStage) const
+{
+	if(!CProfiler::IsEnabled())
+		return nullptr;
+
+	if(WorldID >= 0)
+		return CProfiler::WorldSection(WorldID, pStage);
+
+	char aName[64];
+	str_format(aName, sizeof(aName), "server/%s", pStage);
+	return CProfiler::Section(aName);
+}
+
+void CServer::UpdateProfiler(int64 FrameTime, int NumTicks)
+{
+	if(!CProfiler::IsEnabled())
+		return;
+
+	// a frame that catches up several ticks has the budget of all of them
+	const int64 Now = time_get();
+	if(FrameTime > NumTicks * time_freq() / SERVER_TICK_SPEED)
+	{
+		CProfiler::AddOverrun();
+		m_OverrunsSinceMessage++;
+		if(Now > m_LastOverrunMessage + time_freq())
+		{
+			dbg_msg("profiler", "tick %d overran the budget of %dms: %dms for %d tick(s), %d overrun(s) since the last message",
+				m_CurrentGameTick, 1000 / SERVER_TICK_SPEED, (int)(FrameTime * 1000 / time_freq()), NumTicks, m_OverrunsSinceMessage);
+			m_LastOverrunMessage = Now;
+			m_OverrunsSinceMessage = 0;
+		}
+	}
+
+	if(g_Config.m_SvProfilerDump > 0 && Now > m_LastProfilerDump + time_freq() * g_Config.m_SvProfilerDump)
+	{
+		DumpProfiler();
+		m_LastProfilerDump = Now;
+	}
+}
+
+bool CServer::DumpProfiler()
+{
+	IOHANDLE File = Storage()->OpenFile(g_Config.m_SvProfilerDumpFile, IOFLAG_WRITE, IStorageEngine::TYPE_SAVE);
+	if(!File)
+	{
+		dbg_msg("profiler", "failed to open '%s' for writing", g_Config.m_SvProfilerDumpFile);
+		return false;
+	}
+	return CProfiler::WriteJson(File, m_CurrentGameTick);
+}
+
+void CServer::CompressSnapshot(CSnapJob *pJob)
+{
+	// create delta
+	const int DeltaSize = m_SnapshotDelta.CreateDelta(pJob->m_pDeltashot, (CSnapshot*)pJob->m_aData, pJob->m_aDeltaData);
+
+	// compress it
+	pJob->m_CompSize = DeltaSize ? CVariableInt::Compress(pJob->m_aDeltaData, DeltaSize, pJob->m_aCompData, sizeof(pJob->m_aCompData)) : 0;
+}
+
+void CServer::SendSnapshot(const CSnapJob *pJob, int WorldID)
+{
+	const int ClientID = pJob->m_ClientID;
+	if(!pJob->m_CompSize)
+	{
+		CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+		Msg.AddInt(m_CurrentGameTick);
+		Msg.AddInt(m_CurrentGameTick-pJob->m_DeltaTick);
+		SendMsg(&Msg, MSGFLAG_FLUSH, ClientID, nullptr, WorldID);
+		return;
+	}
+
+	const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+	const int NumPackets = (pJob->m_CompSize+MaxSize-1)/MaxSize;
+	for(int n = 0, Left = pJob->m_CompSize; Left > 0; n++)
+	{
+		int Chunk = Left < MaxSize ? Left : MaxSize;
+		Left -= Chunk;
+
+		if(NumPackets == 1)
+		{
+			CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
+			Msg.AddInt(m_CurrentGameTick);
+			Msg.AddInt(m_CurrentGameTick-pJob->m_DeltaTick);
+			Msg.AddInt(pJob->m_Crc);
+			Msg.AddInt(Chunk);
+			Msg.AddRaw(&pJob->m_aCompData[n*MaxSize], Chunk);
+			SendMsg(&Msg, MSGFLAG_FLUSH, ClientID, nullptr, WorldID);
+		}
+		else
+		{
+			CMsgPacker Msg(NETMSG_SNAP, true);
+			Msg.AddInt(m_CurrentGameTick);
+			Msg.AddInt(m_CurrentGameTick-pJob->m_DeltaTick);
+			Msg.AddInt(NumPackets);
+			Msg.AddInt(n);
+			Msg.AddInt(pJob->m_Crc);
+			Msg.AddInt(Chunk);
+			Msg.AddRaw(&pJob->m_aCompData[n*MaxSize], Chunk);
+			SendMsg(&Msg, MSGFLAG_FLUSH, ClientID, nullptr, WorldID);
+		}
+	}
 }
 
 
@@ -643,6 +951,7 @@ int CServer::NewClientCallback(int ClientID, void *pUser)
 	CServer *pThis = (CServer *)pUser;
 	pThis->GameServer(MAIN_WORLD_ID)->ClearClientData(ClientID);
 	str_copy(pThis->m_aClients[ClientID].m_aLanguage, "en", sizeof(pThis->m_aClients[ClientID].m_aLanguage));
+	pThis->m_aClients[ClientID].m_pLanguage = nullptr;
 	pThis->m_aClients[ClientID].m_State = CClient::STATE_AUTH;
 	pThis->m_aClients[ClientID].m_aName[0] = 0;
 	pThis->m_aClients[ClientID].m_aClan[0] = 0;
@@ -657,6 +966,8 @@ int CServer::NewClientCallback(int ClientID, void *pUser)
 	pThis->m_aClients[ClientID].m_ClientVersion = 0;
 	pThis->m_aClients[ClientID].m_Quitting = false;
 	pThis->m_aClients[ClientID].Reset();
+	pThis->MapClientID(MAIN_WORLD_ID, ClientID);
+	pThis->m_ServerInfoExpired = true;
 	return 0;
 }
 
@@ -683,6 +994,8 @@ int CServer::DelClientCallback(int ClientID, const char *pReason, void *pUser)
 		pThis->GameServer(MAIN_WORLD_ID)->ClearClientData(ClientID);
 	}
 
+	pThis->UnmapClientID(pThis->m_aClients[ClientID].m_WorldID, ClientID);
+	pThis->m_ServerInfoExpired = true;
 	pThis->m_aClients[ClientID].m_State = CClient::STATE_EMPTY;
 	pThis->m_aClients[ClientID].m_aName[0] = 0;
 	pThis->m_aClients[ClientID].m_aClan[0] = 0;
@@ -827,6 +1140,13 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 					return;
 				}
 
+				// the client ids of the main world are taken by the players
+				if(TranslateClientID(MAIN_WORLD_ID, ClientID) == -1 && MapClientID(MAIN_WORLD_ID, ClientID) == -1)
+				{
+					m_NetServer.Drop(ClientID, "This server is full");
+					return;
+				}
+
 				m_aClients[ClientID].m_Version = Unpacker.GetInt();
 				m_aClients[ClientID].m_State = CClient::STATE_CONNECTING;
 				GameServer(MAIN_WORLD_ID)->ClearClientData(ClientID);
@@ -961,7 +1281,7 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 				CMsgPacker Msg(NETMSG_INPUTTIMING, true);
 				Msg.AddInt(IntendedTick);
 				Msg.AddInt(TimeLeft);
-				SendMsg(&Msg, 0, ClientID, -1, m_aClients[ClientID].m_WorldID);
+				SendMsg(&Msg, 0, ClientID, nullptr, m_aClients[ClientID].m_WorldID);
 			}
 
 			m_aClients[ClientID].m_LastInputTick = IntendedTick;
@@ -1078,7 +1398,7 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 		else if(MsgID == NETMSG_PING)
 		{
 			CMsgPacker Msg(NETMSG_PING_REPLY, true);
-			SendMsg(&Msg, 0, ClientID, -1, m_aClients[ClientID].m_WorldID);
+			SendMsg(&Msg, 0, ClientID, nullptr, m_aClients[ClientID].m_WorldID);
 		}
 		else
 		{
@@ -1113,7 +1433,7 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 	}
 }
 
-void CServer::GenerateServerInfo(CPacker *pPacker, int Token)
+void CServer::GenerateServerInfo(CPacker *pPacker, bool ListClients)
 {
 	// count the players
 	int PlayerCount = 0, ClientCount = 0;
@@ -1128,13 +1448,6 @@ void CServer::GenerateServerInfo(CPacker *pPacker, int Token)
 		}
 	}
 
-	if(Token != -1)
-	{
-		pPacker->Reset();
-		pPacker->AddRaw(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO));
-		pPacker->AddInt(Token);
-	}
-
 	pPacker->AddString(GameServer()->Version(), 32);
 	pPacker->AddString(g_Config.m_SvName, 64);
 	pPacker->AddString(g_Config.m_SvHostname, 128);
@@ -1147,18 +1460,24 @@ void CServer::GenerateServerInfo(CPacker *pPacker, int Token)
 		Flags |= SERVERINFO_FLAG_PASSWORD;
 	pPacker->AddInt(Flags);
 
+	// the server browsers of the clients don't accept more than the protocol ids
+	PlayerCount = min(PlayerCount, (int)PROTOCOL_MAX_CLIENTS);
+	ClientCount = min(ClientCount, (int)PROTOCOL_MAX_CLIENTS);
+
 	pPacker->AddInt(g_Config.m_SvSkillLevel);	// server skill level
 	pPacker->AddInt(PlayerCount); // num players
-	pPacker->AddInt(MAX_PLAYERS); // max players
+	pPacker->AddInt(PROTOCOL_MAX_CLIENTS); // max players
 	pPacker->AddInt(ClientCount); // num clients
-	pPacker->AddInt(MAX_PLAYERS); // max clients
+	pPacker->AddInt(PROTOCOL_MAX_CLIENTS); // max clients
 
-	if(Token != -1)
+	if(ListClients)
 	{
-		for(int i = 0; i < MAX_PLAYERS; i++)
+		int Listed = 0;
+		for(int i = 0; i < MAX_PLAYERS && Listed < ClientCount; i++)
 		{
 			if(m_aClients[i].m_State != CClient::STATE_EMPTY)
 			{
+				Listed++;
 				pPacker->AddString(ClientName(i), 0); // client name
 				pPacker->AddString(ClientClan(i), 0); // client clan
 				pPacker->AddInt(m_aClients[i].m_Country); // client country
@@ -1172,7 +1491,7 @@ void CServer::GenerateServerInfo(CPacker *pPacker, int Token)
 void CServer::SendServerInfo(int ClientID)
 {
 	CMsgPacker Msg(NETMSG_SERVERINFO, true);
-	GenerateServerInfo(&Msg, -1);
+	GenerateServerInfo(&Msg, false);
 	if(ClientID == -1)
 	{
 		for(int i = 0; i < MAX_PLAYERS; i++)
@@ -1204,12 +1523,24 @@ void CServer::PumpNetwork()
 				CUnpacker Unpacker;
 				Unpacker.Reset((unsigned char*)Packet.m_pData + sizeof(SERVERBROWSE_GETINFO), Packet.m_DataSize - sizeof(SERVERBROWSE_GETINFO));
 				int SrvBrwsToken = Unpacker.GetInt();
-				if (Unpacker.Error())
+				if (Unpacker.Error() || !InfoQueryAllowed(&Packet.m_Address))
 					continue;
 
+				// only the token differs between the responses
+				if(m_ServerInfoExpired)
+				{
+					m_ServerInfoExpired = false;
+					m_ServerInfoCache.Reset();
+					GenerateServerInfo(&m_ServerInfoCache, true);
+				}
+
 				CPacker Packer;
+				Packer.Reset();
+				Packer.AddRaw(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO));
+				Packer.AddInt(SrvBrwsToken);
+				Packer.AddRaw(m_ServerInfoCache.Data(), m_ServerInfoCache.Size());
+
 				CNetChunk Response;
-				GenerateServerInfo(&Packer, SrvBrwsToken);
 
 				Response.m_ClientID = -1;
 				Response.m_Address = Packet.m_Address;
@@ -1225,6 +1556,31 @@ void CServer::PumpNetwork()
 
 	m_pServerBan->Update();
 	m_Econ.Update();
+
+	// the responses and everything the ticks queued go out together
+	m_NetServer.Flush();
+}
+
+bool CServer::InfoQueryAllowed(const NETADDR *pAddr)
+{
+	if(!g_Config.m_SvInfoRateLimit)
+		return true;
+
+	// addresses that share a slot only reset each others count
+	unsigned Hash = 0;
+	const int Size = pAddr->type == NETTYPE_IPV4 ? NETADDR_SIZE_IPV4 : NETADDR_SIZE_IPV6;
+	for(int i = 0; i < Size; i++)
+		Hash = Hash * 31 + pAddr->ip[i];
+
+	CInfoQueryLimit *pLimit = &m_aInfoQueryLimits[Hash % INFO_QUERY_LIMITS];
+	const int64 Now = time_get();
+	if(net_addr_comp(&pLimit->m_Addr, pAddr, false) != 0 || Now - pLimit->m_Start >= time_freq())
+	{
+		pLimit->m_Addr = *pAddr;
+		pLimit->m_Start = Now;
+		pLimit->m_Count = 0;
+	}
+	return ++pLimit->m_Count <= g_Config.m_SvInfoRateLimit;
 }
 
 bool CServer::LoadMap(int ID)
@@ -1235,25 +1591,13 @@ bool CServer::LoadMap(int ID)
 	// check for valid standard map
 	if(!m_MapChecker.ReadAndValidateMap(Storage(), aBuf, IStorageEngine::TYPE_ALL))
 	{
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "mapchecker", "invalid standard map");
-		return 0;
+		dbg_msg("mapchecker", "%s invalid standard map", aBuf);
+		return false;
 	}
 
 	IEngineMap *pMap = MultiWorlds()->GetWorld(ID)->m_pLoadedMap;
-	if(!pMap->Load(aBuf))
-		return 0;
-
-	// reinit snapshot ids
-	m_IDPool.TimeoutIDs();
-
-	// get the sha256 and crc of the map
-	char aSha256[SHA256_MAXSTRSIZE];
-	sha256_str(pMap->Sha256(), aSha256, sizeof(aSha256));
-	char aBufMsg[256];
-	str_format(aBufMsg, sizeof(aBufMsg), "%s sha256 is %s", aBuf, aSha256);
-	Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBufMsg);
-	str_format(aBufMsg, sizeof(aBufMsg), "%s crc is %08x", aBuf, pMap->Crc());
-	Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBufMsg);
+	if(!pMap->Load(aBuf, Storage()))
+		return false;
 
 	// load complete map into memory for download
 	{
@@ -1266,6 +1610,44 @@ bool CServer::LoadMap(int ID)
 	return true;
 }
 
+bool CServer::LoadMaps()
+{
+	// reading, validating and hashing the map files does not depend on the other worlds,
+	// the pool lives until all the results are collected
+	const int NumWorlds = MultiWorlds()->GetSizeInitilized();
+	ThreadPool LoadPool(clamp((int)std::thread::hardware_concurrency(), 1, NumWorlds));
+	std::vector<std::future<bool>> aLoads;
+	aLoads.reserve(NumWorlds);
+	for(int i = 0; i < NumWorlds; i++)
+		aLoads.push_back(LoadPool.enqueue([this, i]() { return LoadMap(i); }));
+
+	char aBuf[256];
+	bool Loaded = true;
+	for(int i = 0; i < NumWorlds; i++)
+	{
+		if(!aLoads[i].get())
+		{
+			str_format(aBuf, sizeof(aBuf), "maps/%s the map is not loaded...", MultiWorlds()->GetWorld(i)->m_aPath);
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+			Loaded = false;
+			continue;
+		}
+
+		// get the sha256 and crc of the map
+		IEngineMap *pMap = MultiWorlds()->GetWorld(i)->m_pLoadedMap;
+		char aSha256[SHA256_MAXSTRSIZE];
+		sha256_str(pMap->Sha256(), aSha256, sizeof(aSha256));
+		str_format(aBuf, sizeof(aBuf), "maps/%s sha256 is %s", MultiWorlds()->GetWorld(i)->m_aPath, aSha256);
+		Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBuf);
+		str_format(aBuf, sizeof(aBuf), "maps/%s crc is %08x", MultiWorlds()->GetWorld(i)->m_aPath, pMap->Crc());
+		Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBuf);
+	}
+
+	// reinit snapshot ids
+	m_IDPool.TimeoutIDs();
+	return Loaded;
+}
+
 void CServer::InitRegister(CNetServer *pNetServer, IEngineMasterServer *pMasterServer, IConsole *pConsole)
 {
 	m_Register.Init(pNetServer, pMasterServer, pConsole);
@@ -1279,15 +1661,8 @@ int CServer::Run()
 
 	// loading maps to memory
 	char aBuf[256];
-	for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
-	{
-		if(!LoadMap(i))
-		{
-			str_format(aBuf, sizeof(aBuf), "maps/%s the map is not loaded...", MultiWorlds()->GetWorld(i)->m_aPath);
-			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-			return -1;
-		}
-	}
+	if(!LoadMaps())
+		return -1;
 
 	// start server
 	NETADDR BindAddr;
@@ -1303,6 +1678,8 @@ int CServer::Run()
 		BindAddr.port = g_Config.m_SvPort;
 	}
 
+	// the connection slots are the player ids
+	static_assert((int)NET_MAX_CLIENTS >= (int)MAX_PLAYERS, "the network can't hold all players");
 	if(!m_NetServer.Open(BindAddr, m_pServerBan, g_Config.m_SvMaxClients, g_Config.m_SvMaxClientsPerIP, NewClientCallback, DelClientCallback, this))
 	{
 		dbg_msg("server", "couldn't open socket. port %d might already be in use", g_Config.m_SvPort);
@@ -1351,10 +1728,14 @@ int CServer::Run()
 			bool NewTicks = false;
 			bool ShouldSnap = false;
 			bool ExistsPlayers = false;
+			int NumTicks = 0;
+			CProfiler::SetEnabled(g_Config.m_SvProfiler);
 
 			while(t > TickStartTime(m_CurrentGameTick+1))
 			{
+				CProfilerScope TickScope(ProfilerSection(-1, "tick"));
 				m_CurrentGameTick++;
+				NumTicks++;
 				NewTicks = true;
 				if((m_CurrentGameTick % 2) == 0)
 					ShouldSnap = true;
@@ -1401,10 +1782,12 @@ int CServer::Run()
 				}
 
 				MultiWorlds()->GetWorld(MAIN_WORLD_ID)->m_pGameServer->OnTickMainWorld();
-				for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
+				TickWorlds();
+
+				// results of the asynchronous database queries
 				{
-					IGameServer* pGameServer = MultiWorlds()->GetWorld(i)->m_pGameServer;
-					pGameServer->OnTick();
+					CProfilerScope SqlScope(ProfilerSection(-1, "sql/callbacks"));
+					SJK.ProcessCompletedQueries();
 				}
 			}
 
@@ -1416,7 +1799,8 @@ int CServer::Run()
 					m_CurrentGameTick = 0;
 					m_GameStartTime = time_get();
 					SetOffsetWorldTime(0);
-					
+					SJK.DiscardCompletedQueries();
+
 					if(!MultiWorlds()->LoadWorlds(this, Kernel(), Storage(), Console()))
 					{
 						str_format(aBuf, sizeof(aBuf), "interfaces for heavy reload could not be updated...");
@@ -1424,16 +1808,9 @@ int CServer::Run()
 						return -1;
 					}
 					
-					for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
-					{
-						// load map data
-						if(!LoadMap(i))
-						{
-							str_format(aBuf, sizeof(aBuf), "maps/%s the map is not loaded...", MultiWorlds()->GetWorld(i)->m_aPath);
-							Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-							return -1;
-						}
-					}
+					// load map data
+					if(!LoadMaps())
+						return -1;
 
 					if(m_HeavyReload)
 					{
@@ -1443,13 +1820,20 @@ int CServer::Run()
 							if(m_aClients[ClientID].m_State <= CClient::STATE_AUTH)
 								continue;
 
+							// the player stays in the world when the standard one is full
+							UnmapClientID(m_aClients[ClientID].m_WorldID, ClientID);
+							if(MapClientID(WORLD_STANDARD, ClientID) != -1)
+								m_aClients[ClientID].m_WorldID = WORLD_STANDARD;
+							else
+								MapClientID(m_aClients[ClientID].m_WorldID, ClientID);
+
 							m_aClients[ClientID].Reset();
 							m_aClients[ClientID].m_State = CClient::STATE_CONNECTING;
-							m_aClients[ClientID].m_WorldID = WORLD_STANDARD;
 							SendDataMmoInfo(ClientID);
 							SendMap(ClientID);
 						}
 						m_HeavyReload = false;
+						ExpireServerInfo();
 					}
 					else
 						Init();
@@ -1467,16 +1851,21 @@ int CServer::Run()
 					// snap game
 					if(g_Config.m_SvHighBandwidth || ShouldSnap)
 					{
+						CProfilerScope SnapScope(ProfilerSection(-1, "snap"));
 						for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
 							DoSnapshot(i);
 					}
 					UpdateClientRconCommands();
 				}
+				UpdateProfiler(time_get() - t, NumTicks);
 			}
 
 			// master server stuff
 			m_Register.RegisterUpdate(m_NetServer.NetType());
-			PumpNetwork();
+			{
+				CProfilerScope NetworkScope(ProfilerSection(-1, "network"));
+				PumpNetwork();
+			}
 
 			// wait for incomming data
 			net_socket_read_wait(m_NetServer.Socket(), clamp(int((TickStartTime(m_CurrentGameTick + 1) - time_get()) * 1000 / time_freq()), 1, 1000 / SERVER_TICK_SPEED / 2));
@@ -1524,6 +1913,16 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Server", aBuf);
 		}
 	}
+
+	for(int i = 0; i < pThis->MultiWorlds()->GetSizeInitilized(); i++)
+	{
+		IGameServer* pGameServer = pThis->MultiWorlds()->GetWorld(i)->m_pGameServer;
+		if(pGameServer->IsDormant())
+			str_format(aBuf, sizeof(aBuf), "world=%d name='%s' dormant=%ds", i, pThis->GetWorldName(i), pGameServer->GetDormantTicks() / pThis->TickSpeed());
+		else
+			str_format(aBuf, sizeof(aBuf), "world=%d name='%s' active", i, pThis->GetWorldName(i));
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Server", aBuf);
+	}
 }
 
 void CServer::ConShutdown(IConsole::IResult *pResult, void *pUser)
@@ -1556,16 +1955,75 @@ void CServer::ConLogout(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::ConSqlStatus(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+
+	CConectionPool::CStats Stats;
+	SJK.GetStats(&Stats);
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "workers=%d queued=%d peak=%d executed=%lld failed=%lld stalled=%lld latency avg=%dms max=%dms prepared hit=%lld miss=%lld",
+		Stats.m_Workers, Stats.m_QueueDepth, Stats.m_PeakQueueDepth, Stats.m_Executed, Stats.m_Failed, Stats.m_Stalled, Stats.m_AverageLatency, Stats.m_MaxLatency,
+		Stats.m_PreparedHits, Stats.m_PreparedMisses);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sql", aBuf);
+}
+
+void CServer::ConProfiler(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "enabled=%d overruns=%lld (times in microseconds)", g_Config.m_SvProfiler, CProfiler::GetOverruns());
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profiler", aBuf);
+
+	NETSTATS Stats;
+	net_stats(&Stats);
+	str_format(aBuf, sizeof(aBuf), "net: batch=%d recv=%.2f sent=%.2f packets per syscall", g_Config.m_SvNetBatch,
+		Stats.recv_calls ? Stats.recv_packets / (float)Stats.recv_calls : 0.0f, Stats.sent_calls ? Stats.sent_packets / (float)Stats.sent_calls : 0.0f);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profiler", aBuf);
+
+	CProfiler::ListSections(pResult->NumArguments() ? pResult->GetString(0) : "", [](const CProfilerSection *pSection, void *pUser)
+	{
+		CProfilerSection::CStats Stats;
+		pSection->GetStats(&Stats);
+
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "%s: samples=%lld p50=%d p99=%d max=%d", pSection->GetName(), Stats.m_Samples, Stats.m_P50, Stats.m_P99, Stats.m_Max);
+		static_cast<CServer *>(pUser)->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profiler", aBuf);
+	}, pThis);
+}
+
+void CServer::ConProfilerReset(IConsole::IResult *pResult, void *pUser)
+{
+	CProfiler::Reset();
+}
+
+void CServer::ConProfilerDump(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	if(pThis->DumpProfiler())
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profiler", "profiler written");
+}
+
 void CServer::ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
 	if(pResult->NumArguments())
 	{
 		str_clean_whitespaces(g_Config.m_SvName);
+		((CServer *)pUserData)->ExpireServerInfo();
 		((CServer *)pUserData)->SendServerInfo(-1);
 	}
 }
 
+void CServer::ConchainExpireServerInfo(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
+{
+	pfnCallback(pResult, pCallbackUserData);
+	if(pResult->NumArguments())
+		((CServer *)pUserData)->ExpireServerInfo();
+}
+
 void CServer::ConchainMaxclientsperipUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
@@ -1573,6 +2031,13 @@ void CServer::ConchainMaxclientsperipUpdate(IConsole::IResult *pResult, void *pU
 		((CServer *)pUserData)->m_NetServer.SetMaxClientsPerIP(pResult->GetInteger(0));
 }
 
+void CServer::ConchainPathfinderThreadsUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
+{
+	pfnCallback(pResult, pCallbackUserData);
+	if(pResult->NumArguments())
+		((CServer *)pUserData)->ResetPathfinderPool();
+}
+
 void CServer::ConchainModCommandUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	if(pResult->NumArguments() == 2)
@@ -1632,14 +2097,23 @@ void CServer::RegisterCommands()
 	Console()->Register("shutdown", "", CFGFLAG_SERVER, ConShutdown, this, "Shut down");
 	Console()->Register("reload", "", CFGFLAG_SERVER, ConReload, this, "Reload maps and synchronize data with the database");
 	Console()->Register("logout", "", CFGFLAG_SERVER, ConLogout, this, "Logout of rcon");
+	Console()->Register("sql_status", "", CFGFLAG_SERVER, ConSqlStatus, this, "Show the queue and latency counters of the MySQL pool");
+	Console()->Register("profiler", "?s[filter]", CFGFLAG_SERVER, ConProfiler, this, "Show the p50, p99 and max times of the profiled sections");
+	Console()->Register("profiler_reset", "", CFGFLAG_SERVER, ConProfilerReset, this, "Reset the samples of the profiler");
+	Console()->Register("profiler_dump", "", CFGFLAG_SERVER, ConProfilerDump, this, "Write the profiler to sv_profiler_dump_file as json");
 
 	Console()->Chain("sv_name", ConchainSpecialInfoupdate, this);
 	Console()->Chain("password", ConchainSpecialInfoupdate, this);
+	Console()->Chain("sv_hostname", ConchainExpireServerInfo, this);
+	Console()->Chain("sv_map", ConchainExpireServerInfo, this);
+	Console()->Chain("sv_gametype", ConchainExpireServerInfo, this);
+	Console()->Chain("sv_skill_level", ConchainExpireServerInfo, this);
 
 	Console()->Chain("sv_max_clients_per_ip", ConchainMaxclientsperipUpdate, this);
 	Console()->Chain("mod_command", ConchainModCommandUpdate, this);
 	Console()->Chain("console_output_level", ConchainConsoleOutputLevelUpdate, this);
 	Console()->Chain("sv_rcon_password", ConchainRconPasswordSet, this);
+	Console()->Chain("sv_pathfinder_threads", ConchainPathfinderThreadsUpdate, this);
 
 	// register console commands in sub parts
 	m_pServerBan->InitServerBan(Console(), Storage(), this, &m_NetServer);
@@ -1682,6 +2156,20 @@ void *CServer::SnapNewItem(int Type, int ID, int Size)
 	return ID < 0 ? 0 : m_SnapshotBuilder.NewItem(Type, ID, Size);
 }
 
+int CServer::SnapNumItems() const
+{
+	return m_SnapshotBuilder.NumItems();
+}
+
+const void *CServer::SnapGetItem(int Index, int *pType, int *pID, int *pSize) const
+{
+	const CSnapshotItem *pItem = m_SnapshotBuilder.GetItem(Index);
+	*pType = pItem->Type();
+	*pID = pItem->ID();
+	*pSize = m_SnapshotBuilder.GetItemSize(Index);
+	return pItem->Data();
+}
+
 void CServer::SnapSetStaticsize(int ItemType, int Size)
 {
 	m_SnapshotDelta.SetStaticsize(ItemType, Size);
@@ -65,6 +65,7 @@ public:
 		char m_aName[MAX_NAME_ARRAY_SIZE];
 		char m_aClan[MAX_CLAN_ARRAY_SIZE];
 		char m_aLanguage[MAX_LANGUAGE_LENGTH];
+		CLocalization::CLanguage* m_pLanguage; // resolved on the language change, nullptr is the main language
 
 		int m_Version;
 		int m_Country;
@@ -87,6 +88,29 @@ public:
 	};
 
 	CClient m_aClients[MAX_CLIENTS];
+
+	/*
+		Class: Client ID Map
+			The ids of the players and bots of one world in the protocol. Players take
+			the ids of bots when the world is full. The ids are read from the parallel
+			ticked worlds, so the entries are atomic.
+	*/
+	class CClientIDMap
+	{
+		std::mutex m_Lock;
+		std::atomic<int> m_aProtocolIDs[MAX_CLIENTS];
+		std::atomic<int> m_aClientIDs[PROTOCOL_MAX_CLIENTS];
+
+	public:
+		CClientIDMap();
+
+		int Map(int ClientID);
+		void Unmap(int ClientID);
+		int ProtocolID(int ClientID) const { return m_aProtocolIDs[ClientID]; }
+		int ClientID(int ProtocolID) const { return m_aClientIDs[ProtocolID]; }
+	};
+	CClientIDMap m_aClientIDMaps[ENGINE_MAX_WORLDS];
+
 	CSnapshotDelta m_SnapshotDelta;
 	CSnapshotBuilder m_SnapshotBuilder;
 	CSnapIDPool m_IDPool;
@@ -114,6 +138,61 @@ public:
 	CRegister m_Register;
 	CMapChecker m_MapChecker;
 
+	// parallel ticking of the worlds (sv_world_threads)
+	std::unique_ptr<ThreadPool> m_pWorldsPool;
+	int m_WorldsPoolThreads;
+	std::mutex m_SendLock;
+	std::mutex m_MainThreadTasksLock;
+	std::vector<std::function<void()>> m_aMainThreadTasks;
+	void TickWorlds();
+
+	// path searches of the mobs, the pool is rebuilt when sv_pathfinder_threads changes
+	std::mutex m_PathfinderPoolLock;
+	std::unique_ptr<ThreadPool> m_pPathfinderPool;
+	void ResetPathfinderPool();
+
+	// snapshot of a client waiting for the delta and compression (sv_snap_threads)
+	struct CSnapJob
+	{
+		int m_ClientID;
+		int m_Crc;
+		int m_DeltaTick;
+		const CSnapshot *m_pDeltashot;
+		int m_CompSize;
+		char m_aData[CSnapshot::MAX_SIZE];
+		char m_aDeltaData[CSnapshot::MAX_SIZE];
+		char m_aCompData[CSnapshot::MAX_SIZE];
+	};
+	std::vector<CSnapJob> m_aSnapJobs;
+	std::unique_ptr<ThreadPool> m_pSnapPool;
+	int m_SnapPoolThreads;
+	void CompressSnapshot(CSnapJob *pJob);
+	void SendSnapshot(const CSnapJob *pJob, int WorldID);
+
+	// tick and snapshot profiler (sv_profiler)
+	int64 m_LastProfilerDump;
+	int64 m_LastOverrunMessage;
+	int m_OverrunsSinceMessage;
+	class CProfilerSection *ProfilerSection(int WorldID, const char *pStage) const;
+	void UpdateProfiler(int64 FrameTime, int NumTicks);
+	bool DumpProfiler();
+
+	// the browser info without the token, packed again only when something in it changes
+	enum
+	{
+		INFO_QUERY_LIMITS=1024,
+	};
+	struct CInfoQueryLimit
+	{
+		NETADDR m_Addr;
+		int64 m_Start;
+		int m_Count;
+	};
+	CPacker m_ServerInfoCache;
+	std::atomic<bool> m_ServerInfoExpired;
+	CInfoQueryLimit m_aInfoQueryLimits[INFO_QUERY_LIMITS];
+	bool InfoQueryAllowed(const NETADDR *pAddr);
+
 	CServer();
 	~CServer();
 
@@ -143,6 +222,8 @@ public:
 
 	virtual void ChangeWorld(int ClientID, int NewWorldID);
 	virtual int GetClientWorldID(int ClientID);
+	virtual void ExecuteOnMainThread(std::function<void()> Func);
+	virtual void EnqueuePathSearch(std::function<void()> Func);
 	virtual void BackInformationFakeClient(int FakeClientID);
 
 	virtual void SetClientProtocolVersion(int ClientID, int Version);
@@ -150,6 +231,7 @@ public:
 
 	virtual void SetClientLanguage(int ClientID, const char* pLanguage);
 	virtual const char* GetClientLanguage(int ClientID) const;
+	virtual CLocalization::CLanguage* GetClientLanguageInfo(int ClientID) const;
 	virtual const char* GetWorldName(int WorldID);
 
 	virtual void SendDiscordMessage(const char *pChannel, int Color, const char* pTitle, const char* pText);
@@ -177,7 +259,12 @@ public:
 	int ClientCountry(int ClientID) const override;
 	bool ClientIngame(int ClientID) const override;
 
-	virtual int SendMsg(CMsgPacker* pMsg, int Flags, int ClientID, int64 Mask = -1, int WorldID = -1);
+	int SendMsg(CMsgPacker* pMsg, int Flags, int ClientID, const CClientMask *pMask = nullptr, int WorldID = -1) override;
+
+	int MapClientID(int WorldID, int ClientID) override;
+	void UnmapClientID(int WorldID, int ClientID) override;
+	int TranslateClientID(int WorldID, int ClientID) const override;
+	int ReverseTranslateClientID(int WorldID, int ProtocolID) const override;
 
 	void DoSnapshot(int WorldID);
 
@@ -196,11 +283,13 @@ public:
 	void ProcessClientPacket(CNetChunk *pPacket);
 
 	void SendServerInfo(int ClientID);
-	void GenerateServerInfo(CPacker *pPacker, int Token);
+	void GenerateServerInfo(CPacker *pPacker, bool ListClients);
+	void ExpireServerInfo() override { m_ServerInfoExpired = true; }
 
 	void PumpNetwork();
 
 	bool LoadMap(int ID);
+	bool LoadMaps();
 
 	void InitRegister(CNetServer *pNetServer, IEngineMasterServer *pMasterServer, IConsole *pConsole);
 	int Run();
@@ -210,12 +299,18 @@ public:
 	static void ConShutdown(IConsole::IResult *pResult, void *pUser);
 	static void ConReload(IConsole::IResult *pResult, void *pUser);
 	static void ConLogout(IConsole::IResult *pResult, void *pUser);
+	static void ConSqlStatus(IConsole::IResult *pResult, void *pUser);
+	static void ConProfiler(IConsole::IResult *pResult, void *pUser);
+	static void ConProfilerReset(IConsole::IResult *pResult, void *pUser);
+	static void ConProfilerDump(IConsole::IResult *pResult, void *pUser);
 
 	static void ConchainSpecialInfoupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
+	static void ConchainExpireServerInfo(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainMaxclientsperipUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainModCommandUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainConsoleOutputLevelUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainRconPasswordSet(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
+	static void ConchainPathfinderThreadsUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 
 	void RegisterCommands();
 
@@ -226,6 +321,8 @@ public:
 	virtual void SnapFreeID(int ID);
 	virtual void *SnapNewItem(int Type, int ID, int Size);
 	void SnapSetStaticsize(int ItemType, int Size);
+	int SnapNumItems() const override;
+	const void *SnapGetItem(int Index, int *pType, int *pID, int *pSize) const override;
 };
 
 #endif
\ No newline at end of file
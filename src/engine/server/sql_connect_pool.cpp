@@ -1,52 +1,58 @@
 #include "sql_connect_pool.h"
 
 #include <engine/shared/config.h>
+#include <engine/shared/profiler.h>
 
+#include <cppconn/datatype.h>
+
+#include <algorithm>
 #include <stdarg.h>
 
 /*
-	I don't see the point in using SELECT operations in the thread,
-	since this will lead to unnecessary code, which may cause confusion,
-	and by calculations if (SQL server / server) = localhost,
-	this will not do any harm (but after the release is complete,
-	it is advisable to use the Thread function with Callback)
-
-	And in General, you should review the SQL system,
-	it works (and has been tested by time and tests),
-	but this implementation is not very narrowly focused
-
-	This approach works if the old query is not executed before,
-	 a new query it will create a reserve.
-
-	 It may seem that it does not use Pool,
-	 but in fact it is and is created as a reserve when running
-	 <tlock>
-
-	 Usage is performed in turn following synchronously
-	 working running through each request in order
-
-	 This pool is not asynchronous
+	SELECT operations through SD are performed synchronously on the calling thread
+	with a connection taken from the reserve list (it is created on demand),
+	by calculations if (SQL server / server) = localhost this will not do any harm.
+
+	INSERT / UPDATE / DELETE, SDT and SDA are asynchronous, they are queued to a
+	fixed number of workers (sv_sql_pool_size), each working with its own connection.
+	The queries to one table are executed in turn in the order in which they were added,
+	unless they have an order key (CSqlParams::OrderKey), then only the queries with the
+	same key and the ones without a key keep their order, the other keys run in parallel.
+	The delayed queries (IDS, UDS, DDS) wait in a timer heap and don't hold the queue,
+	they take their place in it when they are due.
+
+	The queue is bounded (sv_sql_queue_size per worker), if it is full the game thread
+	waits for a free place, the workers themselves never wait so as not to lock each other.
+
+	SDT calls the callback in the worker thread, SDA returns the result to the main thread,
+	where the callback is called from ProcessCompletedQueries between server ticks,
+	so it can safely work with the game world.
+
+	Every function also has a variant with CSqlParams, then the query is not formatted
+	into a fixed buffer, the values are bound to the '?' placeholders. The workers keep
+	the prepared statements of their connection in CSqlStatementCache, the result set
+	of the cached statement is valid only until its next execution, so the queries whose
+	result leaves the worker (SD, SDA) are prepared without the cache.
 */
 // sql pool connections mutex
 std::mutex SqlConnectionLock;
-// multithread mutex :: warning recursive
-std::recursive_mutex SqlThreadRecursiveLock;
+// marks the threads of the pool workers
+static thread_local bool s_SqlWorkerThread = false;
 
 // #####################################################
 // SQL CONNECTION POOL
 // #####################################################
 std::shared_ptr<CConectionPool> CConectionPool::m_Instance;
 CConectionPool::CConectionPool()
+	: m_Generation(0), m_Shutdown(false), m_QueueDepth(0), m_PeakQueueDepth(0), m_ExecutedJobs(0), m_FailedJobs(0), m_StalledJobs(0), m_TotalLatency(0), m_MaxLatency(0),
+	m_PreparedHits(0), m_PreparedMisses(0)
 {
 	try
 	{
 		m_pDriver = get_driver_instance();
 
 		SqlConnectionLock.lock();
-
-		for(int i = 0; i < g_Config.m_SvMySqlPoolSize; ++i)
-			this->CreateConnection();
-
+		this->CreateConnection();
 		SqlConnectionLock.unlock();
 	}
 	catch(SQLException &e)
@@ -54,6 +60,8 @@ CConectionPool::CConectionPool()
 		dbg_msg("Sql Exception", "%s", e.what());
 		exit(0);
 	}
+
+	StartWorkers();
 }
 
 CConectionPool::~CConectionPool()
@@ -68,7 +76,7 @@ CConectionPool& CConectionPool::GetInstance()
 	return *m_Instance.get();
 }
 
-Connection* CConectionPool::CreateConnection()
+Connection* CConectionPool::Connect()
 {
 	Connection *pConnection = nullptr;
 	while(pConnection == nullptr)
@@ -90,9 +98,16 @@ Connection* CConectionPool::CreateConnection()
 		catch(SQLException &e)
 		{
 			dbg_msg("Sql Exception", "%s", e.what());
-			DisconnectConnection(pConnection);
+			delete pConnection;
+			pConnection = nullptr;
 		}
 	}
+	return pConnection;
+}
+
+Connection* CConectionPool::CreateConnection()
+{
+	Connection *pConnection = Connect();
 	m_ConnList.push_back(pConnection);
 	return pConnection;
 }
@@ -104,7 +119,7 @@ Connection* CConectionPool::GetConnection()
 	Connection* pConnection;
 	if(m_ConnList.empty())
 	{
-		pConnection = CreateConnection();
+		pConnection = Connect();
 
 		SqlConnectionLock.unlock();
 		return pConnection;
@@ -116,7 +131,7 @@ Connection* CConectionPool::GetConnection()
 	{
 		delete pConnection;
 		pConnection = nullptr;
-		pConnection = CreateConnection();
+		pConnection = Connect();
 	}
 
 	SqlConnectionLock.unlock();
@@ -155,16 +170,403 @@ void CConectionPool::DisconnectConnection(Connection* pConnection)
 
 void CConectionPool::DisconnectConnectionHeap()
 {
-	SqlConnectionLock.lock();
+	// complete all queued requests before closing
+	StopWorkers();
 
-	for(auto& iconn : m_ConnList)
-		DisconnectConnection(iconn);
+	SqlConnectionLock.lock();
 
-	m_ConnList.clear();
+	while(!m_ConnList.empty())
+		DisconnectConnection(m_ConnList.front());
 
 	SqlConnectionLock.unlock();
 }
 
+// #####################################################
+// PREPARED STATEMENTS
+// #####################################################
+void CSqlParams::Bind(PreparedStatement *pStmt) const
+{
+	unsigned int Index = 1;
+	for(const auto& Param : m_aParams)
+	{
+		switch(Param.m_Type)
+		{
+			case PARAM_INT: pStmt->setInt(Index, (int)Param.m_Integer); break;
+			case PARAM_INT64: pStmt->setInt64(Index, Param.m_Integer); break;
+			case PARAM_DOUBLE: pStmt->setDouble(Index, Param.m_Double); break;
+			case PARAM_STRING: pStmt->setString(Index, Param.m_String); break;
+			default: pStmt->setNull(Index, DataType::SQLNULL);
+		}
+		Index++;
+	}
+}
+
+PreparedStatement *CSqlStatementCache::Get(Connection *pConnection, const std::string &Query, bool *pPrepared)
+{
+	auto It = m_aStatements.find(Query);
+	if(It != m_aStatements.end())
+	{
+		*pPrepared = false;
+		return It->second.get();
+	}
+
+	// the queries are written in the code, so the limit is reached only with the generated ones
+	if(m_aStatements.size() >= MAX_STATEMENTS)
+		Clear();
+
+	std::unique_ptr<PreparedStatement> pStmt(pConnection->prepareStatement(Query.c_str()));
+	PreparedStatement *pResult = pStmt.get();
+	m_aStatements[Query] = std::move(pStmt);
+	*pPrepared = true;
+	return pResult;
+}
+
+void CSqlStatementCache::Remove(const std::string &Query)
+{
+	auto It = m_aStatements.find(Query);
+	if(It == m_aStatements.end())
+		return;
+
+	try
+	{
+		It->second->close();
+	}
+	catch(SQLException& e)
+	{
+		dbg_msg("Sql Exception", "%s", e.what());
+	}
+	m_aStatements.erase(It);
+}
+
+void CSqlStatementCache::Clear()
+{
+	for(auto& Statement : m_aStatements)
+	{
+		try
+		{
+			Statement.second->close();
+		}
+		catch(SQLException& e)
+		{
+			dbg_msg("Sql Exception", "%s", e.what());
+		}
+	}
+	m_aStatements.clear();
+}
+
+// #####################################################
+// SQL POOL WORKERS
+// #####################################################
+bool CConectionPool::CSqlKeySet::Conflicts(const CSqlJob &Job) const
+{
+	auto It = m_Tables.find(Job.m_Table);
+	if(It == m_Tables.end())
+		return false;
+	if(!Job.m_Ordered)
+		return It->second.m_Total > 0;
+	return It->second.m_Unordered > 0 || It->second.m_Keys.count(Job.m_OrderKey) > 0;
+}
+
+void CConectionPool::CSqlKeySet::Add(const CSqlJob &Job)
+{
+	CTable &Table = m_Tables[Job.m_Table];
+	Table.m_Total++;
+	if(Job.m_Ordered)
+		Table.m_Keys[Job.m_OrderKey]++;
+	else
+		Table.m_Unordered++;
+}
+
+void CConectionPool::CSqlKeySet::Remove(const CSqlJob &Job)
+{
+	auto It = m_Tables.find(Job.m_Table);
+	if(It == m_Tables.end())
+		return;
+
+	CTable &Table = It->second;
+	if(Job.m_Ordered)
+	{
+		auto KeyIt = Table.m_Keys.find(Job.m_OrderKey);
+		if(KeyIt != Table.m_Keys.end() && --KeyIt->second == 0)
+			Table.m_Keys.erase(KeyIt);
+	}
+	else
+		Table.m_Unordered--;
+
+	if(--Table.m_Total == 0)
+		m_Tables.erase(It);
+}
+
+// the earliest delayed job is at the front of the heap
+static bool SqlJobLater(const std::chrono::steady_clock::time_point &A, const std::chrono::steady_clock::time_point &B) { return A > B; }
+
+void CConectionPool::StartWorkers()
+{
+	m_Shutdown = false;
+	for(int i = 0; i < g_Config.m_SvMySqlPoolSize; ++i)
+		m_aWorkers.emplace_back(&CConectionPool::WorkerThread, this);
+}
+
+void CConectionPool::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_JobsLock);
+		m_Shutdown = true;
+	}
+	m_CondJob.notify_all();
+	m_CondSpace.notify_all();
+
+	for(auto& Worker : m_aWorkers)
+	{
+		if(Worker.joinable())
+			Worker.join();
+	}
+	m_aWorkers.clear();
+}
+
+void CConectionPool::ReleaseDelayedJobs()
+{
+	const auto Now = std::chrono::steady_clock::now();
+	auto Compare = [](const CSqlJob &A, const CSqlJob &B) { return SqlJobLater(A.m_ExecuteTime, B.m_ExecuteTime); };
+	while(!m_aDelayedJobs.empty() && (m_Shutdown || m_aDelayedJobs.front().m_ExecuteTime <= Now))
+	{
+		std::pop_heap(m_aDelayedJobs.begin(), m_aDelayedJobs.end(), Compare);
+		m_aJobs.push_back(std::move(m_aDelayedJobs.back()));
+		m_aDelayedJobs.pop_back();
+	}
+}
+
+bool CConectionPool::TakeJob(CSqlJob *pJob)
+{
+	// the skipped jobs block the later ones with their keys, so the order of a key is kept
+	CSqlKeySet Skipped;
+	for(auto It = m_aJobs.begin(); It != m_aJobs.end(); ++It)
+	{
+		if(m_RunningKeys.Conflicts(*It) || Skipped.Conflicts(*It))
+		{
+			Skipped.Add(*It);
+			continue;
+		}
+
+		*pJob = std::move(*It);
+		m_aJobs.erase(It);
+		m_RunningKeys.Add(*pJob);
+		return true;
+	}
+	return false;
+}
+
+void CConectionPool::WorkerThread()
+{
+	s_SqlWorkerThread = true;
+	m_pDriver->threadInit();
+	Connection* pConnection = Connect();
+	CSqlStatementCache Statements;
+
+	std::unique_lock<std::mutex> Lock(m_JobsLock);
+	while(true)
+	{
+		ReleaseDelayedJobs();
+
+		CSqlJob Job;
+		if(!TakeJob(&Job))
+		{
+			// on shutdown all queued requests are completed before the connection is closed
+			if(m_Shutdown && m_aJobs.empty() && m_aDelayedJobs.empty())
+				break;
+
+			if(!m_Shutdown && !m_aDelayedJobs.empty())
+				m_CondJob.wait_until(Lock, m_aDelayedJobs.front().m_ExecuteTime);
+			else
+				m_CondJob.wait(Lock);
+			continue;
+		}
+
+		m_QueueDepth--;
+		Lock.unlock();
+		m_CondSpace.notify_one();
+
+		if(pConnection->isClosed())
+		{
+			Statements.Clear();
+			delete pConnection;
+			pConnection = Connect();
+		}
+		{
+			CProfilerScope ProfilerScope(ProfilerSection(Job.m_Table.c_str(), false));
+			ExecuteJob(pConnection, &Statements, Job);
+		}
+
+		const int64 Latency = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Job.m_QueuedTime).count();
+		m_TotalLatency += Latency;
+		int64 MaxLatency = m_MaxLatency;
+		while(Latency > MaxLatency && !m_MaxLatency.compare_exchange_weak(MaxLatency, Latency)) {}
+
+		// the jobs that waited for this key can be taken by the other workers
+		Lock.lock();
+		m_RunningKeys.Remove(Job);
+		m_CondJob.notify_all();
+	}
+	Lock.unlock();
+
+	Statements.Clear();
+	try
+	{
+		pConnection->close();
+	}
+	catch(SQLException& e)
+	{
+		dbg_msg("Sql Exception", "%s", e.what());
+	}
+	delete pConnection;
+	m_pDriver->threadEnd();
+}
+
+void CConectionPool::ExecuteJob(Connection *pConnection, CSqlStatementCache *pStatements, CSqlJob &Job)
+{
+	// the result is no longer needed by anyone
+	if(Job.m_pHandle && (Job.m_pHandle->IsCanceled() || Job.m_Generation != m_Generation))
+		return;
+
+	try
+	{
+		ResultPtr pResult;
+		if(Job.m_Prepared)
+		{
+			std::unique_ptr<PreparedStatement> pOwnStmt;
+			PreparedStatement *pStmt;
+			if(Job.m_pHandle)
+			{
+				pOwnStmt.reset(pConnection->prepareStatement(Job.m_Query.c_str()));
+				pStmt = pOwnStmt.get();
+			}
+			else
+			{
+				bool Prepared = false;
+				pStmt = pStatements->Get(pConnection, Job.m_Query, &Prepared);
+				if(Prepared)
+					m_PreparedMisses++;
+				else
+					m_PreparedHits++;
+			}
+
+			Job.m_Params.Bind(pStmt);
+			if(Job.m_pHandle || Job.m_Func)
+				pResult.reset(pStmt->executeQuery());
+			else
+				pStmt->executeUpdate();
+		}
+		else
+		{
+			std::unique_ptr<Statement> pStmt(pConnection->createStatement());
+			if(Job.m_pHandle || Job.m_Func)
+				pResult.reset(pStmt->executeQuery(Job.m_Query.c_str()));
+			else
+				pStmt->executeUpdate(Job.m_Query.c_str());
+			pStmt->close();
+		}
+
+		if(Job.m_pHandle)
+		{
+			CSqlCompletedJob Completed;
+			Completed.m_pResult = std::move(pResult);
+			Completed.m_Func = std::move(Job.m_Func);
+			Completed.m_pHandle = std::move(Job.m_pHandle);
+			Completed.m_Generation = Job.m_Generation;
+
+			std::lock_guard<std::mutex> Lock(m_CompletedLock);
+			m_aCompletedJobs.push_back(std::move(Completed));
+		}
+		else if(Job.m_Func)
+			Job.m_Func(std::move(pResult));
+	}
+	catch(SQLException& e)
+	{
+		// the statement could be lost together with the connection, it will be prepared again
+		if(Job.m_Prepared)
+			pStatements->Remove(Job.m_Query);
+
+		m_FailedJobs++;
+		dbg_msg("SQL", "%s", e.what());
+	}
+	m_ExecutedJobs++;
+}
+
+void CConectionPool::AddJob(const char *pTable, std::string Query, int Milliseconds, std::function<void(ResultPtr)> Func, SqlQueryHandle pHandle,
+	const CSqlParams *pParams)
+{
+	if(m_aWorkers.empty())
+	{
+		dbg_msg("SQL", "query after pool shutdown was dropped: %s", Query.c_str());
+		return;
+	}
+
+	CSqlJob Job;
+	Job.m_Table = pTable;
+	Job.m_Ordered = pParams && pParams->IsOrdered();
+	Job.m_OrderKey = pParams ? pParams->GetOrderKey() : 0;
+	Job.m_Query = std::move(Query);
+	Job.m_Prepared = pParams != nullptr;
+	if(pParams)
+		Job.m_Params = *pParams;
+	Job.m_Func = std::move(Func);
+	Job.m_QueuedTime = std::chrono::steady_clock::now();
+	Job.m_ExecuteTime = Job.m_QueuedTime + std::chrono::milliseconds(max(Milliseconds, 0));
+	Job.m_pHandle = std::move(pHandle);
+	Job.m_Generation = m_Generation;
+
+	std::unique_lock<std::mutex> Lock(m_JobsLock);
+
+	// backpressure only for outside threads, the worker can't wait for itself
+	const size_t MaxJobs = (size_t)g_Config.m_SvMySqlQueueSize * m_aWorkers.size();
+	if(!s_SqlWorkerThread && m_aJobs.size() + m_aDelayedJobs.size() >= MaxJobs)
+	{
+		m_StalledJobs++;
+		m_CondSpace.wait(Lock, [this, MaxJobs]() { return m_Shutdown || m_aJobs.size() + m_aDelayedJobs.size() < MaxJobs; });
+	}
+
+	if(Milliseconds > 0 && !m_Shutdown)
+	{
+		m_aDelayedJobs.push_back(std::move(Job));
+		std::push_heap(m_aDelayedJobs.begin(), m_aDelayedJobs.end(), [](const CSqlJob &A, const CSqlJob &B) { return SqlJobLater(A.m_ExecuteTime, B.m_ExecuteTime); });
+	}
+	else
+		m_aJobs.push_back(std::move(Job));
+	const int QueueDepth = ++m_QueueDepth;
+	int PeakQueueDepth = m_PeakQueueDepth;
+	while(QueueDepth > PeakQueueDepth && !m_PeakQueueDepth.compare_exchange_weak(PeakQueueDepth, QueueDepth)) {}
+
+	Lock.unlock();
+
+	// a delayed job can be earlier than the one the workers wait for
+	m_CondJob.notify_all();
+}
+
+CProfilerSection *CConectionPool::ProfilerSection(const char *pTable, bool Synchronous)
+{
+	if(!CProfiler::IsEnabled())
+		return nullptr;
+
+	char aName[64];
+	str_format(aName, sizeof(aName), "sql/%s/%s", Synchronous ? "sync" : "async", pTable);
+	return CProfiler::Section(aName);
+}
+
+void CConectionPool::GetStats(CStats *pStats) const
+{
+	const int64 Executed = m_ExecutedJobs;
+	pStats->m_Workers = (int)m_aWorkers.size();
+	pStats->m_QueueDepth = m_QueueDepth;
+	pStats->m_PeakQueueDepth = m_PeakQueueDepth;
+	pStats->m_Executed = Executed;
+	pStats->m_Failed = m_FailedJobs;
+	pStats->m_Stalled = m_StalledJobs;
+	pStats->m_AverageLatency = Executed > 0 ? (int)(m_TotalLatency / Executed) : 0;
+	pStats->m_MaxLatency = (int)m_MaxLatency;
+	pStats->m_PreparedHits = m_PreparedHits;
+	pStats->m_PreparedMisses = m_PreparedMisses;
+}
+
 // #####################################################
 // INSERT SQL
 // #####################################################
@@ -184,6 +586,17 @@ void CConectionPool::IDS(int Milliseconds, const char *Table, const char *Buffer
 	va_end(Arguments);
 }
 
+void CConectionPool::ID(const char *Table, const char *Buffer, const CSqlParams &Params)
+{
+	IDS(0, Table, Buffer, Params);
+}
+
+void CConectionPool::IDS(int Milliseconds, const char *Table, const char *Buffer, const CSqlParams &Params)
+{
+	std::string Query("INSERT INTO " + std::string(Table) + " " + std::string(Buffer) + ";");
+	AddJob(Table, std::move(Query), Milliseconds, nullptr, nullptr, &Params);
+}
+
 void CConectionPool::InsertFormated(int Milliseconds, const char *Table, const char *Buffer, va_list args)
 {
 	char aBuf[1024];
@@ -194,34 +607,7 @@ void CConectionPool::InsertFormated(int Milliseconds, const char *Table, const c
 	#endif
 	aBuf[sizeof(aBuf) - 1] = '\0';
 	std::string Query("INSERT INTO " + std::string(Table) + " " + std::string(aBuf) + ";");
-	std::thread Thread([this, Query, Milliseconds]()
-	{
-		if(Milliseconds > 0)
-			std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
-
-		const char* pError = nullptr;
-
-		SqlThreadRecursiveLock.lock();
-		m_pDriver->threadInit();
-		Connection* pConnection = SJK.GetConnection();
-		try
-		{
-			std::unique_ptr<Statement> pStmt(pConnection->createStatement());
-			pStmt->executeUpdate(Query.c_str());
-			pStmt->close();
-		}
-		catch (SQLException & e)
-		{
-			pError = e.what();
-		}
-		SJK.ReleaseConnection(pConnection);
-		m_pDriver->threadEnd();
-		SqlThreadRecursiveLock.unlock();
-
-		if(pError != nullptr)
-			dbg_msg("SQL", "%s", pError);
-	});
-	Thread.detach();
+	AddJob(Table, std::move(Query), Milliseconds);
 }
 
 // #####################################################
@@ -243,6 +629,17 @@ void CConectionPool::UDS(int Milliseconds, const char *Table, const char *Buffer
 	va_end(Arguments);
 }
 
+void CConectionPool::UD(const char *Table, const char *Buffer, const CSqlParams &Params)
+{
+	UDS(0, Table, Buffer, Params);
+}
+
+void CConectionPool::UDS(int Milliseconds, const char *Table, const char *Buffer, const CSqlParams &Params)
+{
+	std::string Query("UPDATE " + std::string(Table) + " SET " + std::string(Buffer) + ";");
+	AddJob(Table, std::move(Query), Milliseconds, nullptr, nullptr, &Params);
+}
+
 void CConectionPool::UpdateFormated(int Milliseconds, const char *Table, const char *Buffer, va_list args)
 {
 	char aBuf[1024];
@@ -253,34 +650,7 @@ void CConectionPool::UpdateFormated(int Milliseconds, const char *Table, const c
 	#endif
 	aBuf[sizeof(aBuf) - 1] = '\0';
 	std::string Query("UPDATE " + std::string(Table) + " SET " + std::string(aBuf) + ";");
-	std::thread Thread([this, Query, Milliseconds]()
-	{
-		if(Milliseconds > 0)
-			std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
-
-		const char* pError = nullptr;
-
-		SqlThreadRecursiveLock.lock();
-		m_pDriver->threadInit();
-		Connection* pConnection = SJK.GetConnection();
-		try
-		{
-			std::unique_ptr<Statement> pStmt(pConnection->createStatement());
-			pStmt->executeUpdate(Query.c_str());
-			pStmt->close();
-		}
-		catch(SQLException& e)
-		{
-			pError = e.what();
-		}
-		SJK.ReleaseConnection(pConnection);
-		m_pDriver->threadEnd();
-		SqlThreadRecursiveLock.unlock();
-
-		if(pError != nullptr)
-			dbg_msg("SQL", "%s", pError);
-	});
-	Thread.detach();
+	AddJob(Table, std::move(Query), Milliseconds);
 }
 
 // #####################################################
@@ -302,6 +672,17 @@ void CConectionPool::DDS(int Milliseconds, const char *Table, const char *Buffer
 	va_end(Arguments);
 }
 
+void CConectionPool::DD(const char *Table, const char *Buffer, const CSqlParams &Params)
+{
+	DDS(0, Table, Buffer, Params);
+}
+
+void CConectionPool::DDS(int Milliseconds, const char *Table, const char *Buffer, const CSqlParams &Params)
+{
+	std::string Query("DELETE FROM " + std::string(Table) + " " + std::string(Buffer) + ";");
+	AddJob(Table, std::move(Query), Milliseconds, nullptr, nullptr, &Params);
+}
+
 void CConectionPool::DeleteFormated(int Milliseconds, const char *Table, const char *Buffer, va_list args)
 {
 	char aBuf[256];
@@ -312,34 +693,7 @@ void CConectionPool::DeleteFormated(int Milliseconds, const char *Table, const c
 	#endif
 	aBuf[sizeof(aBuf) - 1] = '\0';
 	std::string Query("DELETE FROM " + std::string(Table) + " " + std::string(aBuf) + ";");
-	std::thread Thread([this, Query, Milliseconds]()
-	{
-		if(Milliseconds > 0)
-			std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
-
-		const char* pError = nullptr;
-
-		SqlThreadRecursiveLock.lock();
-		m_pDriver->threadInit();
-		Connection* pConnection = SJK.GetConnection();
-		try
-		{
-			std::unique_ptr<Statement> pStmt(pConnection->createStatement());
-			pStmt->executeUpdate(Query.c_str());
-			pStmt->close();
-		}
-		catch (SQLException& e)
-		{
-			pError = e.what();
-		}
-		SJK.ReleaseConnection(pConnection);
-		m_pDriver->threadEnd();
-		SqlThreadRecursiveLock.unlock();
-
-		if(pError != nullptr)
-			dbg_msg("SQL", "%s", pError);
-	});
-	Thread.detach();
+	AddJob(Table, std::move(Query), Milliseconds);
 }
 
 // #####################################################
@@ -358,11 +712,10 @@ ResultPtr CConectionPool::SD(const char* Select, const char* Table, const char*
 	va_end(VarArgs);
 	aBuf[sizeof(aBuf) - 1] = '\0';
 
-	const char* pError = nullptr;
-
-	SqlThreadRecursiveLock.lock();
 	std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(aBuf) + ";");
-	m_pDriver->threadInit();
+	CProfilerScope ProfilerScope(ProfilerSection(Table, true));
+	if(!s_SqlWorkerThread)
+		m_pDriver->threadInit();
 	Connection* pConnection = SJK.GetConnection();
 	ResultPtr pResult = nullptr;
 	try
@@ -373,14 +726,36 @@ ResultPtr CConectionPool::SD(const char* Select, const char* Table, const char*
 	}
 	catch(SQLException& e)
 	{
-		pError = e.what();
+		dbg_msg("SQL", "%s", e.what());
 	}
 	SJK.ReleaseConnection(pConnection);
-	m_pDriver->threadEnd();
-	SqlThreadRecursiveLock.unlock();
+	if(!s_SqlWorkerThread)
+		m_pDriver->threadEnd();
+
+	return pResult;
+}
 
-	if(pError != nullptr)
-		dbg_msg("SQL", "%s", pError);
+ResultPtr CConectionPool::SD(const char* Select, const char* Table, const char* Buffer, const CSqlParams &Params)
+{
+	std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(Buffer) + ";");
+	CProfilerScope ProfilerScope(ProfilerSection(Table, true));
+	if(!s_SqlWorkerThread)
+		m_pDriver->threadInit();
+	Connection* pConnection = SJK.GetConnection();
+	ResultPtr pResult = nullptr;
+	try
+	{
+		std::unique_ptr<PreparedStatement> pStmt(pConnection->prepareStatement(Query.c_str()));
+		Params.Bind(pStmt.get());
+		pResult.reset(pStmt->executeQuery());
+	}
+	catch(SQLException& e)
+	{
+		dbg_msg("SQL", "%s", e.what());
+	}
+	SJK.ReleaseConnection(pConnection);
+	if(!s_SqlWorkerThread)
+		m_pDriver->threadEnd();
 
 	return pResult;
 }
@@ -397,30 +772,68 @@ void CConectionPool::SDT(const char* Select, const char* Table, std::function<vo
 #endif
 	va_end(VarArgs);
 	aBuf[sizeof(aBuf) - 1] = '\0';
-	const std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(aBuf) + ";");
-	std::thread Thread([this, Query, func]()
+	std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(aBuf) + ";");
+	AddJob(Table, std::move(Query), 0, std::move(func));
+}
+
+void CConectionPool::SDT(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer, const CSqlParams &Params)
+{
+	std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(Buffer) + ";");
+	AddJob(Table, std::move(Query), 0, std::move(func), nullptr, &Params);
+}
+
+SqlQueryHandle CConectionPool::SDA(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer, ...)
+{
+	char aBuf[1024];
+	va_list VarArgs;
+	va_start(VarArgs, Buffer);
+#if defined(CONF_FAMILY_WINDOWS)
+	_vsnprintf(aBuf, sizeof(aBuf), Buffer, VarArgs);
+#else
+	vsnprintf(aBuf, sizeof(aBuf), Buffer, VarArgs);
+#endif
+	va_end(VarArgs);
+	aBuf[sizeof(aBuf) - 1] = '\0';
+	std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(aBuf) + ";");
+
+	SqlQueryHandle pHandle = std::make_shared<CSqlQueryState>();
+	AddJob(Table, std::move(Query), 0, std::move(func), pHandle);
+	return pHandle;
+}
+
+SqlQueryHandle CConectionPool::SDA(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer, const CSqlParams &Params)
+{
+	std::string Query("SELECT " + std::string(Select) + " FROM " + std::string(Table) + " " + std::string(Buffer) + ";");
+
+	SqlQueryHandle pHandle = std::make_shared<CSqlQueryState>();
+	AddJob(Table, std::move(Query), 0, std::move(func), pHandle, &Params);
+	return pHandle;
+}
+
+void CConectionPool::ProcessCompletedQueries()
+{
+	std::vector<CSqlCompletedJob> aCompletedJobs;
 	{
-		const char* pError = nullptr;
+		std::lock_guard<std::mutex> Lock(m_CompletedLock);
+		if(m_aCompletedJobs.empty())
+			return;
+		aCompletedJobs.swap(m_aCompletedJobs);
+	}
 
-		SqlThreadRecursiveLock.lock();
-		m_pDriver->threadInit();
-		Connection* pConnection = SJK.GetConnection();
-		try
-		{
-			std::unique_ptr<Statement> pStmt(pConnection->createStatement());
-			ResultPtr pResult(pStmt->executeQuery(Query.c_str()));
-			func(std::move(pResult));
-		}
-		catch(SQLException& e)
-		{
-			pError = e.what();
-		}
-		SJK.ReleaseConnection(pConnection);
-		m_pDriver->threadEnd();
-		SqlThreadRecursiveLock.unlock();
+	for(auto& Completed : aCompletedJobs)
+	{
+		if(Completed.m_pHandle->IsCanceled() || Completed.m_Generation != m_Generation)
+			continue;
 
-		if(pError != nullptr)
-			dbg_msg("SQL", "%s", pError);
-	});
-	Thread.detach();
+		Completed.m_pHandle->m_Done = true;
+		Completed.m_Func(std::move(Completed.m_pResult));
+	}
+}
+
+// the callbacks can refer to the worlds, they are discarded when the worlds are reloaded
+void CConectionPool::DiscardCompletedQueries()
+{
+	std::lock_guard<std::mutex> Lock(m_CompletedLock);
+	m_Generation++;
+	m_aCompletedJobs.clear();
 }
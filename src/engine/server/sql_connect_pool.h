@@ -4,12 +4,99 @@
 #include <mysql_connection.h>
 #include <cppconn/driver.h>
 #include <cppconn/statement.h>
+#include <cppconn/prepared_statement.h>
 #include <cppconn/resultset.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
 using namespace sql;
 #define SJK CConectionPool::GetInstance()
 typedef std::unique_ptr<ResultSet> ResultPtr;
 
+// state of the asynchronous query, after Cancel the callback will not be called
+class CSqlQueryState
+{
+	friend class CConectionPool;
+	std::atomic<bool> m_Canceled;
+	std::atomic<bool> m_Done;
+
+public:
+	CSqlQueryState() : m_Canceled(false), m_Done(false) {}
+
+	void Cancel() { m_Canceled = true; }
+	bool IsCanceled() const { return m_Canceled; }
+	bool IsDone() const { return m_Done; }
+};
+typedef std::shared_ptr<CSqlQueryState> SqlQueryHandle;
+
+// typed parameters of the prepared query, they are bound in order to the '?' placeholders
+class CSqlParams
+{
+	enum
+	{
+		PARAM_INT = 0,
+		PARAM_INT64,
+		PARAM_DOUBLE,
+		PARAM_STRING,
+		PARAM_NULL,
+	};
+
+	struct CParam
+	{
+		int m_Type;
+		int64 m_Integer;
+		double m_Double;
+		std::string m_String;
+	};
+	std::vector<CParam> m_aParams;
+	int m_OrderKey;
+	bool m_Ordered;
+
+	CSqlParams& Add(int Type, int64 Integer, double Double, std::string String)
+	{
+		m_aParams.push_back({ Type, Integer, Double, std::move(String) });
+		return *this;
+	}
+
+public:
+	CSqlParams() : m_OrderKey(0), m_Ordered(false) {}
+
+	// the write is ordered only with the writes of the same key to the table (usually the account id),
+	// the writes without a key are ordered with all of them, so they can run on several connections
+	CSqlParams& OrderKey(int Key) { m_OrderKey = Key; m_Ordered = true; return *this; }
+
+	CSqlParams& Int(int Value) { return Add(PARAM_INT, Value, 0.0, std::string()); }
+	CSqlParams& Int64(int64 Value) { return Add(PARAM_INT64, Value, 0.0, std::string()); }
+	CSqlParams& Double(double Value) { return Add(PARAM_DOUBLE, 0, Value, std::string()); }
+	CSqlParams& String(const char *pValue) { return Add(PARAM_STRING, 0, 0.0, pValue); }
+	CSqlParams& Null() { return Add(PARAM_NULL, 0, 0.0, std::string()); }
+
+	int Num() const { return (int)m_aParams.size(); }
+	bool IsOrdered() const { return m_Ordered; }
+	int GetOrderKey() const { return m_OrderKey; }
+	void Bind(PreparedStatement *pStmt) const;
+};
+
+// prepared statements of one connection by query text, they are parsed by the server only once
+class CSqlStatementCache
+{
+	enum
+	{
+		MAX_STATEMENTS = 256,
+	};
+	std::unordered_map<std::string, std::unique_ptr<PreparedStatement>> m_aStatements;
+
+public:
+	~CSqlStatementCache() { Clear(); }
+
+	PreparedStatement *Get(Connection *pConnection, const std::string &Query, bool *pPrepared);
+	void Remove(const std::string &Query);
+	void Clear();
+};
+
 class CConectionPool
 {
 	CConectionPool();
@@ -19,6 +106,87 @@ class CConectionPool
 	std::list<class Connection*>m_ConnList;
 	class Driver *m_pDriver;
 
+	// asynchronous query executed by the pool workers
+	struct CSqlJob
+	{
+		std::string m_Table;
+		bool m_Ordered;
+		int m_OrderKey;
+		std::string m_Query;
+		bool m_Prepared;
+		CSqlParams m_Params;
+		std::function<void(ResultPtr)> m_Func;
+		std::chrono::steady_clock::time_point m_QueuedTime;
+		std::chrono::steady_clock::time_point m_ExecuteTime;
+		SqlQueryHandle m_pHandle;
+		int m_Generation;
+	};
+
+	// results of the asynchronous queries waiting for the main thread
+	struct CSqlCompletedJob
+	{
+		std::function<void(ResultPtr)> m_Func;
+		ResultPtr m_pResult;
+		SqlQueryHandle m_pHandle;
+		int m_Generation;
+	};
+	std::mutex m_CompletedLock;
+	std::vector<CSqlCompletedJob> m_aCompletedJobs;
+	std::atomic<int> m_Generation;
+
+	// keys of the queries of the tables, a query without a key conflicts with all queries to its table
+	class CSqlKeySet
+	{
+		struct CTable
+		{
+			int m_Total = 0;
+			int m_Unordered = 0;
+			std::unordered_map<int, int> m_Keys;
+		};
+		std::unordered_map<std::string, CTable> m_Tables;
+
+	public:
+		bool Conflicts(const CSqlJob &Job) const;
+		void Add(const CSqlJob &Job);
+		void Remove(const CSqlJob &Job);
+		bool Empty() const { return m_Tables.empty(); }
+	};
+
+	// the workers share one queue, each owns one connection. a query is taken when no earlier
+	// or running query has its key, so the writes of one key keep the order in which they were requested.
+	// the delayed queries wait in a heap and are added to the queue when they are due
+	std::vector<std::thread> m_aWorkers;
+	std::mutex m_JobsLock;
+	std::condition_variable m_CondJob;
+	std::condition_variable m_CondSpace;
+	std::deque<CSqlJob> m_aJobs;
+	std::vector<CSqlJob> m_aDelayedJobs;
+	CSqlKeySet m_RunningKeys;
+	bool m_Shutdown;
+
+	std::atomic<int> m_QueueDepth;
+	std::atomic<int> m_PeakQueueDepth;
+	std::atomic<int64> m_ExecutedJobs;
+	std::atomic<int64> m_FailedJobs;
+	std::atomic<int64> m_StalledJobs;
+	std::atomic<int64> m_TotalLatency;
+	std::atomic<int64> m_MaxLatency;
+	std::atomic<int64> m_PreparedHits;
+	std::atomic<int64> m_PreparedMisses;
+
+	// profiler section of the queries to the table, the synchronous ones block the calling thread
+	static class CProfilerSection *ProfilerSection(const char *pTable, bool Synchronous);
+
+	Connection* Connect();
+	void StartWorkers();
+	void StopWorkers();
+	void WorkerThread();
+	void ReleaseDelayedJobs();
+	bool TakeJob(CSqlJob *pJob);
+	void ExecuteJob(Connection *pConnection, CSqlStatementCache *pStatements, CSqlJob &Job);
+	void AddJob(const char *pTable, std::string Query, int Milliseconds, std::function<void(ResultPtr)> Func = nullptr, SqlQueryHandle pHandle = nullptr,
+		const CSqlParams *pParams = nullptr);
+
 	void InsertFormated(int Milliseconds, const char *Table, const char *Buffer, va_list args);
 	void UpdateFormated(int Milliseconds, const char *Table, const char *Buffer, va_list args);
 	void DeleteFormated(int Milliseconds, const char *Table, const char *Buffer, va_list args);
@@ -33,21 +201,51 @@ public:
 	void DisconnectConnectionHeap();
 	static CConectionPool& GetInstance();
 
+	// counters of the asynchronous workers (latency in milliseconds)
+	struct CStats
+	{
+		int m_Workers;
+		int m_QueueDepth;
+		int m_PeakQueueDepth;
+		int64 m_Executed;
+		int64 m_Failed;
+		int64 m_Stalled;
+		int m_AverageLatency;
+		int m_MaxLatency;
+		int64 m_PreparedHits;
+		int64 m_PreparedMisses;
+	};
+	void GetStats(CStats *pStats) const;
+
 	// simply inserts data
 	void ID(const char *Table, const char *Buffer, ...);
 	void IDS(int Milliseconds, const char *Table, const char *Buffer, ...);
+	void ID(const char *Table, const char *Buffer, const CSqlParams &Params);
+	void IDS(int Milliseconds, const char *Table, const char *Buffer, const CSqlParams &Params);
 
 	// simply update the data that will be specified
 	void UD(const char *Table, const char *Buffer, ...);
 	void UDS(int Milliseconds, const char *Table, const char *Buffer, ...);
+	void UD(const char *Table, const char *Buffer, const CSqlParams &Params);
+	void UDS(int Milliseconds, const char *Table, const char *Buffer, const CSqlParams &Params);
 
 	// simply deletes the data that will be specified
 	void DD(const char *Table, const char *Buffer, ...);
 	void DDS(int Milliseconds, const char *Table, const char *Buffer, ...);
+	void DD(const char *Table, const char *Buffer, const CSqlParams &Params);
+	void DDS(int Milliseconds, const char *Table, const char *Buffer, const CSqlParams &Params);
 
 	// database extraction function
 	ResultPtr SD(const char *Select, const char *Table, const char *Buffer = "", ...);
+	ResultPtr SD(const char *Select, const char *Table, const char *Buffer, const CSqlParams &Params);
 	void SDT(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer = "", ...);
+	void SDT(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer, const CSqlParams &Params);
+
+	// asynchronous extraction function, the callback is called in the main thread from ProcessCompletedQueries
+	SqlQueryHandle SDA(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer = "", ...);
+	SqlQueryHandle SDA(const char* Select, const char* Table, std::function<void(ResultPtr)> func, const char* Buffer, const CSqlParams &Params);
+	void ProcessCompletedQueries();
+	void DiscardCompletedQueries();
 };
 
 #endif
@@ -454,6 +454,10 @@ bool CNetBan::IsBannable(const T* pData)
 
 bool CNetBan::IsBanned(const NETADDR *pAddr, char *pBuf, unsigned BufferSize, int *pLastInfoQuery)
 {
+	// this runs for every received packet and usually nothing is banned
+	if(!m_BanAddrPool.Num() && !m_BanRangePool.Num())
+		return false;
+
 	CNetHash aHash[17];
 	int Length = CNetHash::MakeHashArray(pAddr, aHash);
 
@@ -466,7 +470,7 @@ bool CNetBan::IsBanned(const NETADDR *pAddr, char *pBuf, unsigned BufferSize, in
 	}
 
 	// check ban ranges
-	for(int i = Length-1; i >= 0; --i)
+	for(int i = m_BanRangePool.Num() ? Length-1 : -1; i >= 0; --i)
 	{
 		for(CBanRange *pBan = m_BanRangePool.First(&aHash[i]); pBan; pBan = pBan->m_pHashNext)
 		{
@@ -91,8 +91,72 @@ int CNetRecvUnpacker::FetchChunk(CNetChunk* pChunk)
 	}
 }
 
+void CNetSendBatch::Init(NETSOCKET Socket)
+{
+	m_Socket = Socket;
+	m_NumPackets = 0;
+}
+
+void CNetSendBatch::Send(const NETADDR* pAddr, const void* pData, int DataSize)
+{
+	// without batching the packets take the old path, the queued ones go first to keep the order
+	if(!g_Config.m_SvNetBatch)
+	{
+		Flush();
+		net_udp_send(m_Socket, pAddr, pData, DataSize);
+		return;
+	}
+
+	if(m_NumPackets == NET_MAX_BATCH_PACKETS)
+		Flush();
+
+	m_aAddrs[m_NumPackets] = *pAddr;
+	m_aSizes[m_NumPackets] = DataSize;
+	mem_copy(m_aData[m_NumPackets], pData, DataSize);
+	m_NumPackets++;
+}
+
+void CNetSendBatch::Flush()
+{
+	if(!m_NumPackets)
+		return;
+
+	net_udp_send_batch(m_Socket, m_aAddrs, m_aData[0], m_aSizes, NET_MAX_PACKETSIZE, m_NumPackets);
+	m_NumPackets = 0;
+}
+
+void CNetRecvBatch::Init(NETSOCKET Socket)
+{
+	m_Socket = Socket;
+	m_NumPackets = 0;
+	m_NextPacket = 0;
+}
+
+int CNetRecvBatch::Recv(NETADDR* pAddr, unsigned char** ppData)
+{
+	if(m_NextPacket >= m_NumPackets)
+	{
+		m_NextPacket = 0;
+		if(g_Config.m_SvNetBatch)
+			m_NumPackets = net_udp_recv_batch(m_Socket, m_aAddrs, m_aData[0], m_aSizes, NET_MAX_PACKETSIZE, NET_MAX_BATCH_PACKETS);
+		else
+		{
+			m_aSizes[0] = net_udp_recv(m_Socket, &m_aAddrs[0], m_aData[0], NET_MAX_PACKETSIZE);
+			m_NumPackets = m_aSizes[0] > 0 ? 1 : 0;
+		}
+
+		// no more packets for now
+		if(!m_NumPackets)
+			return 0;
+	}
+
+	*pAddr = m_aAddrs[m_NextPacket];
+	*ppData = m_aData[m_NextPacket];
+	return m_aSizes[m_NextPacket++];
+}
+
 // packs the data tight and sends it
-void CNetBase::SendPacketConnless(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, TOKEN ResponseToken, const void* pData, int DataSize)
+void CNetBase::SendPacketConnless(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, TOKEN ResponseToken, const void* pData, int DataSize, CNetSendBatch* pBatch)
 {
 	unsigned char aBuffer[NET_MAX_PACKETSIZE];
 
@@ -114,10 +178,13 @@ void CNetBase::SendPacketConnless(NETSOCKET Socket, const NETADDR* pAddr, TOKEN
 	dbg_assert(i == NET_PACKETHEADERSIZE_CONNLESS, "inconsistency");
 
 	mem_copy(&aBuffer[i], pData, DataSize);
-	net_udp_send(Socket, pAddr, aBuffer, i + DataSize);
+	if(pBatch)
+		pBatch->Send(pAddr, aBuffer, i + DataSize);
+	else
+		net_udp_send(Socket, pAddr, aBuffer, i + DataSize);
 }
 
-void CNetBase::SendPacket(NETSOCKET Socket, const NETADDR* pAddr, CNetPacketConstruct* pPacket)
+void CNetBase::SendPacket(NETSOCKET Socket, const NETADDR* pAddr, CNetPacketConstruct* pPacket, CNetSendBatch* pBatch)
 {
 	unsigned char aBuffer[NET_MAX_PACKETSIZE];
 	int CompressedSize = -1;
@@ -169,7 +236,10 @@ void CNetBase::SendPacket(NETSOCKET Socket, const NETADDR* pAddr, CNetPacketCons
 
 		dbg_assert(i == NET_PACKETHEADERSIZE, "inconsistency");
 
-		net_udp_send(Socket, pAddr, aBuffer, FinalSize);
+		if(pBatch)
+			pBatch->Send(pAddr, aBuffer, FinalSize);
+		else
+			net_udp_send(Socket, pAddr, aBuffer, FinalSize);
 
 		// log raw socket data
 		if (ms_DataLogSent)
@@ -295,7 +365,7 @@ int CNetBase::UnpackPacket(unsigned char* pBuffer, int Size, CNetPacketConstruct
 }
 
 
-void CNetBase::SendControlMsg(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, const void* pExtra, int ExtraSize)
+void CNetBase::SendControlMsg(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, const void* pExtra, int ExtraSize, CNetSendBatch* pBatch)
 {
 	CNetPacketConstruct Construct;
 	Construct.m_Token = Token;
@@ -308,11 +378,11 @@ void CNetBase::SendControlMsg(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Toke
 		mem_copy(&Construct.m_aChunkData[1], pExtra, ExtraSize);
 
 	// send the control message
-	CNetBase::SendPacket(Socket, pAddr, &Construct);
+	CNetBase::SendPacket(Socket, pAddr, &Construct, pBatch);
 }
 
 
-void CNetBase::SendControlMsgWithToken(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, TOKEN MyToken, bool Extended)
+void CNetBase::SendControlMsgWithToken(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, TOKEN MyToken, bool Extended, CNetSendBatch* pBatch)
 {
 	dbg_assert((Token & ~NET_TOKEN_MASK) == 0, "token out of range");
 	dbg_assert((MyToken & ~NET_TOKEN_MASK) == 0, "resp token out of range");
@@ -322,7 +392,7 @@ void CNetBase::SendControlMsgWithToken(NETSOCKET Socket, const NETADDR* pAddr, T
 	aBuf[1] = (MyToken >> 16) & 0xff;
 	aBuf[2] = (MyToken >> 8) & 0xff;
 	aBuf[3] = (MyToken) & 0xff;
-	SendControlMsg(Socket, pAddr, Token, 0, ControlMsg, aBuf, Extended ? sizeof(aBuf) : 4);
+	SendControlMsg(Socket, pAddr, Token, 0, ControlMsg, aBuf, Extended ? sizeof(aBuf) : 4, pBatch);
 }
 
 unsigned char* CNetChunkHeader::Pack(unsigned char* pData)
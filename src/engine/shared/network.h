@@ -102,7 +102,7 @@ enum
 	NET_TOKENREQUEST_DATASIZE = 512,
 
 	//
-	NET_MAX_CLIENTS = 64,
+	NET_MAX_CLIENTS = 256,
 	NET_MAX_CONSOLE_CLIENTS = 4,
 
 	NET_MAX_SEQUENCE = 1 << 10,
@@ -126,6 +126,8 @@ enum
 
 	NET_CONN_BUFFERSIZE = 1024 * 32,
 
+	NET_MAX_BATCH_PACKETS = 64,
+
 	NET_ENUM_TERMINATOR
 };
 
@@ -268,6 +270,36 @@ private:
 };
 
 
+// packets of the connections that are sent with one call, the owner flushes them at the end of the tick
+class CNetSendBatch
+{
+	NETSOCKET m_Socket;
+	int m_NumPackets;
+	NETADDR m_aAddrs[NET_MAX_BATCH_PACKETS];
+	int m_aSizes[NET_MAX_BATCH_PACKETS];
+	unsigned char m_aData[NET_MAX_BATCH_PACKETS][NET_MAX_PACKETSIZE];
+
+public:
+	void Init(NETSOCKET Socket);
+	void Send(const NETADDR* pAddr, const void* pData, int DataSize);
+	void Flush();
+};
+
+// packets that are received with one call and handed out one by one
+class CNetRecvBatch
+{
+	NETSOCKET m_Socket;
+	int m_NumPackets;
+	int m_NextPacket;
+	NETADDR m_aAddrs[NET_MAX_BATCH_PACKETS];
+	int m_aSizes[NET_MAX_BATCH_PACKETS];
+	unsigned char m_aData[NET_MAX_BATCH_PACKETS][NET_MAX_PACKETSIZE];
+
+public:
+	void Init(NETSOCKET Socket);
+	int Recv(NETADDR* pAddr, unsigned char** ppData);
+};
+
 class CNetConnection
 {
 	// TODO: is this needed because this needs to be aware of
@@ -298,6 +330,7 @@ private:
 	NETADDR m_PeerAddr;
 
 	NETSOCKET m_Socket;
+	CNetSendBatch* m_pSendBatch;
 	NETSTATS m_Stats;
 
 	//
@@ -315,7 +348,7 @@ private:
 	static TOKEN GenerateToken(const NETADDR* pPeerAddr);
 
 public:
-	void Init(NETSOCKET Socket, bool BlockCloseMsg);
+	void Init(NETSOCKET Socket, bool BlockCloseMsg, CNetSendBatch* pSendBatch = 0);
 	int Connect(NETADDR* pAddr);
 	void Disconnect(const char* pReason);
 
@@ -399,15 +432,28 @@ public:
 // server side
 class CNetServer
 {
+	// the address index is tested directly
+	friend class CNetServerIndex;
+
+	enum
+	{
+		ADDR_HASH_SIZE = NET_MAX_CLIENTS * 2, // power of two
+	};
+
 	struct CSlot
 	{
 	public:
 		CNetConnection m_Connection;
+
+		// bucket of the peer address, -1 when the slot is not hashed
+		int m_AddrHash;
+		int m_NextInHash;
 	};
 
 	NETSOCKET m_Socket;
 	class CNetBan* m_pNetBan;
 	CSlot m_aSlots[NET_MAX_CLIENTS];
+	int m_aAddrHashFirst[ADDR_HASH_SIZE];
 	int m_NumClients;
 	int m_MaxClients;
 	int m_MaxClientsPerIP;
@@ -417,10 +463,18 @@ class CNetServer
 	void* m_UserPtr;
 
 	CNetRecvUnpacker m_RecvUnpacker;
+	CNetRecvBatch m_RecvBatch;
+	CNetSendBatch m_SendBatch;
 
 	CNetTokenManager m_TokenManager;
 	CNetTokenCache m_TokenCache;
 
+	// the slots are found by their peer address in constant time instead of a scan over all slots
+	static int AddrHash(const NETADDR* pAddr);
+	void HashSlot(int ClientID);
+	void UnhashSlot(int ClientID);
+	int FindSlot(const NETADDR* pAddr) const;
+
 public:
 	//
 	bool Open(NETADDR BindAddr, class CNetBan* pNetBan, int MaxClients, int MaxClientsPerIP, NETFUNC_NEWCLIENT pfnNewClient, NETFUNC_DELCLIENT pfnDelClient, void* pUser);
@@ -432,6 +486,9 @@ public:
 	int Update();
 	void AddToken(const NETADDR* pAddr, TOKEN Token) { m_TokenCache.AddToken(pAddr, Token, 0); };
 
+	// sends the packets the connections queued since the last flush
+	void Flush() { m_SendBatch.Flush(); }
+
 	//
 	void Drop(int ClientID, const char* pReason);
 
@@ -536,10 +593,11 @@ public:
 	static void CloseLog();
 	static void Init();
 
-	static void SendControlMsg(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, const void* pExtra, int ExtraSize);
-	static void SendControlMsgWithToken(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, TOKEN MyToken, bool Extended);
-	static void SendPacketConnless(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, TOKEN ResponseToken, const void* pData, int DataSize);
-	static void SendPacket(NETSOCKET Socket, const NETADDR* pAddr, CNetPacketConstruct* pPacket);
+	// with a batch the packets are queued in it instead of sent directly
+	static void SendControlMsg(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, const void* pExtra, int ExtraSize, CNetSendBatch* pBatch = 0);
+	static void SendControlMsgWithToken(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, int Ack, int ControlMsg, TOKEN MyToken, bool Extended, CNetSendBatch* pBatch = 0);
+	static void SendPacketConnless(NETSOCKET Socket, const NETADDR* pAddr, TOKEN Token, TOKEN ResponseToken, const void* pData, int DataSize, CNetSendBatch* pBatch = 0);
+	static void SendPacket(NETSOCKET Socket, const NETADDR* pAddr, CNetPacketConstruct* pPacket, CNetSendBatch* pBatch = 0);
 	static int UnpackPacket(unsigned char* pBuffer, int Size, CNetPacketConstruct* pPacket);
 
 	// The backroom is ack-NET_MAX_SEQUENCE/2. Used for knowing if we acked a packet or not
@@ -54,12 +54,13 @@ void CNetConnection::SetError(const char* pString)
 	str_copy(m_ErrorString, pString, sizeof(m_ErrorString));
 }
 
-void CNetConnection::Init(NETSOCKET Socket, bool BlockCloseMsg)
+void CNetConnection::Init(NETSOCKET Socket, bool BlockCloseMsg, CNetSendBatch* pSendBatch)
 {
 	Reset();
 	ResetStats();
 
 	m_Socket = Socket;
+	m_pSendBatch = pSendBatch;
 	m_BlockCloseMsg = BlockCloseMsg;
 	mem_zero(m_ErrorString, sizeof(m_ErrorString));
 }
@@ -93,7 +94,7 @@ int CNetConnection::Flush()
 	// send of the packets
 	m_Construct.m_Ack = m_Ack;
 	m_Construct.m_Token = m_PeerToken;
-	CNetBase::SendPacket(m_Socket, &m_PeerAddr, &m_Construct);
+	CNetBase::SendPacket(m_Socket, &m_PeerAddr, &m_Construct, m_pSendBatch);
 
 	// update send times
 	m_LastSendTime = time_get();
@@ -163,18 +164,18 @@ void CNetConnection::SendControl(int ControlMsg, const void* pExtra, int ExtraSi
 {
 	// send the control message
 	m_LastSendTime = time_get();
-	CNetBase::SendControlMsg(m_Socket, &m_PeerAddr, m_PeerToken, m_Ack, ControlMsg, pExtra, ExtraSize);
+	CNetBase::SendControlMsg(m_Socket, &m_PeerAddr, m_PeerToken, m_Ack, ControlMsg, pExtra, ExtraSize, m_pSendBatch);
 }
 
 void CNetConnection::SendPacketConnless(const char* pData, int DataSize)
 {
-	CNetBase::SendPacketConnless(m_Socket, &m_PeerAddr, m_PeerToken, m_Token, pData, DataSize);
+	CNetBase::SendPacketConnless(m_Socket, &m_PeerAddr, m_PeerToken, m_Token, pData, DataSize, m_pSendBatch);
 }
 
 void CNetConnection::SendControlWithToken(int ControlMsg)
 {
 	m_LastSendTime = time_get();
-	CNetBase::SendControlMsgWithToken(m_Socket, &m_PeerAddr, m_PeerToken, 0, ControlMsg, m_Token, true);
+	CNetBase::SendControlMsgWithToken(m_Socket, &m_PeerAddr, m_PeerToken, 0, ControlMsg, m_Token, true, m_pSendBatch);
 }
 
 void CNetConnection::ResendChunk(CNetChunkResend* pResend)
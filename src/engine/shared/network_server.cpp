@@ -16,6 +16,8 @@ bool CNetServer::Open(NETADDR BindAddr, CNetBan* pNetBan, int MaxClients, int Ma
 	if (!m_Socket.type)
 		return false;
 
+	m_RecvBatch.Init(m_Socket);
+	m_SendBatch.Init(m_Socket);
 	m_TokenManager.Init(m_Socket);
 	m_TokenCache.Init(m_Socket, &m_TokenManager);
 
@@ -26,7 +28,13 @@ bool CNetServer::Open(NETADDR BindAddr, CNetBan* pNetBan, int MaxClients, int Ma
 	SetMaxClientsPerIP(MaxClientsPerIP);
 
 	for (int i = 0; i < NET_MAX_CLIENTS; i++)
-		m_aSlots[i].m_Connection.Init(m_Socket, true);
+	{
+		m_aSlots[i].m_Connection.Init(m_Socket, true, &m_SendBatch);
+		m_aSlots[i].m_AddrHash = -1;
+		m_aSlots[i].m_NextInHash = -1;
+	}
+	for (int i = 0; i < ADDR_HASH_SIZE; i++)
+		m_aAddrHashFirst[i] = -1;
 
 	m_pfnNewClient = pfnNewClient;
 	m_pfnDelClient = pfnDelClient;
@@ -40,6 +48,7 @@ void CNetServer::Close()
 	for (int i = 0; i < NET_MAX_CLIENTS; i++)
 		Drop(i, "Server shutdown");
 
+	m_SendBatch.Flush();
 	net_udp_close(m_Socket);
 }
 
@@ -51,10 +60,61 @@ void CNetServer::Drop(int ClientID, const char* pReason)
 	if (m_pfnDelClient)
 		m_pfnDelClient(ClientID, pReason, m_UserPtr);
 
+	UnhashSlot(ClientID);
 	m_aSlots[ClientID].m_Connection.Disconnect(pReason);
 	m_NumClients--;
 }
 
+int CNetServer::AddrHash(const NETADDR* pAddr)
+{
+	// fnv-1a over the compared part of the address and the port
+	unsigned Hash = 2166136261u;
+	const int Size = pAddr->type == NETTYPE_IPV4 ? NETADDR_SIZE_IPV4 : NETADDR_SIZE_IPV6;
+	for (int i = 0; i < Size; i++)
+		Hash = (Hash ^ pAddr->ip[i]) * 16777619u;
+	Hash = (Hash ^ (pAddr->port & 0xff)) * 16777619u;
+	Hash = (Hash ^ (pAddr->port >> 8)) * 16777619u;
+	return Hash & (ADDR_HASH_SIZE - 1);
+}
+
+void CNetServer::HashSlot(int ClientID)
+{
+	UnhashSlot(ClientID);
+
+	const int Hash = AddrHash(m_aSlots[ClientID].m_Connection.PeerAddress());
+	m_aSlots[ClientID].m_AddrHash = Hash;
+	m_aSlots[ClientID].m_NextInHash = m_aAddrHashFirst[Hash];
+	m_aAddrHashFirst[Hash] = ClientID;
+}
+
+void CNetServer::UnhashSlot(int ClientID)
+{
+	const int Hash = m_aSlots[ClientID].m_AddrHash;
+	if (Hash == -1)
+		return;
+
+	for (int* pLink = &m_aAddrHashFirst[Hash]; *pLink != -1; pLink = &m_aSlots[*pLink].m_NextInHash)
+	{
+		if (*pLink == ClientID)
+		{
+			*pLink = m_aSlots[ClientID].m_NextInHash;
+			break;
+		}
+	}
+	m_aSlots[ClientID].m_AddrHash = -1;
+	m_aSlots[ClientID].m_NextInHash = -1;
+}
+
+int CNetServer::FindSlot(const NETADDR* pAddr) const
+{
+	for (int i = m_aAddrHashFirst[AddrHash(pAddr)]; i != -1; i = m_aSlots[i].m_NextInHash)
+	{
+		if (m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE && net_addr_comp(m_aSlots[i].m_Connection.PeerAddress(), pAddr, true) == 0)
+			return i;
+	}
+	return -1;
+}
+
 int CNetServer::Update()
 {
 	int64 Now = time_get();
@@ -90,19 +150,20 @@ int CNetServer::Recv(CNetChunk* pChunk, TOKEN* pResponseToken)
 	while (1)
 	{
 		NETADDR Addr;
+		unsigned char* pData;
 
 		// check for a chunk
 		if(m_RecvUnpacker.IsActive() && m_RecvUnpacker.FetchChunk(pChunk))
 			return 1;
 
-		// TODO: empty the recvinfo
-		int Bytes = net_udp_recv(m_Socket, &Addr, m_RecvUnpacker.m_aBuffer, NET_MAX_PACKETSIZE);
+		// the packets are read in batches, this only calls the socket when the batch is empty
+		int Bytes = m_RecvBatch.Recv(&Addr, &pData);
 
 		// no more packets for now
 		if (Bytes <= 0)
 			break;
 
-		if (CNetBase::UnpackPacket(m_RecvUnpacker.m_aBuffer, Bytes, &m_RecvUnpacker.m_Data) == 0)
+		if (CNetBase::UnpackPacket(pData, Bytes, &m_RecvUnpacker.m_Data) == 0)
 		{
 			// check for bans
 			char aBuf[128];
@@ -118,40 +179,31 @@ int CNetServer::Recv(CNetChunk* pChunk, TOKEN* pResponseToken)
 				continue;
 			}
 
-			bool Found = false;
 			// try to find matching slot
-			for (int i = 0; i < NET_MAX_CLIENTS; i++)
+			const int Slot = FindSlot(&Addr);
+			if (Slot != -1)
 			{
-				if (m_aSlots[i].m_Connection.State() == NET_CONNSTATE_OFFLINE)
-					continue;
-
-				if(net_addr_comp(m_aSlots[i].m_Connection.PeerAddress(), &Addr, true) == 0)
+				if (m_aSlots[Slot].m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr))
 				{
-					if (m_aSlots[i].m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr))
+					if (m_RecvUnpacker.m_Data.m_DataSize)
 					{
-						if (m_RecvUnpacker.m_Data.m_DataSize)
+						if (!(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONNLESS))
+							m_RecvUnpacker.Start(&Addr, &m_aSlots[Slot].m_Connection, Slot);
+						else
 						{
-							if (!(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONNLESS))
-								m_RecvUnpacker.Start(&Addr, &m_aSlots[i].m_Connection, i);
-							else
-							{
-								pChunk->m_Flags = NETSENDFLAG_CONNLESS;
-								pChunk->m_Address = *m_aSlots[i].m_Connection.PeerAddress();
-								pChunk->m_ClientID = i;
-								pChunk->m_DataSize = m_RecvUnpacker.m_Data.m_DataSize;
-								pChunk->m_pData = m_RecvUnpacker.m_Data.m_aChunkData;
-								if (pResponseToken)
-									*pResponseToken = NET_TOKEN_NONE;
-								return 1;
-							}
+							pChunk->m_Flags = NETSENDFLAG_CONNLESS;
+							pChunk->m_Address = *m_aSlots[Slot].m_Connection.PeerAddress();
+							pChunk->m_ClientID = Slot;
+							pChunk->m_DataSize = m_RecvUnpacker.m_Data.m_DataSize;
+							pChunk->m_pData = m_RecvUnpacker.m_Data.m_aChunkData;
+							if (pResponseToken)
+								*pResponseToken = NET_TOKEN_NONE;
+							return 1;
 						}
 					}
-					Found = true;
 				}
-			}
-
-			if (Found)
 				continue;
+			}
 
 			int Accept = m_TokenManager.ProcessMessage(&Addr, &m_RecvUnpacker.m_Data);
 			if (Accept <= 0)
@@ -200,6 +252,8 @@ int CNetServer::Recv(CNetChunk* pChunk, TOKEN* pResponseToken)
 							m_NumClients++;
 							m_aSlots[i].m_Connection.SetToken(m_RecvUnpacker.m_Data.m_Token);
 							m_aSlots[i].m_Connection.Feed(&m_RecvUnpacker.m_Data, &Addr);
+							if (m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE)
+								HashSlot(i);
 							if (m_pfnNewClient)
 								m_pfnNewClient(i, m_UserPtr);
 							break;
@@ -235,21 +289,9 @@ int CNetServer::Send(CNetChunk* pChunk, TOKEN Token)
 			return -1;
 		}
 
+		// upgrade the packet, now that we know its recipent
 		if (pChunk->m_ClientID == -1)
-		{
-			for (int i = 0; i < NET_MAX_CLIENTS; i++)
-			{
-				if (m_aSlots[i].m_Connection.State() == NET_CONNSTATE_OFFLINE)
-					continue;
-
-				if(net_addr_comp(&pChunk->m_Address, m_aSlots[i].m_Connection.PeerAddress(), true) == 0)
-				{
-					// upgrade the packet, now that we know its recipent
-					pChunk->m_ClientID = i;
-					break;
-				}
-			}
-		}
+			pChunk->m_ClientID = FindSlot(&pChunk->m_Address);
 
 		if (Token != NET_TOKEN_NONE)
 		{
@@ -0,0 +1,153 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+
+#include "profiler.h"
+#include "jsonwriter.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+std::atomic<bool> CProfiler::ms_Enabled(true);
+std::atomic<int64> CProfiler::ms_Overruns(0);
+
+static std::mutex s_SectionsLock;
+static std::map<std::string, std::unique_ptr<CProfilerSection>> s_aSections;
+
+CProfilerSection::CProfilerSection(const char *pName)
+{
+	str_copy(m_aName, pName, sizeof(m_aName));
+	m_NumSamples = 0;
+	m_NextSample = 0;
+	m_TotalSamples = 0;
+	m_MaxSample = 0;
+}
+
+void CProfilerSection::AddSample(int64 Time)
+{
+	static const int64 s_Freq = time_freq();
+	const int Sample = (int)(Time * 1000000 / s_Freq);
+
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	m_aSamples[m_NextSample] = Sample;
+	m_NextSample = (m_NextSample + 1) % MAX_SAMPLES;
+	m_NumSamples = min(m_NumSamples + 1, (int)MAX_SAMPLES);
+	m_TotalSamples++;
+	m_MaxSample = max(m_MaxSample, Sample);
+}
+
+void CProfilerSection::GetStats(CStats *pStats) const
+{
+	int aSamples[MAX_SAMPLES];
+	int NumSamples;
+	{
+		std::lock_guard<std::mutex> Lock(m_Lock);
+		NumSamples = m_NumSamples;
+		mem_copy(aSamples, m_aSamples, sizeof(int) * NumSamples);
+		pStats->m_Samples = m_TotalSamples;
+		pStats->m_Max = m_MaxSample;
+	}
+
+	pStats->m_P50 = 0;
+	pStats->m_P99 = 0;
+	if(NumSamples <= 0)
+		return;
+
+	int *pP50 = aSamples + NumSamples / 2;
+	std::nth_element(aSamples, pP50, aSamples + NumSamples);
+	pStats->m_P50 = *pP50;
+
+	int *pP99 = aSamples + (NumSamples * 99) / 100;
+	std::nth_element(aSamples, pP99, aSamples + NumSamples);
+	pStats->m_P99 = *pP99;
+}
+
+void CProfilerSection::Reset()
+{
+	std::lock_guard<std::mutex> Lock(m_Lock);
+	m_NumSamples = 0;
+	m_NextSample = 0;
+	m_TotalSamples = 0;
+	m_MaxSample = 0;
+}
+
+CProfilerSection *CProfiler::Section(const char *pName)
+{
+	std::lock_guard<std::mutex> Lock(s_SectionsLock);
+	std::unique_ptr<CProfilerSection> &pSection = s_aSections[pName];
+	if(!pSection)
+		pSection.reset(new CProfilerSection(pName));
+	return pSection.get();
+}
+
+CProfilerSection *CProfiler::WorldSection(int WorldID, const char *pName)
+{
+	char aName[64];
+	str_format(aName, sizeof(aName), "world%d/%s", WorldID, pName);
+	return Section(aName);
+}
+
+void CProfiler::Reset()
+{
+	std::lock_guard<std::mutex> Lock(s_SectionsLock);
+	for(auto &Section : s_aSections)
+		Section.second->Reset();
+	ms_Overruns = 0;
+}
+
+void CProfiler::ListSections(const char *pFilter, void (*pfnCallback)(const CProfilerSection *pSection, void *pUser), void *pUser)
+{
+	std::vector<const CProfilerSection *> apSections;
+	{
+		std::lock_guard<std::mutex> Lock(s_SectionsLock);
+		for(auto &Section : s_aSections)
+		{
+			if(!pFilter || !pFilter[0] || str_find_nocase(Section.first.c_str(), pFilter))
+				apSections.push_back(Section.second.get());
+		}
+	}
+
+	for(const CProfilerSection *pSection : apSections)
+		pfnCallback(pSection, pUser);
+}
+
+bool CProfiler::WriteJson(IOHANDLE File, int Tick)
+{
+	if(!File)
+		return false;
+
+	CJsonWriter Writer(File);
+	Writer.BeginObject();
+	Writer.WriteAttribute("tick");
+	Writer.WriteIntValue(Tick);
+	Writer.WriteAttribute("overruns");
+	Writer.WriteIntValue((int)GetOverruns());
+
+	Writer.WriteAttribute("sections");
+	Writer.BeginArray();
+	ListSections(nullptr, [](const CProfilerSection *pSection, void *pUser)
+	{
+		CJsonWriter *pWriter = (CJsonWriter *)pUser;
+		CProfilerSection::CStats Stats;
+		pSection->GetStats(&Stats);
+
+		pWriter->BeginObject();
+		pWriter->WriteAttribute("name");
+		pWriter->WriteStrValue(pSection->GetName());
+		pWriter->WriteAttribute("samples");
+		pWriter->WriteIntValue((int)Stats.m_Samples);
+		pWriter->WriteAttribute("p50");
+		pWriter->WriteIntValue(Stats.m_P50);
+		pWriter->WriteAttribute("p99");
+		pWriter->WriteIntValue(Stats.m_P99);
+		pWriter->WriteAttribute("max");
+		pWriter->WriteIntValue(Stats.m_Max);
+		pWriter->EndObject();
+	}, &Writer);
+	Writer.EndArray();
+	Writer.EndObject();
+	return true;
+}
@@ -0,0 +1,106 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef ENGINE_SHARED_PROFILER_H
+#define ENGINE_SHARED_PROFILER_H
+#include <base/system.h>
+
+#include <atomic>
+#include <mutex>
+
+/*
+	Class: Profiler Section
+		Timings of one measured place, the last samples are kept in a ring
+		so the percentiles are always of the recent ticks. Times are in microseconds.
+*/
+class CProfilerSection
+{
+	friend class CProfiler;
+
+	enum
+	{
+		MAX_SAMPLES = 512,
+	};
+
+	char m_aName[64];
+	mutable std::mutex m_Lock;
+	int m_aSamples[MAX_SAMPLES];
+	int m_NumSamples;
+	int m_NextSample;
+	int64 m_TotalSamples;
+	int m_MaxSample;
+
+public:
+	struct CStats
+	{
+		int64 m_Samples;
+		int m_P50;
+		int m_P99;
+		int m_Max;
+	};
+
+	explicit CProfilerSection(const char *pName);
+
+	void AddSample(int64 Time);
+	void GetStats(CStats *pStats) const;
+	void Reset();
+	const char *GetName() const { return m_aName; }
+};
+
+/*
+	Class: Profiler
+		Registry of the sections of the whole server, sections are created on the first
+		use and are never removed, so the pointers can be kept by the measured code.
+*/
+class CProfiler
+{
+	static std::atomic<bool> ms_Enabled;
+	static std::atomic<int64> ms_Overruns;
+
+public:
+	static CProfilerSection *Section(const char *pName);
+	static CProfilerSection *WorldSection(int WorldID, const char *pName);
+	static void Reset();
+
+	static void SetEnabled(bool Enabled) { ms_Enabled = Enabled; }
+	static bool IsEnabled() { return ms_Enabled; }
+
+	// ticks that took longer than the tick budget
+	static void AddOverrun() { ms_Overruns++; }
+	static int64 GetOverruns() { return ms_Overruns; }
+
+	// sections sorted by name, the callback is called with the name filter already applied
+	static void ListSections(const char *pFilter, void (*pfnCallback)(const CProfilerSection *pSection, void *pUser), void *pUser);
+	static bool WriteJson(IOHANDLE File, int Tick);
+};
+
+// measures the time until the end of the scope
+class CProfilerScope
+{
+	CProfilerSection *m_pSection;
+	int64 m_Start;
+
+public:
+	explicit CProfilerScope(CProfilerSection *pSection)
+	{
+		m_pSection = CProfiler::IsEnabled() ? pSection : nullptr;
+		m_Start = m_pSection ? time_get() : 0;
+	}
+
+	~CProfilerScope()
+	{
+		if(m_pSection)
+			m_pSection->AddSample(time_get() - m_Start);
+	}
+
+	// ends the current section and starts to measure the next stage
+	void Switch(CProfilerSection *pSection)
+	{
+		const int64 Now = m_pSection || CProfiler::IsEnabled() ? time_get() : 0;
+		if(m_pSection)
+			m_pSection->AddSample(Now - m_Start);
+		m_pSection = CProfiler::IsEnabled() ? pSection : nullptr;
+		m_Start = Now;
+	}
+};
+
+#endif
@@ -96,8 +96,13 @@ enum
 	SERVERINFO_LEVEL_MIN=0,
 	SERVERINFO_LEVEL_MAX=2,
 
-	MAX_CLIENTS=64,
-	MAX_PLAYERS=16,
+	// the players take the first ids, after them are the bot ids that every world uses for its own bots
+	MAX_PLAYERS=256,
+	MAX_WORLD_BOTS=64,
+	MAX_CLIENTS=MAX_PLAYERS+MAX_WORLD_BOTS,
+
+	// ids a client knows in the protocol, every world maps its players and bots to them
+	PROTOCOL_MAX_CLIENTS=64,
 
 	ENGINE_MAX_WORLDS = 64,
 	MAIN_WORLD_ID = 0,
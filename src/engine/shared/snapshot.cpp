@@ -580,6 +580,12 @@ CSnapshotItem* CSnapshotBuilder::GetItem(int Index)
 	return (CSnapshotItem*)&(m_aData[m_aOffsets[Index]]);
 }
 
+int CSnapshotBuilder::GetItemSize(int Index) const
+{
+	const int End = Index < m_NumItems - 1 ? m_aOffsets[Index + 1] : m_DataSize;
+	return End - m_aOffsets[Index] - (int)sizeof(CSnapshotItem);
+}
+
 int* CSnapshotBuilder::GetItemData(int Key)
 {
 	int i;
@@ -142,6 +142,9 @@ public:
 	void* NewItem(int Type, int ID, int Size);
 
 	CSnapshotItem* GetItem(int Index);
+	const CSnapshotItem* GetItem(int Index) const { return (const CSnapshotItem*)&(m_aData[m_aOffsets[Index]]); }
+	int GetItemSize(int Index) const;
+	int NumItems() const { return m_NumItems; }
 	int* GetItemData(int Key);
 
 	int Finish(void* pSnapdata);
@@ -248,6 +248,7 @@ enum
 	// all sorting sheets that exist on the server
 	SORT_INVENTORY = 0,
 	SORT_EQUIPING,
+	SORT_TOP_LIST, // the selected top list + 1
 	NUM_SORT_TAB,
 
 	// type of decorations
@@ -50,4 +50,115 @@
 		mem_zero(ms_PoolData##POOLTYPE[id], sizeof(POOLTYPE)); \
 	}
 
+/*
+	Class: Slab Pool
+		Objects of one type are carved from slabs that are allocated as needed,
+		freed objects are kept in a free list for the next allocation. The slabs
+		are never returned, the pool only grows up to the peak of live objects.
+		Objects can be created from the parallel ticked worlds, so the pool is locked.
+*/
+class CSlabPool
+{
+	struct CFreeObject
+	{
+		CFreeObject *m_pNext;
+	};
+
+	const char *m_pName;
+	int m_ObjectSize;
+	int m_SlabObjects;
+	int m_NumSlabs;
+	int m_Live;
+	int m_Peak;
+	CFreeObject *m_pFirstFree;
+	CSlabPool *m_pNextPool;
+	std::mutex m_Lock;
+
+	static CSlabPool *&FirstPool()
+	{
+		static CSlabPool *s_pFirstPool = nullptr;
+		return s_pFirstPool;
+	}
+
+	void Grow()
+	{
+		char *pSlab = (char *)mem_alloc(m_ObjectSize * m_SlabObjects, 16);
+		for(int i = m_SlabObjects - 1; i >= 0; i--)
+		{
+			CFreeObject *pObject = (CFreeObject *)(pSlab + i * m_ObjectSize);
+			pObject->m_pNext = m_pFirstFree;
+			m_pFirstFree = pObject;
+		}
+		m_NumSlabs++;
+	}
+
+public:
+	CSlabPool(const char *pName, int ObjectSize, int SlabObjects)
+	{
+		m_pName = pName;
+		m_ObjectSize = (max(ObjectSize, (int)sizeof(CFreeObject)) + 15) & ~15;
+		m_SlabObjects = SlabObjects;
+		m_NumSlabs = 0;
+		m_Live = 0;
+		m_Peak = 0;
+		m_pFirstFree = nullptr;
+		m_pNextPool = FirstPool();
+		FirstPool() = this;
+	}
+
+	void *Alloc(size_t Size)
+	{
+		dbg_assert((int)Size <= m_ObjectSize, "size error");
+		void *p;
+		{
+			std::lock_guard<std::mutex> Lock(m_Lock);
+			if(!m_pFirstFree)
+				Grow();
+
+			p = m_pFirstFree;
+			m_pFirstFree = m_pFirstFree->m_pNext;
+			m_Peak = max(m_Peak, ++m_Live);
+		}
+		mem_zero(p, Size);
+		return p;
+	}
+
+	void Free(void *p)
+	{
+		if(!p)
+			return;
+
+		std::lock_guard<std::mutex> Lock(m_Lock);
+		CFreeObject *pObject = (CFreeObject *)p;
+		pObject->m_pNext = m_pFirstFree;
+		m_pFirstFree = pObject;
+		m_Live--;
+	}
+
+	static CSlabPool *First() { return FirstPool(); }
+	CSlabPool *Next() const { return m_pNextPool; }
+	const char *GetName() const { return m_pName; }
+	int GetObjectSize() const { return m_ObjectSize; }
+	int GetNumSlabs() const { return m_NumSlabs; }
+	int GetLive() const { return m_Live; }
+	int GetPeak() const { return m_Peak; }
+};
+
+#define MACRO_ALLOC_SLAB() \
+	public: \
+	void *operator new(size_t Size); \
+	void operator delete(void *pPtr); \
+	private:
+
+#define MACRO_ALLOC_SLAB_IMPL(POOLTYPE, SlabObjects) \
+	static CSlabPool ms_SlabPool##POOLTYPE(#POOLTYPE, sizeof(POOLTYPE), SlabObjects); \
+	void *POOLTYPE::operator new(size_t Size) \
+	{ \
+		return ms_SlabPool##POOLTYPE.Alloc(Size); \
+	} \
+	void POOLTYPE::operator delete(void *pPtr) \
+	{ \
+		ms_SlabPool##POOLTYPE.Free(pPtr); \
+	}
+
 #endif
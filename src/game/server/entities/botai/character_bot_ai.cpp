@@ -11,7 +11,7 @@
 #include <game/server/mmocore/Components/Bots/BotData.h>
 #include <game/server/mmocore/Components/Quests/QuestCore.h>
 
-MACRO_ALLOC_POOL_ID_IMPL(CCharacterBotAI, MAX_CLIENTS * ENGINE_MAX_WORLDS + MAX_CLIENTS)
+MACRO_ALLOC_SLAB_IMPL(CCharacterBotAI, 64)
 
 CCharacterBotAI::CCharacterBotAI(CGameWorld *pWorld) : CCharacter(pWorld) {}
 CCharacterBotAI::~CCharacterBotAI() = default;
@@ -328,10 +328,6 @@ void CCharacterBotAI::EngineMobs()
 
 void CCharacterBotAI::Move()
 {
-	bool Status = false;
-	if(!m_pBotPlayer->m_ThreadReadNow.compare_exchange_strong(Status, true, std::memory_order::memory_order_acquire, std::memory_order::memory_order_relaxed))
-		return;
-
 	SetAim(m_pBotPlayer->m_TargetPos - m_Pos);
 
 	int Index = -1;
@@ -449,8 +445,6 @@ void CCharacterBotAI::Move()
 		m_Input.m_Jump = 1;
 		m_MoveTick = Server()->Tick();
 	}
-
-	m_pBotPlayer->m_ThreadReadNow.store(false, std::memory_order::memory_order_release);
 }
 
 void CCharacterBotAI::Action()
@@ -7,7 +7,7 @@
 class CEntityFunctionNurse;
 class CCharacterBotAI : public CCharacter
 {
-	MACRO_ALLOC_POOL_ID()
+	MACRO_ALLOC_SLAB()
 
 	class CPlayerBot* m_pBotPlayer;
 
@@ -41,7 +41,7 @@ CInputCount CountInput(int Prev, int Cur)
 	return c;
 }
 
-MACRO_ALLOC_POOL_ID_IMPL(CCharacter, MAX_CLIENTS * ENGINE_MAX_WORLDS + MAX_CLIENTS)
+MACRO_ALLOC_SLAB_IMPL(CCharacter, 32)
 
 CCharacter::CCharacter(CGameWorld *pWorld)
 : CEntity(pWorld, CGameWorld::ENTTYPE_CHARACTER, vec2(0, 0), ms_PhysSize)
@@ -577,6 +577,7 @@ void CCharacter::TickDefered()
 	{
 		m_Pos.x = m_Input.m_TargetX;
 		m_Pos.y = m_Input.m_TargetY;
+		GameWorld()->GridMove(this);
 	}
 	else if(m_Core.m_Death)
 		Die(m_pPlayer->GetCID(), WEAPON_SELF);
@@ -804,7 +805,11 @@ void CCharacter::Snap(int SnappingClient)
 	if(NetworkClipped(SnappingClient) || !m_pPlayer->IsActiveSnappingBot(SnappingClient))
 		return;
 
-	CNetObj_Character *pCharacter = static_cast<CNetObj_Character *>(Server()->SnapNewItem(NETOBJTYPE_CHARACTER, m_pPlayer->GetCID(), sizeof(CNetObj_Character)));
+	const int ProtocolID = Server()->TranslateClientID(GS()->GetWorldID(), m_pPlayer->GetCID());
+	if(ProtocolID < 0)
+		return;
+
+	CNetObj_Character *pCharacter = static_cast<CNetObj_Character *>(Server()->SnapNewItem(NETOBJTYPE_CHARACTER, ProtocolID, sizeof(CNetObj_Character)));
 	if(!pCharacter)
 		return;
 
@@ -821,6 +826,7 @@ void CCharacter::Snap(int SnappingClient)
 		pCharacter->m_Tick = m_ReckoningTick;
 		m_SendCore.Write(pCharacter);
 	}
+	pCharacter->m_HookedPlayer = Server()->TranslateClientID(GS()->GetWorldID(), pCharacter->m_HookedPlayer);
 
 	// set emote
 	if (m_EmoteStop < Server()->Tick())
@@ -1177,6 +1183,8 @@ void CCharacter::ChangePosition(vec2 NewPos)
 	GS()->CreateDeath(m_Core.m_Pos, m_pPlayer->GetCID());
 	GS()->CreateDeath(NewPos, m_pPlayer->GetCID());
 	m_Core.m_Pos = NewPos;
+	m_Pos = NewPos;
+	GameWorld()->GridMove(this);
 }
 
 void CCharacter::ResetDoorPos()
@@ -8,7 +8,7 @@
 
 class CCharacter : public CEntity
 {
-	MACRO_ALLOC_POOL_ID()
+	MACRO_ALLOC_SLAB()
 
 	// player controlling this character
 	class CPlayer *m_pPlayer;
@@ -6,6 +6,8 @@
 #include <generated/server_data.h>
 #include "character.h"
 
+MACRO_ALLOC_SLAB_IMPL(CLaser, 64)
+
 CLaser::CLaser(CGameWorld *pGameWorld, vec2 Pos, vec2 Direction, float StartEnergy, int Owner)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER, Pos)
 {
@@ -102,9 +104,14 @@ void CLaser::TickPaused()
 	++m_EvalTick;
 }
 
+int CLaser::SnapClipped(int SnappingClient) const
+{
+	return NetworkClipped(SnappingClient) && NetworkClipped(SnappingClient, m_From);
+}
+
 void CLaser::Snap(int SnappingClient)
 {
-	if(NetworkClipped(SnappingClient) && NetworkClipped(SnappingClient, m_From))
+	if(SnapClipped(SnappingClient))
 		return;
 
 	CNetObj_Laser *pObj = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(NETOBJTYPE_LASER, GetID(), sizeof(CNetObj_Laser)));
@@ -6,6 +6,8 @@
 
 class CLaser : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 public:
 	CLaser(CGameWorld *pGameWorld, vec2 Pos, vec2 Direction, float StartEnergy, int Owner);
 
@@ -13,6 +15,8 @@ public:
 	virtual void Tick();
 	virtual void TickPaused();
 	virtual void Snap(int SnappingClient);
+	virtual bool IsSnapShared() const { return true; }
+	virtual int SnapClipped(int SnappingClient) const;
 
 protected:
 	bool HitCharacter(vec2 From, vec2 To);
@@ -15,6 +15,7 @@ public:
 	void Tick() override;
 	virtual void TickPaused();
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 
 private:
 	int m_Type;
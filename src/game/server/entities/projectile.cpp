@@ -5,6 +5,8 @@
 #include <game/server/gamecontext.h>
 #include "character.h"
 
+MACRO_ALLOC_SLAB_IMPL(CProjectile, 256)
+
 CProjectile::CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos, vec2 Dir, int Span,
 		int Damage, bool Explosive, float Force, int SoundImpact, int Weapon)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_PROJECTILE, Pos)
@@ -29,7 +31,7 @@ void CProjectile::Reset()
 	GS()->m_World.DestroyEntity(this);
 }
 
-vec2 CProjectile::GetPos(float Time)
+vec2 CProjectile::GetPos(float Time) const
 {
 	float Curvature = 0;
 	float Speed = 0;
@@ -97,10 +99,15 @@ void CProjectile::TickPaused()
 	++m_StartTick;
 }
 
-void CProjectile::Snap(int SnappingClient)
+int CProjectile::SnapClipped(int SnappingClient) const
 {
 	const float Ct = (Server()->Tick() - m_StartTick) / (float)Server()->TickSpeed();
-	if (NetworkClipped(SnappingClient, GetPos(Ct)))
+	return NetworkClipped(SnappingClient, GetPos(Ct));
+}
+
+void CProjectile::Snap(int SnappingClient)
+{
+	if (SnapClipped(SnappingClient))
 		return;
 
 	if(GS()->IsMmoClient(SnappingClient) && m_OwnerMmoProjType >= 0)
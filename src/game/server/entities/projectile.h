@@ -6,6 +6,8 @@
 
 class CProjectile : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 	vec2 m_Direction;
 	int m_LifeSpan;
 	int m_Owner;
@@ -23,12 +25,14 @@ public:
 	CProjectile(CGameWorld *pGameWorld, int Type, int Owner, vec2 Pos, vec2 Dir, int Span,
 		int Damage, bool Explosive, float Force, int SoundImpact, int Weapon);
 
-	vec2 GetPos(float Time);
+	vec2 GetPos(float Time) const;
 
 	void Reset() override;
 	void Tick() override;
 	virtual void TickPaused();
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
+	int SnapClipped(int SnappingClient) const override;
 
 private:
 	int GetOwnerProjID(int ClientID) const;
@@ -9,6 +9,13 @@ CEntity::CEntity(CGameWorld *pGameWorld, int ObjType, vec2 Pos, int ProximityRad
 
 	m_pPrevTypeEntity = nullptr;
 	m_pNextTypeEntity = nullptr;
+	m_pPrevCellEntity = nullptr;
+	m_pNextCellEntity = nullptr;
+	m_CellX = 0;
+	m_CellY = 0;
+	m_CellBucket = -1;
+	for(CSnapCache& Cache : m_aSnapCache)
+		Cache.m_Tick = -1;
 
 	m_ID = Server()->SnapNewID();
 	m_ObjType = ObjType;
@@ -40,7 +47,7 @@ int CEntity::NetworkClipped(int SnappingClient, vec2 CheckPos) const
 	const float dx = GS()->m_apPlayers[SnappingClient]->m_ViewPos.x-CheckPos.x;
 	const float dy = GS()->m_apPlayers[SnappingClient]->m_ViewPos.y-CheckPos.y;
 
-	if(absolute(dx) > 1000.0f || absolute(dy) > 800.0f)
+	if(absolute(dx) > (float)CGameWorld::SNAP_VIEW_WIDTH || absolute(dy) > (float)CGameWorld::SNAP_VIEW_HEIGHT)
 		return 1;
 
 	if(distance(GS()->m_apPlayers[SnappingClient]->m_ViewPos, CheckPos) > 1100.0f)
@@ -24,6 +24,22 @@ private:
 	CEntity *m_pPrevTypeEntity;
 	CEntity *m_pNextTypeEntity;
 
+	/* Spatial grid */
+	CEntity *m_pPrevCellEntity;
+	CEntity *m_pNextCellEntity;
+	int m_CellX;
+	int m_CellY;
+	int m_CellBucket;
+
+	/* Shared snap, the items of the tick per client kind (normal, mmo) in the world cache */
+	struct CSnapCache
+	{
+		int m_Tick;
+		int m_Offset;
+		int m_Size;
+	};
+	CSnapCache m_aSnapCache[2];
+
 	int m_ID;
 	int m_ObjType;
 
@@ -123,6 +139,21 @@ public:
 	*/
 	virtual void PostSnap() {}
 
+	/*
+		Function: IsSnapShared
+			Whether the snap only depends on the client being a mmo client, once the
+			entity is not clipped for it. Such a snap is made once per tick and the items
+			are copied to the other clients.
+	*/
+	virtual bool IsSnapShared() const { return false; }
+
+	/*
+		Function: SnapClipped
+			Tells if a shared snap is left out for a client, must match the
+			clipping done in Snap.
+	*/
+	virtual int SnapClipped(int SnappingClient) const { return NetworkClipped(SnappingClient); }
+
 
 	/*
 		Function: networkclipped(int snapping_client)
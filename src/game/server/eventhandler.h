@@ -2,6 +2,7 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #ifndef GAME_SERVER_EVENTHANDLER_H
 #define GAME_SERVER_EVENTHANDLER_H
+#include <engine/server.h>
 
 class CEventHandler
 {
@@ -11,7 +12,7 @@ class CEventHandler
 	int m_aTypes[MAX_EVENTS]; // TODO: remove some of these arrays
 	int m_aOffsets[MAX_EVENTS];
 	int m_aSizes[MAX_EVENTS];
-	int64 m_aClientMasks[MAX_EVENTS];
+	CClientMask m_aClientMasks[MAX_EVENTS];
 	char m_aData[MAX_DATASIZE];
 
 	class CGS* m_pGameServer;
@@ -22,7 +23,7 @@ public:
 	void SetGameServer(CGS *pGameServer);
 
 	CEventHandler();
-	void *Create(int Type, int Size, int64 Mask = -1);
+	void *Create(int Type, int Size, const CClientMask &Mask = CClientMask().set());
 	void Clear();
 	void Snap(int SnappingClient);
 };
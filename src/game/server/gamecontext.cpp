@@ -4,6 +4,7 @@
 
 #include <engine/storage.h>
 #include <engine/shared/config.h>
+#include <engine/shared/profiler.h>
 
 #include <game/collision.h>
 #include <game/gamecore.h>
@@ -37,6 +38,7 @@
 // static data that have the same value in different objects
 std::map < int, CGS::StructAttribut > CGS::ms_aAttributsInfo;
 std::unordered_map < std::string, int > CGS::ms_aEffects[MAX_PLAYERS];
+std::mutex CGS::ms_EffectsLock;
 int CGS::m_MultiplierExp = 100;
 
 CGS::CGS()
@@ -59,14 +61,27 @@ CGS::CGS()
 	m_pCommandProcessor = nullptr;
 	m_pPathFinder = nullptr;
 	m_pLayers = nullptr;
+	m_pProfilerTick = nullptr;
+	m_pProfilerPlayers = nullptr;
+	m_pProfilerChat = nullptr;
 }
 
 CGS::~CGS()
 {
+	// write the pending changes of the players on shutdown and heavy reload
+	for(auto* apPlayer : m_apPlayers)
+	{
+		if(apPlayer && m_pMmoController)
+			m_pMmoController->FlushAccount(apPlayer);
+	}
+
 	m_Events.Clear();
 	ms_aAttributsInfo.clear();
-	for(auto& pEffects : ms_aEffects)
-		pEffects.clear();
+	{
+		std::lock_guard<std::mutex> Lock(ms_EffectsLock);
+		for(auto& pEffects : ms_aEffects)
+			pEffects.clear();
+	}
 	for(auto* apPlayer : m_apPlayers)
 		delete apPlayer;
 
@@ -157,7 +172,8 @@ CQuestDataInfo &CGS::GetQuestInfo(int QuestID) const { return CQuestDataInfo::ms
 ######################################################################### */
 void CGS::CreateDamage(vec2 Pos, int ClientID, int Amount, bool CritDamage, bool OnlyVanilla)
 {
-	CNetEvent_Damage* pEventVanilla = (CNetEvent_Damage*)m_Events.Create(NETEVENTTYPE_DAMAGE, sizeof(CNetEvent_Damage));
+	const int ProtocolID = Server()->TranslateClientID(m_WorldID, ClientID);
+	CNetEvent_Damage* pEventVanilla = ProtocolID < 0 ? nullptr : (CNetEvent_Damage*)m_Events.Create(NETEVENTTYPE_DAMAGE, sizeof(CNetEvent_Damage));
 	if(pEventVanilla)
 	{
 		int AmountDamageVanilla = Amount;
@@ -170,7 +186,7 @@ void CGS::CreateDamage(vec2 Pos, int ClientID, int Amount, bool CritDamage, bool
 		}
 		pEventVanilla->m_X = (int)Pos.x;
 		pEventVanilla->m_Y = (int)Pos.y;
-		pEventVanilla->m_ClientID = ClientID;
+		pEventVanilla->m_ClientID = ProtocolID;
 		pEventVanilla->m_Angle = 0;
 		pEventVanilla->m_HealthAmount = AmountDamageVanilla;
 		pEventVanilla->m_ArmorAmount = 0;
@@ -241,16 +257,20 @@ void CGS::CreatePlayerSpawn(vec2 Pos)
 
 void CGS::CreateDeath(vec2 Pos, int ClientID)
 {
+	const int ProtocolID = Server()->TranslateClientID(m_WorldID, ClientID);
+	if(ProtocolID < 0)
+		return;
+
 	CNetEvent_Death *pEvent = (CNetEvent_Death *)m_Events.Create(NETEVENTTYPE_DEATH, sizeof(CNetEvent_Death));
 	if(pEvent)
 	{
 		pEvent->m_X = (int)Pos.x;
 		pEvent->m_Y = (int)Pos.y;
-		pEvent->m_ClientID = ClientID;
+		pEvent->m_ClientID = ProtocolID;
 	}
 }
 
-void CGS::CreateSound(vec2 Pos, int Sound, int64 Mask)
+void CGS::CreateSound(vec2 Pos, int Sound, const CClientMask &Mask)
 {
 	// fix for vanilla unterstand SoundID
 	if(Sound < 0 || Sound > 40)
@@ -417,32 +437,102 @@ void CGS::FakeChat(const char *pName, const char *pText)
 	Server()->BackInformationFakeClient(FakeClientID);
 }
 
-// send a formatted message
-void CGS::Chat(int ClientID, const char* pText, ...)
+// the pending receivers with the language of the first one, they are taken out of the pending ones
+CClientMask CGS::TakeLanguageGroup(CClientMask& Pending, CLocalization::CLanguage** ppLanguage) const
 {
-	const int Start = (ClientID < 0 ? 0 : ClientID);
-	const int End = (ClientID < 0 ? MAX_PLAYERS : ClientID + 1);
+	CLocalization::CLanguage* pMainLanguage = Server()->Localization()->GetLanguage(nullptr);
+	CClientMask Group;
+	*ppLanguage = nullptr;
+	for(int i = 0; i < MAX_PLAYERS && Pending.any(); i++)
+	{
+		if(!Pending.test(i))
+			continue;
 
+		CLocalization::CLanguage* pLanguage = m_apPlayers[i] ? m_apPlayers[i]->GetLanguage() : nullptr;
+		if(!pLanguage)
+			pLanguage = pMainLanguage;
+		if(Group.none())
+			*ppLanguage = pLanguage;
+		else if(pLanguage != *ppLanguage)
+			continue;
+
+		Group.set(i);
+		Pending.reset(i);
+	}
+	return Group;
+}
+
+void CGS::ChatLocalized(CClientMask Receivers, const char* pPrefix, const char* pText, va_list VarArgs, int Flags)
+{
+	CProfilerScope ProfilerScope(m_pProfilerChat);
+
+	// the server messages have no client ids, the packed message is the same in every world
 	CNetMsg_Sv_Chat Msg;
 	Msg.m_Mode = CHAT_ALL;
 	Msg.m_ClientID = -1;
+	Msg.m_TargetID = -1;
 
-	va_list VarArgs;
-	va_start(VarArgs, pText);
+	dynamic_string Buffer;
+	while(Receivers.any())
+	{
+		CLocalization::CLanguage* pLanguage;
+		const CClientMask Group = TakeLanguageGroup(Receivers, &pLanguage);
+
+		if(pPrefix)
+			Buffer.append(pPrefix);
+		Server()->Localization()->Format_VL(Buffer, pLanguage, pText, VarArgs);
+		Msg.m_pMessage = Buffer.buffer();
 
+		CMsgPacker Packer(Msg.MsgID(), false);
+		if(Msg.Pack(&Packer))
+			return;
+		Server()->SendMsg(&Packer, Flags, -1, &Group);
+		Buffer.clear();
+	}
+}
+
+void CGS::BroadcastLocalized(CClientMask Receivers, BroadcastPriority Priority, int LifeSpan, const char* pText, va_list VarArgs)
+{
 	dynamic_string Buffer;
-	for (int i = Start; i < End; i++)
+	while(Receivers.any())
 	{
-		if (m_apPlayers[i])
-		{
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
+		CLocalization::CLanguage* pLanguage;
+		const CClientMask Group = TakeLanguageGroup(Receivers, &pLanguage);
 
-			Msg.m_TargetID = i;
-			Msg.m_pMessage = Buffer.buffer();
-			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, i);
-			Buffer.clear();
+		Server()->Localization()->Format_VL(Buffer, pLanguage, pText, VarArgs);
+		for(int i = 0; i < MAX_PLAYERS; i++)
+		{
+			if(Group.test(i))
+				AddBroadcast(i, Buffer.buffer(), Priority, LifeSpan);
 		}
+		Buffer.clear();
+	}
+}
+
+// send a formatted message
+void CGS::Chat(int ClientID, const char* pText, ...)
+{
+	const int Start = (ClientID < 0 ? 0 : ClientID);
+	const int End = (ClientID < 0 ? MAX_PLAYERS : ClientID + 1);
+
+	CClientMask Receivers;
+	for(int i = Start; i < End; i++)
+	{
+		if(m_apPlayers[i])
+			Receivers.set(i);
 	}
+
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	ChatLocalized(Receivers, nullptr, pText, VarArgs);
+	va_end(VarArgs);
+}
+
+void CGS::ChatNoSend(CClientMask Receivers, const char* pText, ...)
+{
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	ChatLocalized(Receivers, nullptr, pText, VarArgs, MSGFLAG_VITAL|MSGFLAG_NOSEND);
 	va_end(VarArgs);
 }
 
@@ -505,58 +595,33 @@ void CGS::ChatGuild(int GuildID, const char* pText, ...)
 	if(GuildID <= 0)
 		return;
 
-	CNetMsg_Sv_Chat Msg;
-	Msg.m_Mode = CHAT_ALL;
-	Msg.m_ClientID = -1;
-
-	va_list VarArgs;
-	va_start(VarArgs, pText);
-
-	dynamic_string Buffer;
+	CClientMask Receivers;
 	for(int i = 0 ; i < MAX_PLAYERS ; i ++)
 	{
 		CPlayer *pPlayer = GetPlayer(i, true);
 		if(pPlayer && pPlayer->Acc().IsGuild() && pPlayer->Acc().m_GuildID == GuildID)
-		{
-			Buffer.append("[Guild]");
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
-
-			Msg.m_TargetID = i;
-			Msg.m_pMessage = Buffer.buffer();
-
-			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, i);
-			Buffer.clear();
-		}
+			Receivers.set(i);
 	}
+
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	ChatLocalized(Receivers, "[Guild]", pText, VarArgs);
 	va_end(VarArgs);
 }
 
 // Send a message in world
 void CGS::ChatWorldID(int WorldID, const char* Suffix, const char* pText, ...)
 {
-	CNetMsg_Sv_Chat Msg;
-	Msg.m_Mode = CHAT_ALL;
-	Msg.m_ClientID = -1;
-
-	va_list VarArgs;
-	va_start(VarArgs, pText);
-
-	dynamic_string Buffer;
+	CClientMask Receivers;
 	for (int i = 0; i < MAX_PLAYERS; i++)
 	{
-		CPlayer* pPlayer = GetPlayer(i, true);
-		if(!pPlayer || !IsPlayerEqualWorldID(i, WorldID))
-			continue;
-
-		Buffer.append(Suffix);
-		Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
-
-		Msg.m_TargetID = i;
-		Msg.m_pMessage = Buffer.buffer();
-
-		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, i, WorldID);
-		Buffer.clear();
+		if(GetPlayer(i, true) && IsPlayerEqualWorldID(i, WorldID))
+			Receivers.set(i);
 	}
+
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	ChatLocalized(Receivers, Suffix, pText, VarArgs);
 	va_end(VarArgs);
 }
 
@@ -649,36 +714,32 @@ void CGS::Broadcast(int ClientID, BroadcastPriority Priority, int LifeSpan, cons
 	const int Start = (ClientID < 0 ? 0 : ClientID);
 	const int End = (ClientID < 0 ? MAX_PLAYERS : ClientID+1);
 
-	va_list VarArgs;
-	va_start(VarArgs, pText);
+	CClientMask Receivers;
 	for(int i = Start; i < End; i++)
 	{
 		if(m_apPlayers[i])
-		{
-			dynamic_string Buffer;
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
-			AddBroadcast(i, Buffer.buffer(), Priority, LifeSpan);
-			Buffer.clear();
-		}
+			Receivers.set(i);
 	}
+
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	BroadcastLocalized(Receivers, Priority, LifeSpan, pText, VarArgs);
 	va_end(VarArgs);
 }
 
 // formatted world broadcast
 void CGS::BroadcastWorldID(int WorldID, BroadcastPriority Priority, int LifeSpan, const char *pText, ...)
 {
-	va_list VarArgs;
-	va_start(VarArgs, pText);
+	CClientMask Receivers;
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		if(m_apPlayers[i] && IsPlayerEqualWorldID(i, WorldID))
-		{
-			dynamic_string Buffer;
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
-			AddBroadcast(i, Buffer.buffer(), Priority, LifeSpan);
-			Buffer.clear();
-		}
+			Receivers.set(i);
 	}
+
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	BroadcastLocalized(Receivers, Priority, LifeSpan, pText, VarArgs);
 	va_end(VarArgs);
 }
 
@@ -767,7 +828,7 @@ void CGS::SendSettings(int ClientID)
 	Msg.m_SpecVote = 0;
 	Msg.m_TeamLock = 0;
 	Msg.m_TeamBalance = 0;
-	Msg.m_PlayerSlots = MAX_CLIENTS;
+	Msg.m_PlayerSlots = PROTOCOL_MAX_CLIENTS;
 	Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, ClientID);
 }
 
@@ -962,6 +1023,13 @@ void CGS::OnInit(int WorldID)
 	m_WorldID = WorldID;
 	m_RespawnWorldID = -1;
 	m_MusicID = -1;
+	m_Dormant = false;
+	m_DormantStartTick = 0;
+	m_LastActiveTick = Server()->Tick();
+	m_World.InitProfiler(WorldID);
+	m_pProfilerTick = CProfiler::WorldSection(WorldID, "tick");
+	m_pProfilerPlayers = CProfiler::WorldSection(WorldID, "players");
+	m_pProfilerChat = CProfiler::WorldSection(WorldID, "chat");
 
 	for(int i = 0; i < NUM_NETOBJTYPES; i++)
 		Server()->SnapSetStaticsize(i, m_NetObjHandler.GetObjSize(i));
@@ -1001,7 +1069,7 @@ void CGS::OnInit(int WorldID)
 	}
 
 	// initialize pathfinder
-	m_pPathFinder = new CPathfinder(m_pLayers, &m_Collision);
+	m_pPathFinder = new CPathfinder(Server(), m_pLayers, &m_Collision);
 	Console()->Chain("sv_motd", ConchainSpecialMotdupdate, this);
 }
 
@@ -1018,30 +1086,99 @@ void CGS::OnConsoleInit()
 	Console()->Register("say", "r[text]", CFGFLAG_SERVER, ConSay, m_pServer, "Say in chat");
 	Console()->Register("addcharacter", "i[cid]r[botname]", CFGFLAG_SERVER, ConAddCharacter, m_pServer, "(Warning) Add new bot on database or update if finding <clientid> <bot name>");
 	Console()->Register("sync_lines_for_translate", "", CFGFLAG_SERVER, ConSyncLinesForTranslate, m_pServer, "Perform sync lines in translated files. Order non updated translated to up");
+	Console()->Register("entity_pools", "", CFGFLAG_SERVER, ConEntityPools, m_pServer, "Show live and peak objects of the entity slab pools");
+	Console()->Register("chat_bench", "?i[messages]", CFGFLAG_SERVER, ConChatBench, m_pServer, "Format and pack localized messages for all players without sending them and show the cost per message and receiver");
 }
 
 void CGS::OnTick()
 {
+	// nobody can see a dormant world, so it is not simulated at all
+	if(UpdateDormancy())
+		return;
+
+	CProfilerScope ProfilerScope(m_pProfilerTick);
+
+	// hand the finished path searches to their mobs
+	m_pPathFinder->TakeResults(m_aPathResults);
+	for(auto& Result : m_aPathResults)
+	{
+		CPlayer* pPlayer = m_apPlayers[Result.m_ClientID];
+		if(pPlayer && pPlayer->IsBot())
+			static_cast<CPlayerBot*>(pPlayer)->HandlePathResult(Result);
+	}
+
 	m_World.m_Core.m_Tuning = m_Tuning;
 	m_World.Tick();
 
 	m_pController->Tick();
-	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
-		if(!m_apPlayers[i] || m_apPlayers[i]->GetPlayerWorldID() != m_WorldID)
-			continue;
-
-		m_apPlayers[i]->Tick();
-		m_apPlayers[i]->PostTick();
-		if(i < MAX_PLAYERS)
+		CProfilerScope PlayersScope(m_pProfilerPlayers);
+		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
-			BroadcastTick(i);
+			if(!m_apPlayers[i] || m_apPlayers[i]->GetPlayerWorldID() != m_WorldID)
+				continue;
+
+			m_apPlayers[i]->Tick();
+			m_apPlayers[i]->PostTick();
+			if(i < MAX_PLAYERS)
+			{
+				BroadcastTick(i);
+			}
 		}
 	}
 
 	Mmo()->OnTick();
 }
 
+bool CGS::UpdateDormancy()
+{
+	bool ExistsPlayers = !g_Config.m_SvDormantWorlds;
+	for(int i = 0; i < MAX_PLAYERS && !ExistsPlayers; i++)
+	{
+		if(m_apPlayers[i] && m_apPlayers[i]->GetPlayerWorldID() == m_WorldID)
+			ExistsPlayers = true;
+	}
+
+	if(ExistsPlayers)
+	{
+		m_LastActiveTick = Server()->Tick();
+		if(m_Dormant)
+			WakeWorld();
+		return false;
+	}
+
+	// give the world time to finish what is happening (projectiles, deaths, drops) before it falls asleep
+	if(!m_Dormant && Server()->Tick() - m_LastActiveTick >= Server()->TickSpeed() * g_Config.m_SvDormantDelay)
+	{
+		m_Dormant = true;
+		m_DormantStartTick = Server()->Tick();
+		dbg_msg("world", "'%s' (%d) is dormant", Server()->GetWorldName(m_WorldID), m_WorldID);
+	}
+	return m_Dormant;
+}
+
+void CGS::WakeWorld()
+{
+	const int SleptTicks = GetDormantTicks();
+	m_Dormant = false;
+
+	// timers stored as absolute ticks (respawns, pickups) have already expired by themselves,
+	// everything counted per tick or per second has to be caught up here
+	for(int i = MAX_PLAYERS; i < MAX_CLIENTS; i++)
+	{
+		if(m_apPlayers[i] && m_apPlayers[i]->GetPlayerWorldID() == m_WorldID)
+			static_cast<CPlayerBot*>(m_apPlayers[i])->FastForward(SleptTicks);
+	}
+	Mmo()->OnWakeWorld(SleptTicks);
+
+	dbg_msg("world", "'%s' (%d) woke up after %d seconds", Server()->GetWorldName(m_WorldID), m_WorldID, SleptTicks / Server()->TickSpeed());
+}
+
+int CGS::GetDormantTicks() const
+{
+	return m_Dormant ? Server()->Tick() - m_DormantStartTick : 0;
+}
+
 // Here we use functions that can have static data or functions that don't need to be called in all worlds
 void CGS::OnTickMainWorld()
 {
@@ -1146,7 +1283,11 @@ void CGS::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 					CommandProcessor()->ChatCmd(pMsg->m_pMessage, pPlayer);
 					return;
 				}
-				SendChat(ClientID, Mode, pMsg->m_Target, pMsg->m_pMessage);
+				// the target is an id of the protocol in the world of the player
+				const int Target = Server()->ReverseTranslateClientID(pPlayer->GetPlayerWorldID(), pMsg->m_Target);
+				if(Mode == CHAT_WHISPER && Target < 0)
+					return;
+				SendChat(ClientID, Mode, Target, pMsg->m_pMessage);
 			}
 		}
 
@@ -1358,10 +1499,7 @@ void CGS::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 void CGS::OnClientConnected(int ClientID)
 {
 	if(!m_apPlayers[ClientID])
-	{
-		const int AllocMemoryCell = ClientID+m_WorldID*MAX_CLIENTS;
-		m_apPlayers[ClientID] = new(AllocMemoryCell) CPlayer(this, ClientID);
-	}
+		m_apPlayers[ClientID] = new CPlayer(this, ClientID);
 
 	SendMotd(ClientID);
 	SendSettings(ClientID);
@@ -1423,6 +1561,7 @@ void CGS::OnClientDrop(int ClientID, const char *pReason)
 		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, -1);
 	}
 
+	Mmo()->FlushAccount(m_apPlayers[ClientID]);
 	delete m_apPlayers[ClientID];
 	m_apPlayers[ClientID] = nullptr;
 }
@@ -1462,14 +1601,36 @@ void CGS::OnClientPredictedInput(int ClientID, void *pInput)
 // change the world
 void CGS::PrepareClientChangeWorld(int ClientID)
 {
+	// the id of the player in the world that is left is given to another client
+	if(Server()->GetClientWorldID(ClientID) == m_WorldID)
+	{
+		CNetMsg_Sv_ClientDrop Msg;
+		Msg.m_ClientID = ClientID;
+		Msg.m_pReason = "";
+		Msg.m_Silent = true;
+		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, -1, m_WorldID);
+	}
+
 	if (m_apPlayers[ClientID])
 	{
 		m_apPlayers[ClientID]->KillCharacter(WEAPON_WORLD);
+		Mmo()->FlushAccount(m_apPlayers[ClientID]);
 		delete m_apPlayers[ClientID];
 		m_apPlayers[ClientID] = nullptr;
 	}
-	const int AllocMemoryCell = ClientID+m_WorldID*MAX_CLIENTS;
-	m_apPlayers[ClientID] = new(AllocMemoryCell) CPlayer(this, ClientID);
+	m_apPlayers[ClientID] = new CPlayer(this, ClientID);
+}
+
+// the other world has no free client id, the player stays in this world
+void CGS::OnClientChangeWorldRefused(int ClientID, int WorldID)
+{
+	CPlayer *pPlayer = GetPlayer(ClientID, true);
+	if(!pPlayer)
+		return;
+
+	if(!pPlayer->Acc().m_aHistoryWorld.empty() && pPlayer->Acc().m_aHistoryWorld.front() == WorldID)
+		pPlayer->Acc().m_aHistoryWorld.pop_front();
+	Chat(ClientID, "The world {STR} is full, try again later.", Server()->GetWorldName(WorldID));
 }
 
 bool CGS::IsClientReady(int ClientID) const
@@ -1493,7 +1654,10 @@ void CGS::ClearClientData(int ClientID)
 {
 	Mmo()->ResetClientData(ClientID);
 	m_aPlayerVotes[ClientID].clear();
-	ms_aEffects[ClientID].clear();
+	{
+		std::lock_guard<std::mutex> Lock(ms_EffectsLock);
+		ms_aEffects[ClientID].clear();
+	}
 
 	// clear active snap bots for player
 	for(auto& pActiveSnap : DataBotInfo::ms_aDataBot)
@@ -1550,6 +1714,11 @@ void CGS::ConGiveItem(IConsole::IResult *pResult, void *pUserData)
 
 	IServer* pServer = (IServer*)pUserData;
 	CGS* pSelf = (CGS*)pServer->GameServer(pServer->GetClientWorldID(ClientID));
+	if(!CItemDataInfo::IsValid(ItemID))
+	{
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "giveitem", "no such item");
+		return;
+	}
 
 	CPlayer *pPlayer = pSelf->GetPlayer(ClientID, true);
 	if(pPlayer)
@@ -1591,6 +1760,11 @@ void CGS::ConRemItem(IConsole::IResult* pResult, void* pUserData)
 
 	IServer* pServer = (IServer*)pUserData;
 	CGS* pSelf = (CGS*)pServer->GameServer(pServer->GetClientWorldID(ClientID));
+	if(!CItemDataInfo::IsValid(ItemID))
+	{
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "removeitem", "no such item");
+		return;
+	}
 
 	CPlayer* pPlayer = pSelf->GetPlayer(ClientID, true);
 	if (pPlayer)
@@ -1631,6 +1805,53 @@ void CGS::ConSyncLinesForTranslate(IConsole::IResult* pResult, void* pUserData)
 	std::thread(&MmoController::ConSyncLinesForTranslate, pSelf->m_pMmoController).detach();
 }
 
+// show the usage of the entity slab pools
+void CGS::ConEntityPools(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer();
+
+	char aBuf[256];
+	for(const CSlabPool* pPool = CSlabPool::First(); pPool; pPool = pPool->Next())
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: size=%d live=%d peak=%d slabs=%d", pPool->GetName(),
+			pPool->GetObjectSize(), pPool->GetLive(), pPool->GetPeak(), pPool->GetNumSlabs());
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "entity_pools", aBuf);
+	}
+}
+
+// measure the fan-out of a localized chat message to the connected players
+void CGS::ConChatBench(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+	const int NumMessages = clamp(pResult->NumArguments() ? pResult->GetInteger(0) : 10, 1, 1000);
+
+	// the receivers and their languages as the chat groups them
+	int NumReceivers = 0;
+	int NumLanguages = 0;
+	CClientMask Receivers;
+	for(int i = 0; i < MAX_PLAYERS; i++)
+	{
+		if(pSelf->m_apPlayers[i])
+			Receivers.set(i);
+	}
+	CClientMask Pending = Receivers;
+	for(CLocalization::CLanguage* pLanguage; Pending.any(); NumLanguages++)
+		NumReceivers += (int)pSelf->TakeLanguageGroup(Pending, &pLanguage).count();
+
+	// the players are not spammed, only the network send is left out of the cost
+	const int64 Start = time_get();
+	for(int i = 0; i < NumMessages; i++)
+		pSelf->ChatNoSend(Receivers, "Chat benchmark {INT} of {INT}", i + 1, NumMessages);
+	const int64 Time = (time_get() - Start) * 1000000 / time_freq();
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "messages=%d receivers=%d languages=%d total=%dus per message=%dus per receiver=%.2fus", NumMessages,
+		NumReceivers, NumLanguages, (int)Time, (int)(Time / NumMessages), NumReceivers ? (float)Time / NumMessages / NumReceivers : 0.0f);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "chat_bench", aBuf);
+}
+
 void CGS::ConchainSpecialMotdupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
@@ -1667,6 +1888,10 @@ void CGS::ClearVotes(int ClientID)
 {
 	m_aPlayerVotes[ClientID].clear();
 
+	// the results of the previous menu are no longer needed
+	if(m_apPlayers[ClientID] && m_apPlayers[ClientID]->m_pMenuQuery)
+		m_apPlayers[ClientID]->m_pMenuQuery->Cancel();
+
 	// send vote options
 	CNetMsg_Sv_VoteClearOptions ClearMsg;
 	Server()->SendPackMsg(&ClearMsg, MSGFLAG_VITAL, ClientID);
@@ -1680,7 +1905,8 @@ void CGS::AV(int ClientID, const char *pCmd, const char *pDesc, const int TempIn
 
 	char aBufDesc[512]; // buffer x2 with unicode
 	str_copy(aBufDesc, pDesc, sizeof(aBufDesc));
-	if(str_comp(m_apPlayers[ClientID]->GetLanguage(), "ru") == 0 || str_comp(m_apPlayers[ClientID]->GetLanguage(), "uk") == 0)
+	const char* pLanguage = Server()->GetClientLanguage(ClientID);
+	if(str_comp(pLanguage, "ru") == 0 || str_comp(pLanguage, "uk") == 0)
 		str_translation_utf8_to_cp(aBufDesc);
 
 	CVoteOptions Vote;
@@ -1922,8 +2148,8 @@ void CGS::ResetVotes(int ClientID, int MenuList)
 
 	if (Mmo()->OnPlayerHandleMainMenu(ClientID, MenuList, true))
 	{
-		m_apPlayers[ClientID]->m_VoteColored = { 20, 7, 15 };
-		AVL(ClientID, "null", "The main menu will return as soon as you leave this zone!");
+		if(!pPlayer->IsMenuLoading())
+			AddVotesZoneNotice(ClientID);
 		return;
 	}
 
@@ -2046,7 +2272,15 @@ void CGS::ResetVotes(int ClientID, int MenuList)
 		AVM(ClientID, "SELECTEDTOP", ToplistTypes::GUILDS_WEALTHY, NOPE, "Top 10 guilds wealthy");
 		AVM(ClientID, "SELECTEDTOP", ToplistTypes::PLAYERS_LEVELING, NOPE, "Top 10 players leveling");
 		AVM(ClientID, "SELECTEDTOP", ToplistTypes::PLAYERS_WEALTHY, NOPE, "Top 10 players wealthy");
-		AddVotesBackpage(ClientID);
+
+		// the back page follows the rows of the selected list
+		if(pPlayer->m_aSortTabs[SORT_TOP_LIST] > 0)
+		{
+			AV(ClientID, "null");
+			Mmo()->ShowTopList(pPlayer, pPlayer->m_aSortTabs[SORT_TOP_LIST] - 1);
+		}
+		else
+			AddVotesBackpage(ClientID);
 	}
 	else if(MenuList == MenuList::MENU_GUIDEDROP)
 	{
@@ -2164,6 +2398,16 @@ void CGS::AddVotesBackpage(int ClientID)
 	m_apPlayers[ClientID]->m_VoteColored = {0,0,0};
 }
 
+// the notice of the menus that replace the main menu in a zone
+void CGS::AddVotesZoneNotice(int ClientID)
+{
+	if(!m_apPlayers[ClientID])
+		return;
+
+	m_apPlayers[ClientID]->m_VoteColored = { 20, 7, 15 };
+	AVL(ClientID, "null", "The main menu will return as soon as you leave this zone!");
+}
+
 // print player statistics
 void CGS::ShowVotesPlayerStats(CPlayer *pPlayer)
 {
@@ -2247,9 +2491,8 @@ bool CGS::ParsingVoteCommands(int ClientID, const char *CMD, const int VoteID, c
 	}
 	if (PPSTR(CMD, "SELECTEDTOP") == 0)
 	{
+		pPlayer->m_aSortTabs[SORT_TOP_LIST] = VoteID + 1;
 		ResetVotes(ClientID, MenuList::MENU_TOP_LIST);
-		AV(ClientID, "null", "\0");
-		Mmo()->ShowTopList(pPlayer, VoteID);
 		return true;
 	}
 	if(pPlayer->ParseVoteUpgrades(CMD, VoteID, VoteID2, Get))
@@ -2273,8 +2516,8 @@ int CGS::CreateBot(short BotType, int BotID, int SubID)
 	}
 
 	Server()->InitClientBot(BotClientID);
-	const int AllocMemoryCell = BotClientID+m_WorldID*MAX_CLIENTS;
-	m_apPlayers[BotClientID] = new(AllocMemoryCell) CPlayerBot(this, BotClientID, BotID, SubID, BotType);
+	Server()->MapClientID(m_WorldID, BotClientID);
+	m_apPlayers[BotClientID] = new CPlayerBot(this, BotClientID, BotID, SubID, BotType);
 	return BotClientID;
 }
 
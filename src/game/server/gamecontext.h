@@ -60,6 +60,7 @@ public:
 		SWAP GAMECONTEX DATA
 	######################################################################### */
 	static std::unordered_map < std::string /* effect */, int /* seconds */ > ms_aEffects[MAX_PLAYERS];
+	static std::mutex ms_EffectsLock; // the worlds tick in parallel
 	// - - - - - - - - - - - -
 	struct StructAttribut
 	{
@@ -90,7 +91,7 @@ public:
 	void CreateExplosion(vec2 Pos, int Owner, int Weapon, int MaxDamage);
 	void CreatePlayerSpawn(vec2 Pos);
 	void CreateDeath(vec2 Pos, int ClientID);
-	void CreateSound(vec2 Pos, int Sound, int64 Mask=-1);
+	void CreateSound(vec2 Pos, int Sound, const CClientMask &Mask = CClientMask().set());
 	void SendWorldMusic(int ClientID, int MusicID = 0);
 	void CreatePlayerSound(int ClientID, int Sound);
 	void CreateEffect(vec2 Pos, int EffectID);
@@ -103,6 +104,13 @@ private:
 	void SendChat(int ChatterClientID, int Mode, int To, const char *pText);
 	void UpdateDiscordStatus();
 
+	// the text is formatted and packed once for the receivers of every language
+	CClientMask TakeLanguageGroup(CClientMask& Pending, CLocalization::CLanguage** ppLanguage) const;
+	void ChatLocalized(CClientMask Receivers, const char* pPrefix, const char* pText, va_list VarArgs, int Flags = MSGFLAG_VITAL);
+	// formats and packs like Chat but sends nothing, for chat_bench
+	void ChatNoSend(CClientMask Receivers, const char* pText, ...);
+	void BroadcastLocalized(CClientMask Receivers, BroadcastPriority Priority, int LifeSpan, const char* pText, va_list VarArgs);
+
 public:
 	void FakeChat(const char *pName, const char *pText) override;
 	void Chat(int ClientID, const char* pText, ...);
@@ -176,6 +184,7 @@ public:
 	void OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID) override;
 	void OnClientConnected(int ClientID) override;
 	void PrepareClientChangeWorld(int ClientID) override;
+	void OnClientChangeWorldRefused(int ClientID, int WorldID) override;
 
 	void OnClientEnter(int ClientID) override;
 	void OnClientDrop(int ClientID, const char *pReason) override;
@@ -183,6 +192,8 @@ public:
 	void OnClientPredictedInput(int ClientID, void *pInput) override;
 	bool IsClientReady(int ClientID) const override;
 	bool IsClientPlayer(int ClientID) const override;
+	bool IsDormant() const override { return m_Dormant; }
+	int GetDormantTicks() const override;
 
 	const char *Version() const override;
 	const char *NetVersion() const override;
@@ -202,6 +213,8 @@ private:
 	static void ConSay(IConsole::IResult *pResult, void *pUserData);
 	static void ConAddCharacter(IConsole::IResult *pResult, void *pUserData);
 	static void ConSyncLinesForTranslate(IConsole::IResult *pResult, void *pUserData);
+	static void ConEntityPools(IConsole::IResult *pResult, void *pUserData);
+	static void ConChatBench(IConsole::IResult *pResult, void *pUserData);
 	static void ConchainSpecialMotdupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainSettingUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
 	static void ConchainGameinfoUpdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData);
@@ -229,6 +242,7 @@ public:
 	void StrongUpdateVotes(int ClientID, int MenuList);
 	void StrongUpdateVotesForAll(int MenuList);
 	void AddVotesBackpage(int ClientID);
+	void AddVotesZoneNotice(int ClientID);
 	void ShowVotesPlayerStats(CPlayer *pPlayer);
 	void ShowVotesItemValueInformation(CPlayer *pPlayer, int ItemID = itGold);
 	bool ParsingVoteCommands(int ClientID, const char *CMD, int VoteID, int VoteID2, int Get, const char *Text, VoteCallBack Callback = nullptr);
@@ -268,15 +282,24 @@ public:
 private:
 	void UpdateZonePVP();
 	void UpdateZoneDungeon();
+	bool UpdateDormancy();
+	void WakeWorld();
 
+	std::vector<CPathfinder::CResult> m_aPathResults;
 	bool m_AllowedPVP;
+	bool m_Dormant;
+	int m_DormantStartTick;
+	int m_LastActiveTick;
+	class CProfilerSection* m_pProfilerTick;
+	class CProfilerSection* m_pProfilerPlayers;
+	class CProfilerSection* m_pProfilerChat;
 	int m_DayEnumType;
 	static int m_MultiplierExp;
 };
 
-inline int64 CmaskAll() { return -1; }
-inline int64 CmaskOne(int ClientID) { return (int64)1<<ClientID; }
-inline int64 CmaskAllExceptOne(int ClientID) { return CmaskAll()^CmaskOne(ClientID); }
-inline bool CmaskIsSet(int64 Mask, int ClientID) { return (Mask&CmaskOne(ClientID)) != 0; }
+inline CClientMask CmaskAll() { return CClientMask().set(); }
+inline CClientMask CmaskOne(int ClientID) { return CClientMask().set(ClientID); }
+inline CClientMask CmaskAllExceptOne(int ClientID) { return CmaskAll().reset(ClientID); }
+inline bool CmaskIsSet(const CClientMask &Mask, int ClientID) { return Mask.test(ClientID); }
 
 #endif
@@ -75,6 +75,7 @@ public:
 	void SetState(int State) { m_State = State; };
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
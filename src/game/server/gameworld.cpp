@@ -4,6 +4,16 @@
 #include "entity.h"
 #include "gamecontext.h"
 
+#include <engine/shared/profiler.h>
+
+static const char *s_apEntityTypeNames[] = {
+	"projectile", "laser", "pickup", "character", "flag", "random_box", "world_text", "drop_bonus", "drop_item",
+	"drop_quest", "find_quest", "job_items", "snap_effect", "eyes", "eyes_wall", "deco_house", "events",
+	"dungeon_door", "dungeon_progress_door", "guild_house_door", "player_house_door", "npc_door",
+	"skill_turret_heart", "heart_life", "sleepy_gravity", "sleepy_line", "noctis_teleport",
+};
+static_assert(sizeof(s_apEntityTypeNames) / sizeof(s_apEntityTypeNames[0]) == CGameWorld::NUM_ENTTYPES, "every entity type needs a name");
+
 //////////////////////////////////////////////////
 // game world
 //////////////////////////////////////////////////
@@ -14,7 +24,15 @@ CGameWorld::CGameWorld(): m_pNextTraverseEntity(nullptr), m_Paused(false)
 
 	m_ResetRequested = false;
 	for (int i = 0; i < NUM_ENTTYPES; i++)
+	{
 		m_apFirstEntityTypes[i] = nullptr;
+		m_aMaxExtent[i] = 0.0f;
+		m_aNumEntities[i] = 0;
+		m_apProfilerSections[i] = nullptr;
+	}
+	for(int i = 0; i < GRID_BUCKETS; i++)
+		m_apGridBuckets[i] = nullptr;
+	m_GridSnapTick = -1;
 }
 
 CGameWorld::~CGameWorld()
@@ -31,18 +49,125 @@ void CGameWorld::SetGameServer(CGS *pGS)
 	m_pServer = m_pGS->Server();
 }
 
+void CGameWorld::InitProfiler(int WorldID)
+{
+	char aName[64];
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		str_format(aName, sizeof(aName), "entity/%s", s_apEntityTypeNames[i]);
+		m_apProfilerSections[i] = CProfiler::WorldSection(WorldID, aName);
+	}
+}
+
 CEntity *CGameWorld::FindFirst(int Type)
 {
 	return Type < 0 || Type >= NUM_ENTTYPES ? nullptr : m_apFirstEntityTypes[Type];
 }
 
+int CGameWorld::GridBucket(int CellX, int CellY)
+{
+	return (int)(((unsigned)CellX * 73856093u) ^ ((unsigned)CellY * 19349663u)) & (GRID_BUCKETS - 1);
+}
+
+void CGameWorld::GridInsert(CEntity *pEnt)
+{
+	pEnt->m_CellX = (int)floorf(pEnt->m_Pos.x / GRID_CELL_SIZE);
+	pEnt->m_CellY = (int)floorf(pEnt->m_Pos.y / GRID_CELL_SIZE);
+	pEnt->m_CellBucket = GridBucket(pEnt->m_CellX, pEnt->m_CellY);
+
+	CEntity *&pFirst = m_apGridBuckets[pEnt->m_CellBucket];
+	if(pFirst)
+		pFirst->m_pPrevCellEntity = pEnt;
+	pEnt->m_pNextCellEntity = pFirst;
+	pEnt->m_pPrevCellEntity = nullptr;
+	pFirst = pEnt;
+
+	const float Extent = pEnt->m_ProximityRadius + distance(pEnt->m_Pos, pEnt->m_PosTo);
+	m_aMaxExtent[pEnt->m_ObjType] = max(m_aMaxExtent[pEnt->m_ObjType], Extent);
+}
+
+void CGameWorld::GridRemove(CEntity *pEnt)
+{
+	if(pEnt->m_CellBucket < 0)
+		return;
+
+	if(pEnt->m_pPrevCellEntity)
+		pEnt->m_pPrevCellEntity->m_pNextCellEntity = pEnt->m_pNextCellEntity;
+	else
+		m_apGridBuckets[pEnt->m_CellBucket] = pEnt->m_pNextCellEntity;
+	if(pEnt->m_pNextCellEntity)
+		pEnt->m_pNextCellEntity->m_pPrevCellEntity = pEnt->m_pPrevCellEntity;
+
+	pEnt->m_pNextCellEntity = nullptr;
+	pEnt->m_pPrevCellEntity = nullptr;
+	pEnt->m_CellBucket = -1;
+}
+
+void CGameWorld::GridMove(CEntity *pEnt)
+{
+	// only the entities that are in the world have a cell
+	if(pEnt->m_CellBucket < 0)
+		return;
+
+	const int CellX = (int)floorf(pEnt->m_Pos.x / GRID_CELL_SIZE);
+	const int CellY = (int)floorf(pEnt->m_Pos.y / GRID_CELL_SIZE);
+	if(CellX == pEnt->m_CellX && CellY == pEnt->m_CellY)
+		return;
+
+	GridRemove(pEnt);
+	GridInsert(pEnt);
+}
+
+void CGameWorld::UpdateGrid()
+{
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+			GridMove(pEnt);
+}
+
+// calls back every entity of the type that may be inside the box until the callback returns true
+template<typename TCallback>
+void CGameWorld::QueryGrid(vec2 Min, vec2 Max, int Type, TCallback&& Callback) const
+{
+	const float Padding = m_aMaxExtent[Type] + GRID_MOVE_SLACK;
+	const int MinX = (int)floorf((Min.x - Padding) / GRID_CELL_SIZE);
+	const int MinY = (int)floorf((Min.y - Padding) / GRID_CELL_SIZE);
+	const int MaxX = (int)floorf((Max.x + Padding) / GRID_CELL_SIZE);
+	const int MaxY = (int)floorf((Max.y + Padding) / GRID_CELL_SIZE);
+
+	// a large area costs more than walking the entities of the type
+	const float NumCells = (float)(MaxX - MinX + 1) * (float)(MaxY - MinY + 1);
+	if(NumCells > (float)m_aNumEntities[Type])
+	{
+		for(CEntity *pEnt = m_apFirstEntityTypes[Type]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+		{
+			if(Callback(pEnt))
+				return;
+		}
+		return;
+	}
+
+	for(int y = MinY; y <= MaxY; y++)
+		for(int x = MinX; x <= MaxX; x++)
+		{
+			// the bucket is shared by cells with the same hash, only the entities of this cell are taken
+			for(CEntity *pEnt = m_apGridBuckets[GridBucket(x, y)]; pEnt; pEnt = pEnt->m_pNextCellEntity)
+			{
+				if(pEnt->m_ObjType != Type || pEnt->m_CellX != x || pEnt->m_CellY != y)
+					continue;
+				if(Callback(pEnt))
+					return;
+			}
+		}
+}
+
 int CGameWorld::FindEntities(vec2 Pos, float Radius, CEntity **ppEnts, int Max, int Type)
 {
 	if(Type < 0 || Type >= NUM_ENTTYPES)
 		return 0;
 
 	int Num = 0;
-	for(CEntity *pEnt = m_apFirstEntityTypes[Type];	pEnt; pEnt = pEnt->m_pNextTypeEntity)
+	QueryGrid(Pos - vec2(Radius, Radius), Pos + vec2(Radius, Radius), Type, [&](CEntity *pEnt)
 	{
 		if(distance(pEnt->m_Pos, Pos) < Radius+pEnt->m_ProximityRadius)
 		{
@@ -50,9 +175,34 @@ int CGameWorld::FindEntities(vec2 Pos, float Radius, CEntity **ppEnts, int Max,
 				ppEnts[Num] = pEnt;
 			Num++;
 			if(Num == Max)
-				break;
+				return true;
 		}
-	}
+		return false;
+	});
+	return Num;
+}
+
+int CGameWorld::FindEntitiesOnLine(vec2 Pos0, vec2 Pos1, float Radius, CEntity **ppEnts, int Max, int Type)
+{
+	if(Type < 0 || Type >= NUM_ENTTYPES)
+		return 0;
+
+	int Num = 0;
+	const vec2 BoxMin(min(Pos0.x, Pos1.x) - Radius, min(Pos0.y, Pos1.y) - Radius);
+	const vec2 BoxMax(max(Pos0.x, Pos1.x) + Radius, max(Pos0.y, Pos1.y) + Radius);
+	QueryGrid(BoxMin, BoxMax, Type, [&](CEntity *pEnt)
+	{
+		const vec2 IntersectPos = closest_point_on_line(Pos0, Pos1, pEnt->m_Pos);
+		if(distance(pEnt->m_Pos, IntersectPos) <= Radius+pEnt->m_ProximityRadius)
+		{
+			if(ppEnts)
+				ppEnts[Num] = pEnt;
+			Num++;
+			if(Num == Max)
+				return true;
+		}
+		return false;
+	});
 	return Num;
 }
 
@@ -69,6 +219,9 @@ void CGameWorld::InsertEntity(CEntity *pEnt)
 	pEnt->m_pNextTypeEntity = m_apFirstEntityTypes[pEnt->m_ObjType];
 	pEnt->m_pPrevTypeEntity = nullptr;
 	m_apFirstEntityTypes[pEnt->m_ObjType] = pEnt;
+	m_aNumEntities[pEnt->m_ObjType]++;
+
+	GridInsert(pEnt);
 }
 
 void CGameWorld::DestroyEntity(CEntity *pEnt)
@@ -96,23 +249,128 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 
 	pEnt->m_pNextTypeEntity = nullptr;
 	pEnt->m_pPrevTypeEntity = nullptr;
+	m_aNumEntities[pEnt->m_ObjType]--;
+
+	GridRemove(pEnt);
+}
+
+void CGameWorld::SnapEntity(CEntity *pEnt, int SnappingClient)
+{
+	if(SnappingClient < 0 || !pEnt->IsSnapShared())
+	{
+		pEnt->Snap(SnappingClient);
+		return;
+	}
+
+	if(pEnt->SnapClipped(SnappingClient))
+		return;
+
+	// copy the items made for another client in this tick
+	CEntity::CSnapCache &Cache = pEnt->m_aSnapCache[GS()->IsMmoClient(SnappingClient) ? 1 : 0];
+	if(Cache.m_Tick == Server()->Tick())
+	{
+		for(int i = Cache.m_Offset; i < Cache.m_Offset + Cache.m_Size; )
+		{
+			const int Size = m_aSnapCache[i + 2];
+			void *pData = Server()->SnapNewItem(m_aSnapCache[i], m_aSnapCache[i + 1], Size);
+			if(!pData)
+				return;
+
+			mem_copy(pData, &m_aSnapCache[i + 3], Size);
+			i += 3 + Size / (int)sizeof(int);
+		}
+		return;
+	}
+
+	const int FirstItem = Server()->SnapNumItems();
+	pEnt->Snap(SnappingClient);
+
+	Cache.m_Tick = Server()->Tick();
+	Cache.m_Offset = (int)m_aSnapCache.size();
+	for(int i = FirstItem; i < Server()->SnapNumItems(); i++)
+	{
+		int Type, ID, Size;
+		const int *pData = (const int *)Server()->SnapGetItem(i, &Type, &ID, &Size);
+		m_aSnapCache.push_back(Type);
+		m_aSnapCache.push_back(ID);
+		m_aSnapCache.push_back(Size);
+		m_aSnapCache.insert(m_aSnapCache.end(), pData, pData + Size / (int)sizeof(int));
+	}
+	Cache.m_Size = (int)m_aSnapCache.size() - Cache.m_Offset;
+}
+
+// projectiles and lasers are snapped on positions that are away from their entity position
+bool CGameWorld::IsSnappedAway(int Type)
+{
+	return Type == ENTTYPE_PROJECTILE || Type == ENTTYPE_LASER;
 }
 
 //
 void CGameWorld::Snap(int SnappingClient)
 {
+	// the demo recorder takes everything
+	CPlayer *pPlayer = SnappingClient >= 0 ? GS()->m_apPlayers[SnappingClient] : nullptr;
+	if(!pPlayer)
+	{
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+			for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
+			{
+				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+				pEnt->Snap(SnappingClient);
+				pEnt = m_pNextTraverseEntity;
+			}
+		return;
+	}
+
+	// players and commands move entities after the world tick, the cells are refreshed once for all clients
+	if(m_GridSnapTick != Server()->Tick())
+	{
+		UpdateGrid();
+		m_GridSnapTick = Server()->Tick();
+	}
+
 	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		if(!IsSnappedAway(i))
+			continue;
+
 		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			pEnt->Snap(SnappingClient);
+			SnapEntity(pEnt, SnappingClient);
 			pEnt = m_pNextTraverseEntity;
 		}
+	}
+
+	// only the entities of the cells around the view are offered a snap, the others are clipped anyway
+	float Padding = 0.0f;
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+		Padding = max(Padding, m_aMaxExtent[i]);
+
+	const vec2 ViewPos = pPlayer->m_ViewPos;
+	const int MinX = (int)floorf((ViewPos.x - SNAP_VIEW_WIDTH - Padding) / GRID_CELL_SIZE);
+	const int MinY = (int)floorf((ViewPos.y - SNAP_VIEW_HEIGHT - Padding) / GRID_CELL_SIZE);
+	const int MaxX = (int)floorf((ViewPos.x + SNAP_VIEW_WIDTH + Padding) / GRID_CELL_SIZE);
+	const int MaxY = (int)floorf((ViewPos.y + SNAP_VIEW_HEIGHT + Padding) / GRID_CELL_SIZE);
+	for(int y = MinY; y <= MaxY; y++)
+		for(int x = MinX; x <= MaxX; x++)
+		{
+			CEntity *pNext = nullptr;
+			for(CEntity *pEnt = m_apGridBuckets[GridBucket(x, y)]; pEnt; pEnt = pNext)
+			{
+				pNext = pEnt->m_pNextCellEntity;
+				if(pEnt->m_CellX != x || pEnt->m_CellY != y || IsSnappedAway(pEnt->m_ObjType))
+					continue;
+				SnapEntity(pEnt, SnappingClient);
+			}
+		}
 }
 
 //
 void CGameWorld::PostSnap()
 {
+	m_aSnapCache.clear();
+
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		for(CEntity* pEnt = m_apFirstEntityTypes[i]; pEnt; )
 		{
@@ -162,24 +420,38 @@ void CGameWorld::Tick()
 	if(m_ResetRequested)
 		Reset();
 
-	// update all objects
+	// update all objects, the time of both passes is added up per type
+	const bool Profile = CProfiler::IsEnabled();
+	int64 aTickTimes[NUM_ENTTYPES];
 	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		aTickTimes[i] = Profile && m_apFirstEntityTypes[i] ? time_get() : -1;
 		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
 			pEnt->Tick();
 			pEnt = m_pNextTraverseEntity;
 		}
+		if(aTickTimes[i] >= 0)
+			aTickTimes[i] = time_get() - aTickTimes[i];
+	}
+	UpdateGrid();
 
 	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		const int64 Start = aTickTimes[i] >= 0 ? time_get() : 0;
 		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt; )
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
 			pEnt->TickDefered();
 			pEnt = m_pNextTraverseEntity;
 		}
+		if(aTickTimes[i] >= 0 && m_apProfilerSections[i])
+			m_apProfilerSections[i]->AddSample(aTickTimes[i] + time_get() - Start);
+	}
 
 	RemoveEntities();
+	UpdateGrid();
 }
 
 
@@ -190,11 +462,12 @@ CCharacter *CGameWorld::IntersectCharacter(vec2 Pos0, vec2 Pos1, float Radius, v
 	float ClosestLen = distance(Pos0, Pos1) * 100.0f;
 	CCharacter *pClosest = nullptr;
 
-	CCharacter *p = (CCharacter *)FindFirst(ENTTYPE_CHARACTER);
-	for(; p; p = (CCharacter *)p->TypeNext())
- 	{
+	const vec2 BoxMin(min(Pos0.x, Pos1.x) - Radius, min(Pos0.y, Pos1.y) - Radius);
+	const vec2 BoxMax(max(Pos0.x, Pos1.x) + Radius, max(Pos0.y, Pos1.y) + Radius);
+	QueryGrid(BoxMin, BoxMax, ENTTYPE_CHARACTER, [&](CEntity *p)
+	{
 		if(p == pNotThis)
-			continue;
+			return false;
 
 		vec2 IntersectPos = closest_point_on_line(Pos0, Pos1, p->m_Pos);
 		float Len = distance(p->m_Pos, IntersectPos);
@@ -205,25 +478,30 @@ CCharacter *CGameWorld::IntersectCharacter(vec2 Pos0, vec2 Pos1, float Radius, v
 			{
 				NewPos = IntersectPos;
 				ClosestLen = Len;
-				pClosest = p;
+				pClosest = (CCharacter *)p;
 			}
 		}
-	}
+		return false;
+	});
 
 	return pClosest;
 }
 
 bool CGameWorld::IntersectClosestEntity(vec2 Pos, float Radius, int EnttypeID)
 {
-	for(CEntity *pDoor = (CEntity *)FindFirst(EnttypeID); pDoor; pDoor = (CEntity *)pDoor->TypeNext())
- 	{
+	if(EnttypeID < 0 || EnttypeID >= NUM_ENTTYPES)
+		return false;
+
+	bool Found = false;
+	QueryGrid(Pos - vec2(Radius, Radius), Pos + vec2(Radius, Radius), EnttypeID, [&](CEntity *pDoor)
+	{
 		vec2 IntersectPos = pDoor->m_PosTo;
 		if(pDoor->m_Pos != pDoor->m_PosTo)
 			IntersectPos = closest_point_on_line(pDoor->m_Pos, pDoor->m_PosTo, Pos);
-		if (distance(IntersectPos, Pos) <= Radius)
-			return true;
-	}
-	return false;
+		Found = distance(IntersectPos, Pos) <= Radius;
+		return Found;
+	});
+	return Found;
 }
 
 bool CGameWorld::IntersectClosestDoorEntity(vec2 Pos, float Radius)
@@ -241,15 +519,17 @@ bool CGameWorld::IntersectClosestDoorEntity(vec2 Pos, float Radius)
 
 CEntity *CGameWorld::ClosestEntity(vec2 Pos, float Radius, int Type, CEntity *pNotThis) const
 {
+	if(Type < 0 || Type >= NUM_ENTTYPES)
+		return nullptr;
+
 	// Find other players
 	float ClosestRange = Radius*2;
 	CEntity *pClosest = nullptr;
 
-	CEntity *p = GS()->m_World.FindFirst(Type);
-	for(; p; p = p->TypeNext())
- 	{
+	QueryGrid(Pos - vec2(Radius, Radius), Pos + vec2(Radius, Radius), Type, [&](CEntity *p)
+	{
 		if(p == pNotThis)
-			continue;
+			return false;
 
 		const float Len = distance(Pos, p->m_Pos);
 		if(Len < p->m_ProximityRadius+Radius)
@@ -260,7 +540,8 @@ CEntity *CGameWorld::ClosestEntity(vec2 Pos, float Radius, int Type, CEntity *pN
 				pClosest = p;
 			}
 		}
-	}
+		return false;
+	});
 
 	return pClosest;
 }
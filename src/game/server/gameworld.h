@@ -54,6 +54,13 @@ public:
 		NUM_ENTTYPES
 	};
 
+	// half size of the area around the view of a client that is snapped
+	enum
+	{
+		SNAP_VIEW_WIDTH = 1000,
+		SNAP_VIEW_HEIGHT = 800,
+	};
+
 private:
 	void Reset();
 	void RemoveEntities();
@@ -61,9 +68,43 @@ private:
 	CEntity *m_pNextTraverseEntity;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
 
+	/*
+		Spatial grid
+			Entities are hashed into square cells by their position, so a query only walks
+			the entities of the cells around it. The cells are updated after the entities
+			ticked, queries in between are padded by the distance an entity moves in a tick.
+			The extent of a type covers the proximity radius and the line of door entities.
+	*/
+	enum
+	{
+		GRID_CELL_SIZE = 256,
+		GRID_BUCKETS = 4096,
+		GRID_MOVE_SLACK = 128,
+	};
+
+	CEntity *m_apGridBuckets[GRID_BUCKETS];
+	float m_aMaxExtent[NUM_ENTTYPES];
+	int m_aNumEntities[NUM_ENTTYPES];
+	int m_GridSnapTick;
+
+	// items of the shared entity snaps of this tick, each as type, id, size and the data
+	std::vector<int> m_aSnapCache;
+	void SnapEntity(CEntity *pEnt, int SnappingClient);
+
+	static int GridBucket(int CellX, int CellY);
+	void GridInsert(CEntity *pEnt);
+	void GridRemove(CEntity *pEnt);
+	void UpdateGrid();
+	static bool IsSnappedAway(int Type);
+	template<typename TCallback>
+	void QueryGrid(vec2 Min, vec2 Max, int Type, TCallback&& Callback) const;
+
 	class CGS *m_pGS;
 	class IServer *m_pServer;
 
+	// time of the entities ticks by type
+	class CProfilerSection *m_apProfilerSections[NUM_ENTTYPES];
+
 public:
 	class CGS *GS() const { return m_pGS; }
 	class IServer *Server() const { return m_pServer; }
@@ -76,6 +117,7 @@ public:
 	~CGameWorld();
 
 	void SetGameServer(CGS *pGS);
+	void InitProfiler(int WorldID);
 
 	CEntity *FindFirst(int Type);
 
@@ -96,6 +138,24 @@ public:
 	*/
 	int FindEntities(vec2 Pos, float Radius, CEntity **ppEnts, int Max, int Type);
 
+	/*
+		Function: FindEntitiesOnLine
+			Finds entities close to a line and returns them in a list.
+
+		Arguments:
+			Pos0 - Start position
+			Pos1 - End position
+			Radius - How close to the line the entities have to be.
+			ppEnts - Pointer to a list that should be filled with the pointers
+				to the entities.
+			Max - Number of entities that fits into the ents array.
+			Type - Type of the entities to find.
+
+		Returns:
+			Number of entities found and added to the ents array.
+	*/
+	int FindEntitiesOnLine(vec2 Pos0, vec2 Pos1, float Radius, CEntity **ppEnts, int Max, int Type);
+
 	/*
 		Function: closest_CEntity
 			Finds the closest CEntity of a type to a specific point.
@@ -154,6 +214,16 @@ public:
 	*/
 	void RemoveEntity(CEntity *pEntity);
 
+	/*
+		Function: grid_move
+			Moves an entity to the grid cell of its position, for the
+			positions that jump further than an entity moves in a tick.
+
+		Arguments:
+			entity - Entity that was moved
+	*/
+	void GridMove(CEntity *pEntity);
+
 	/*
 		Function: destroy_entity
 			Destroys an entity in the world.
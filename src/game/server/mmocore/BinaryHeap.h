@@ -1,96 +1,97 @@
 /* Binary heap class for pathfind by Sushi */
 #ifndef GAME_SERVER_BINARYHEAP_H
 #define GAME_SERVER_BINARYHEAP_H
-#include <base/tl/array.h>
 
-template <class T>
-class CBinaryHeap
+// min-heap of node ids, the position of every id is tracked so its key can be lowered in place
+class CIndexedBinaryHeap
 {
 public:
-	CBinaryHeap()
+	void SetSize(int NumIDs)
 	{
-		m_CurrentSize = 0;
-		m_lItems.clear();
+		if((int)m_aPosition.size() < NumIDs)
+			m_aPosition.resize(NumIDs);
 	}
 
-	void SetSize(int NewSize)
+	int GetMin() const
 	{
-		m_lItems.set_size(NewSize + 1);
-	}
-
-	const T* GetMin()
-	{
-		return &m_lItems[1];
+		return m_aItems[0].m_ID;
 	}
 
 	void RemoveMin()
 	{
-		m_lItems[1] = m_lItems[m_CurrentSize--];
-		PercolateDown(1);
+		const CItem Last = m_aItems.back();
+		m_aItems.pop_back();
+		if(m_aItems.empty())
+			return;
+
+		m_aItems[0] = Last;
+		m_aPosition[Last.m_ID] = 0;
+		PercolateDown(0);
 	}
 
-	void Insert(const T& Item)
+	void Insert(int ID, int Key)
 	{
-		// Percolate up
-		int Hole = ++m_CurrentSize;
-		for (; Hole > 1 && Item < m_lItems[Hole / 2]; Hole /= 2)
-			m_lItems[Hole] = m_lItems[Hole / 2];
-		m_lItems[Hole] = Item;
+		m_aItems.push_back({ Key, ID });
+		PercolateUp((int)m_aItems.size() - 1);
 	}
 
-	void Replace(const T& Item)
+	// the id must be in the heap and the key must not grow
+	void DecreaseKey(int ID, int Key)
 	{
-		int Index = 0;
-		// replace
-		for (int i = 0; i < m_CurrentSize; i++)
-		{
-			if (Item == m_lItems[i])
-			{
-				m_lItems[i] = Item;
-				Index = i;
-				break;
-			}
-		}
-
-		// Percolate up
-		int Hole = Index;
-		for (; Hole > 1 && m_lItems[Index] < m_lItems[Hole / 2]; Hole /= 2)
-			m_lItems[Hole] = m_lItems[Hole / 2];
-		m_lItems[Hole] = m_lItems[Index];
+		const int Hole = m_aPosition[ID];
+		m_aItems[Hole].m_Key = Key;
+		PercolateUp(Hole);
 	}
 
 	void MakeEmpty()
 	{
-		m_CurrentSize = 0;
+		m_aItems.clear();
 	}
 
 	int GetSize() const
 	{
-		return m_CurrentSize;
+		return (int)m_aItems.size();
 	}
 
 private:
-	array<T> m_lItems;
+	struct CItem
+	{
+		int m_Key;
+		int m_ID;
+	};
 
-	// fake current size
-	int m_CurrentSize;
+	std::vector<CItem> m_aItems;
+	std::vector<int> m_aPosition;
 
-	void PercolateDown(int Hole)
+	void PercolateUp(int Hole)
 	{
-		int Child;
-		T Tmp = m_lItems[Hole];
+		const CItem Item = m_aItems[Hole];
+		for(; Hole > 0 && Item.m_Key < m_aItems[(Hole - 1) / 2].m_Key; Hole = (Hole - 1) / 2)
+		{
+			m_aItems[Hole] = m_aItems[(Hole - 1) / 2];
+			m_aPosition[m_aItems[Hole].m_ID] = Hole;
+		}
+		m_aItems[Hole] = Item;
+		m_aPosition[Item.m_ID] = Hole;
+	}
 
-		for (; Hole * 2 <= m_CurrentSize; Hole = Child)
+	void PercolateDown(int Hole)
+	{
+		const int Size = (int)m_aItems.size();
+		const CItem Item = m_aItems[Hole];
+		for(int Child = Hole * 2 + 1; Child < Size; Child = Hole * 2 + 1)
 		{
-			Child = Hole * 2;
-			if (Child != m_CurrentSize && m_lItems[Child + 1] < m_lItems[Child])
+			if(Child + 1 < Size && m_aItems[Child + 1].m_Key < m_aItems[Child].m_Key)
 				Child++;
-			if (m_lItems[Child] < Tmp)
-				m_lItems[Hole] = m_lItems[Child];
-			else
+			if(!(m_aItems[Child].m_Key < Item.m_Key))
 				break;
+
+			m_aItems[Hole] = m_aItems[Child];
+			m_aPosition[m_aItems[Hole].m_ID] = Hole;
+			Hole = Child;
 		}
-		m_lItems[Hole] = Tmp;
+		m_aItems[Hole] = Item;
+		m_aPosition[Item.m_ID] = Hole;
 	}
 };
 
@@ -42,7 +42,7 @@ int CAccountCore::RegisterAccount(int ClientID, const char *Login, const char *P
 		return SendAuthCode(ClientID, AUTH_ALL_MUSTCHAR);
 	}
 	const CSqlString<32> cClearNick = CSqlString<32>(Server()->ClientName(ClientID));
-	ResultPtr pRes = SJK.SD("ID", "tw_accounts_data", "WHERE Nick = '%s'", cClearNick.cstr());
+	ResultPtr pRes = SJK.SD("ID", "tw_accounts_data", "WHERE Nick = ?", CSqlParams().String(cClearNick.str()));
 	if(pRes->next())
 	{
 		GS()->Chat(ClientID, "- - - - [Your nickname is already registered] - - - -");
@@ -64,61 +64,77 @@ int CAccountCore::RegisterAccount(int ClientID, const char *Login, const char *P
 	char aSalt[32] = { 0 };
 	secure_random_password(aSalt, sizeof(aSalt), 24);
 
-	SJK.ID("tw_accounts", "(ID, Username, Password, PasswordSalt, RegisterDate, RegisteredIP) VALUES ('%d', '%s', '%s', '%s', UTC_TIMESTAMP(), '%s')", InitID, cClearLogin.cstr(), HashPassword(cClearPass.cstr(), aSalt).c_str(), aSalt, aAddrStr);
-	SJK.IDS(100, "tw_accounts_data", "(ID, Nick) VALUES ('%d', '%s')", InitID, cClearNick.cstr());
+	SJK.ID("tw_accounts", "(ID, Username, Password, PasswordSalt, RegisterDate, RegisteredIP) VALUES (?, ?, ?, ?, UTC_TIMESTAMP(), ?)",
+		CSqlParams().Int(InitID).String(cClearLogin.str()).String(HashPassword(cClearPass.str(), aSalt).c_str()).String(aSalt).String(aAddrStr));
+	SJK.IDS(100, "tw_accounts_data", "(ID, Nick) VALUES (?, ?)", CSqlParams().Int(InitID).String(cClearNick.str()));
 
 	GS()->Chat(ClientID, "- - - - - - - [Successful registered] - - - - - - -");
 	GS()->Chat(ClientID, "Don't forget your data, have a nice game!");
 	GS()->Chat(ClientID, "# Your nickname is a unique identifier!");
-	GS()->Chat(ClientID, "# Log in: \"/login {STR} {STR}\"", cClearLogin.cstr(), cClearPass.cstr());
+	GS()->Chat(ClientID, "# Log in: \"/login {STR} {STR}\"", cClearLogin.str(), cClearPass.str());
 	return SendAuthCode(ClientID, AUTH_REGISTER_GOOD);
 }
 
-int CAccountCore::LoginAccount(int ClientID, const char *Login, const char *Password)
+void CAccountCore::LoginAccount(int ClientID, const char *Login, const char *Password)
 {
 	CPlayer *pPlayer = GS()->GetPlayer(ClientID, false);
 	if(!pPlayer)
-		return SendAuthCode(ClientID, AUTH_ALL_UNKNOWN);
+	{
+		SendAuthCode(ClientID, AUTH_ALL_UNKNOWN);
+		return;
+	}
 
 	const int LengthLogin = str_length(Login);
 	const int LengthPassword = str_length(Password);
 	if(LengthLogin > 12 || LengthLogin < 4 || LengthPassword > 12 || LengthPassword < 4)
 	{
 		GS()->ChatFollow(ClientID, "Username / Password must contain 4-12 characters");
-		return SendAuthCode(ClientID, AUTH_ALL_MUSTCHAR);
+		SendAuthCode(ClientID, AUTH_ALL_MUSTCHAR);
+		return;
 	}
 
+	// the previous request is replaced by the new one
+	if(pPlayer->m_pAuthQuery)
+		pPlayer->m_pAuthQuery->Cancel();
+
+	// the account is selected by nickname, the credentials are joined only for the same username
 	const CSqlString<32> cClearLogin = CSqlString<32>(Login);
-	const CSqlString<32> cClearPass = CSqlString<32>(Password);
 	const CSqlString<32> cClearNick = CSqlString<32>(Server()->ClientName(ClientID));
-	ResultPtr pResAccount = SJK.SD("*", "tw_accounts_data", "WHERE Nick = '%s'", cClearNick.cstr());
-	if(pResAccount->next())
+	const std::string ClearLogin = cClearLogin.str();
+	const std::string ClearPass = CSqlString<32>(Password).str();
+	pPlayer->m_pAuthQuery = SJK.SDA("tw_accounts_data.*, tw_accounts.LoginDate, tw_accounts.Language, tw_accounts.Password, tw_accounts.PasswordSalt", "tw_accounts_data",
+		[this, ClientID, ClearLogin, ClearPass](ResultPtr pResAccount)
 	{
-		const int UserID = pResAccount->getInt("ID");
-		ResultPtr pResCheck = SJK.SD("ID, LoginDate, Language, Password, PasswordSalt", "tw_accounts", "WHERE Username = '%s' AND ID = '%d'", cClearLogin.cstr(), UserID);
+		CPlayer *pPlayer = GS()->GetPlayer(ClientID, false);
+		if(!pPlayer || pPlayer->IsAuthed())
+			return;
 
-		bool LoginSuccess = false;
-		if(pResCheck->next())
+		if(!pResAccount->next())
 		{
-			if(!str_comp(pResCheck->getString("Password").c_str(), HashPassword(cClearPass.cstr(), pResCheck->getString("PasswordSalt").c_str()).c_str()))
-				LoginSuccess = true;
+			GS()->Chat(ClientID, "Your nickname was not found in the database!");
+			SendAuthCode(ClientID, AUTH_LOGIN_NICKNAME);
+			return;
 		}
 
-		if(!LoginSuccess)
+		const int UserID = pResAccount->getInt("ID");
+		const std::string PasswordHash = pResAccount->getString("Password").c_str();
+		if(PasswordHash.empty() || str_comp(PasswordHash.c_str(), HashPassword(ClearPass.c_str(), pResAccount->getString("PasswordSalt").c_str()).c_str()) != 0)
 		{
 			GS()->Chat(ClientID, "Wrong login or password!");
-			return SendAuthCode(ClientID, AUTH_LOGIN_WRONG);
+			SendAuthCode(ClientID, AUTH_LOGIN_WRONG);
+			return;
 		}
 
 		if (GS()->GetPlayerFromUserID(UserID) != nullptr)
 		{
 			GS()->Chat(ClientID, "The account is already in the game!");
-			return SendAuthCode(ClientID, AUTH_LOGIN_ALREADY);
+			SendAuthCode(ClientID, AUTH_LOGIN_ALREADY);
+			return;
 		}
 
-		Server()->SetClientLanguage(ClientID, pResCheck->getString("Language").c_str());
-		str_copy(pPlayer->Acc().m_aLogin, cClearLogin.cstr(), sizeof(pPlayer->Acc().m_aLogin));
-		str_copy(pPlayer->Acc().m_aLastLogin, pResCheck->getString("LoginDate").c_str(), sizeof(pPlayer->Acc().m_aLastLogin));
+		Server()->SetClientLanguage(ClientID, pResAccount->getString("Language").c_str());
+		str_copy(pPlayer->Acc().m_aLogin, ClearLogin.c_str(), sizeof(pPlayer->Acc().m_aLogin));
+		str_copy(pPlayer->Acc().m_aLastLogin, pResAccount->getString("LoginDate").c_str(), sizeof(pPlayer->Acc().m_aLastLogin));
 
 		pPlayer->Acc().m_UserID = UserID;
 		pPlayer->Acc().m_Level = pResAccount->getInt("Level");
@@ -140,12 +156,11 @@ int CAccountCore::LoginAccount(int ClientID, const char *Login, const char *Pass
 
 		char aAddrStr[64];
 		Server()->GetClientAddr(ClientID, aAddrStr, sizeof(aAddrStr));
-		SJK.UD("tw_accounts", "LoginDate = CURRENT_TIMESTAMP, LoginIP = '%s' WHERE ID = '%d'", aAddrStr, UserID);
-		return SendAuthCode(ClientID, AUTH_LOGIN_GOOD);
-	}
-
-	GS()->Chat(ClientID, "Your nickname was not found in the database!");
-	return SendAuthCode(ClientID, AUTH_LOGIN_NICKNAME);
+		SJK.UD("tw_accounts", "LoginDate = CURRENT_TIMESTAMP, LoginIP = ? WHERE ID = ?", CSqlParams().OrderKey(UserID).String(aAddrStr).Int(UserID));
+		SendAuthCode(ClientID, AUTH_LOGIN_GOOD);
+		LoadAccount(pPlayer, true);
+	}, "LEFT JOIN tw_accounts ON tw_accounts.ID = tw_accounts_data.ID AND tw_accounts.Username = ? WHERE tw_accounts_data.Nick = ?",
+		CSqlParams().String(cClearLogin.str()).String(cClearNick.str()));
 }
 
 void CAccountCore::LoadAccount(CPlayer *pPlayer, bool FirstInitilize)
@@ -210,10 +225,10 @@ void CAccountCore::DiscordConnect(int ClientID, const char *pDID) const
 	const CSqlString<64> cDiscordID = CSqlString<64>(pDID);
 
 	// disable another account if it is connected to this discord
-	SJK.UD("tw_accounts_data", "DiscordID = 'null' WHERE DiscordID = '%s'", cDiscordID.cstr());
+	SJK.UD("tw_accounts_data", "DiscordID = 'null' WHERE DiscordID = ?", CSqlParams().String(cDiscordID.str()));
 
 	// connect the player discord id
-	SJK.UDS(1000,"tw_accounts_data", "DiscordID = '%s' WHERE ID = '%d'", cDiscordID.cstr(), pPlayer->Acc().m_UserID);
+	SJK.UDS(1000,"tw_accounts_data", "DiscordID = ? WHERE ID = ?", CSqlParams().String(cDiscordID.str()).Int(pPlayer->Acc().m_UserID));
 
 	GS()->Chat(ClientID, "Your Discord ID has been updated.");
 	GS()->Chat(ClientID, "Check the connection status in discord \"/connect\".");
@@ -250,25 +265,23 @@ bool CAccountCore::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Replace
 		// settings
 		GS()->AVH(ClientID, TAB_SETTINGS, RED_COLOR, "Some of the settings becomes valid after death");
 		GS()->AVM(ClientID, "MENU", MenuList::MENU_SELECT_LANGUAGE, TAB_SETTINGS, "Settings language");
-		for (const auto& it : CItemData::ms_aItems[ClientID])
+		for (const CItemData& ItemData : CItemData::ms_aItems[ClientID])
 		{
-			const CItemData ItemData = it.second;
-			if (ItemData.Info().m_Type == ItemType::TYPE_SETTINGS && ItemData.m_Value > 0)
-				GS()->AVM(ClientID, "ISETTINGS", it.first, TAB_SETTINGS, "[{STR}] {STR}", (ItemData.m_Settings ? "Enable" : "Disable"), ItemData.Info().GetName());
+			if (ItemData.m_Value > 0 && ItemData.Info().m_Type == ItemType::TYPE_SETTINGS)
+				GS()->AVM(ClientID, "ISETTINGS", ItemData.GetID(), TAB_SETTINGS, "[{STR}] {STR}", (ItemData.m_Settings ? "Enable" : "Disable"), ItemData.Info().GetName());
 		}
 
 		// equipment modules
 		bool IsFoundModules = false;
 		GS()->AV(ClientID, "null");
 		GS()->AVH(ClientID, TAB_SETTINGS_MODULES, GREEN_COLOR, "Modules settings");
-		for (const auto& it : CItemData::ms_aItems[ClientID])
+		for (const CItemData& ItemData : CItemData::ms_aItems[ClientID])
 		{
-			const CItemData ItemData = it.second;
-			if (ItemData.Info().m_Type == ItemType::TYPE_MODULE && ItemData.m_Value > 0)
+			if (ItemData.m_Value > 0 && ItemData.Info().m_Type == ItemType::TYPE_MODULE)
 			{
 				char aAttributes[128];
 				ItemData.FormatAttributes(pPlayer, aAttributes, sizeof(aAttributes));
-				GS()->AVMI(ClientID, ItemData.Info().GetIcon(), "ISETTINGS", it.first, TAB_SETTINGS_MODULES, "{STR} {STR}{STR}",
+				GS()->AVMI(ClientID, ItemData.Info().GetIcon(), "ISETTINGS", ItemData.GetID(), TAB_SETTINGS_MODULES, "{STR} {STR}{STR}",
 					ItemData.Info().GetName(), aAttributes, (ItemData.m_Settings ? "✔" : "\0"));
 				IsFoundModules = true;
 			}
@@ -298,7 +311,7 @@ bool CAccountCore::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Replace
 			GS()->AV(ClientID, "null");
 		}
 
-		const char* pPlayerLanguage = pPlayer->GetLanguage();
+		const char* pPlayerLanguage = Server()->GetClientLanguage(ClientID);
 		GS()->AVH(ClientID, TAB_LANGUAGES, GRAY_COLOR, "Active language: [{STR}]", pPlayerLanguage);
 		for(int i = 0; i < Server()->Localization()->m_pLanguages.size(); i++)
 		{
@@ -354,9 +367,8 @@ void CAccountCore::OnMessage(int MsgID, void* pRawMsg, int ClientID)
 			return;
 		}
 
-		// account authorization
-		if(LoginAccount(ClientID, pMsg->m_Login, pMsg->m_Password) == AUTH_LOGIN_GOOD)
-			LoadAccount(pPlayer, true);
+		// account authorization, the account is loaded when the query is completed
+		LoginAccount(ClientID, pMsg->m_Login, pMsg->m_Password);
 	}
 }
 
@@ -384,7 +396,7 @@ void CAccountCore::UseVoucher(int ClientID, const char* pVoucher) const
 	const CSqlString<32> cVoucherCode = CSqlString<32>(pVoucher);
 	str_format(aSelect, sizeof(aSelect), "v.*, IF((SELECT r.ID FROM tw_voucher_redeemed r WHERE CASE v.Multiple WHEN 1 THEN r.VoucherID = v.ID AND r.UserID = %d ELSE r.VoucherID = v.ID END) IS NULL, FALSE, TRUE) AS used", pPlayer->Acc().m_UserID);
 
-	ResultPtr pResVoucher = SJK.SD(aSelect, "tw_voucher v", "WHERE v.Code = '%s'", cVoucherCode.cstr());
+	ResultPtr pResVoucher = SJK.SD(aSelect, "tw_voucher v", "WHERE v.Code = ?", CSqlParams().String(cVoucherCode.str()));
 	if (pResVoucher->next())
 	{
 		const int VoucherID = pResVoucher->getInt("ID");
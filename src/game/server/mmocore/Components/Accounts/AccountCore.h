@@ -22,7 +22,7 @@ class CAccountCore : public MmoComponent
 public:
 	int SendAuthCode(int ClientID, int Code) const;
 	int RegisterAccount(int ClientID, const char *Login, const char *Password);
-	int LoginAccount(int ClientID, const char *Login, const char *Password);
+	void LoginAccount(int ClientID, const char *Login, const char *Password);
 	void LoadAccount(CPlayer *pPlayer, bool FirstInitilize = false);
 	void DiscordConnect(int ClientID, const char *pDID) const;
 
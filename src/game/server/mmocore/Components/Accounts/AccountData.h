@@ -35,11 +35,16 @@ struct CAccountData
 	CFieldData<int> m_aMining[NUM_JOB_ACCOUNTS_STATS];
 	CFieldData<int> m_aFarming[NUM_JOB_ACCOUNTS_STATS];
 
+	// changes waiting for the write to the database (SaveType bits and item ids)
+	int m_SaveFlags;
+	std::set< int > m_aSaveItems;
+
 	CAccountData()
 	{
 		m_UserID = -1;
 		m_Level = 0;
 		m_Team = TEAM_SPECTATORS;
+		m_SaveFlags = 0;
 
 		m_aMining[JOB_LEVEL].init("Level", "Miner level");
 		m_aMining[JOB_EXPERIENCE].init("Exp", "Miner experience");
@@ -99,9 +99,9 @@ void CAccountMinerCore::OnInitAccount(CPlayer* pPlayer)
 	SJK.ID("tw_accounts_mining", "(UserID) VALUES ('%d')", pPlayer->Acc().m_UserID);
 }
 
-void CAccountMinerCore::OnInitWorld(const char* pWhereLocalWorld)
+void CAccountMinerCore::OnInit()
 {
-	ResultPtr pRes = SJK.SD("*", "tw_positions_mining", pWhereLocalWorld);
+	ResultPtr pRes = SJK.SD("*", "tw_positions_mining");
 	while (pRes->next())
 	{
 		const int ID = pRes->getInt("ID");
@@ -23,7 +23,7 @@ class CAccountMinerCore : public MmoComponent
 	static std::map < int, StructOres > ms_aOre;
 
 	void OnInitAccount(CPlayer* pPlayer) override;
-	void OnInitWorld(const char* pWhereLocalWorld) override;
+	void OnInit() override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 
 public:
@@ -9,9 +9,9 @@
 
 std::map < int , CAccountPlantCore::StructPlants > CAccountPlantCore::ms_aPlants;
 
-void CAccountPlantCore::OnInitWorld(const char* pWhereLocalWorld)
+void CAccountPlantCore::OnInit()
 {
-	ResultPtr pRes = SJK.SD("*", "tw_positions_farming", pWhereLocalWorld);
+	ResultPtr pRes = SJK.SD("*", "tw_positions_farming");
 	while(pRes->next())
 	{
 		const int ID = pRes->getInt("ID");
@@ -21,7 +21,7 @@ class CAccountPlantCore : public MmoComponent
 	};
 	static std::map < int, StructPlants > ms_aPlants;
 
-	void OnInitWorld(const char* pWhereLocalWorld) override;
+	void OnInit() override;
 	void OnInitAccount(CPlayer* pPlayer) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 
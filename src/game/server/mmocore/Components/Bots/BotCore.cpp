@@ -55,22 +55,40 @@ static void InitInformationBots()
 	}
 }
 
+// the bots of all worlds are loaded once by the main world, each world then only spawns its own
 void CBotCore::OnInit()
 {
 	InitInformationBots();
+	InitQuestBots();
+	InitNPCBots();
+	InitMobsBots();
 }
 
 void CBotCore::OnInitWorld(const char* pWhereLocalWorld)
 {
-	InitQuestBots(pWhereLocalWorld);
-	InitNPCBots(pWhereLocalWorld);
-	InitMobsBots(pWhereLocalWorld);
+	for(const auto& pNpc : NpcBotInfo::ms_aNpcBot)
+	{
+		if(pNpc.second.m_WorldID != GS()->GetWorldID())
+			continue;
+
+		for(int c = 0; c < pNpc.second.m_Number; c++)
+			GS()->CreateBot(TYPE_BOT_NPC, pNpc.second.m_BotID, pNpc.first);
+	}
+
+	for(const auto& pMob : MobBotInfo::ms_aMobBot)
+	{
+		if(pMob.second.m_WorldID != GS()->GetWorldID())
+			continue;
+
+		for(int c = 0; c < pMob.second.m_Number; c++)
+			GS()->CreateBot(TYPE_BOT_MOB, pMob.second.m_BotID, pMob.first);
+	}
 }
 
 // Initialization of quest bots
-void CBotCore::InitQuestBots(const char* pWhereLocalWorld)
+void CBotCore::InitQuestBots()
 {
-	ResultPtr pRes = SJK.SD("*", "tw_bots_quest", pWhereLocalWorld);
+	ResultPtr pRes = SJK.SD("*", "tw_bots_quest");
 	while(pRes->next())
 	{
 		const int MobID = (int)pRes->getInt("ID");
@@ -125,13 +143,12 @@ void CBotCore::InitQuestBots(const char* pWhereLocalWorld)
 }
 
 // Initialization of NPC bots
-void CBotCore::InitNPCBots(const char* pWhereLocalWorld)
+void CBotCore::InitNPCBots()
 {
-	ResultPtr pRes = SJK.SD("*", "tw_bots_npc", pWhereLocalWorld);
+	ResultPtr pRes = SJK.SD("*", "tw_bots_npc");
 	while(pRes->next())
 	{
 		const int MobID = (int)pRes->getInt("ID");
-		const int NumberOfNpc = pRes->getInt("Number");
 		std::string DialogJsonStr = pRes->getString("DialogData").c_str();
 
 		NpcBotInfo::ms_aNpcBot[MobID].m_WorldID = pRes->getInt("WorldID");
@@ -141,10 +158,9 @@ void CBotCore::InitNPCBots(const char* pWhereLocalWorld)
 		NpcBotInfo::ms_aNpcBot[MobID].m_BotID = pRes->getInt("BotID");
 		NpcBotInfo::ms_aNpcBot[MobID].m_Function = pRes->getInt("Function");
 		NpcBotInfo::ms_aNpcBot[MobID].m_GivesQuestID = pRes->getInt("GivesQuestID");
+		NpcBotInfo::ms_aNpcBot[MobID].m_Number = pRes->getInt("Number");
 		if(NpcBotInfo::ms_aNpcBot[MobID].m_GivesQuestID > 0)
 			NpcBotInfo::ms_aNpcBot[MobID].m_Function = FUNCTION_NPC_GIVE_QUEST;
-		for(int c = 0; c < NumberOfNpc; c++)
-			GS()->CreateBot(TYPE_BOT_NPC, NpcBotInfo::ms_aNpcBot[MobID].m_BotID, MobID);
 
 		// load dialog
 		try
@@ -171,15 +187,14 @@ void CBotCore::InitNPCBots(const char* pWhereLocalWorld)
 }
 
 // Initialization of mobs bots
-void CBotCore::InitMobsBots(const char* pWhereLocalWorld)
+void CBotCore::InitMobsBots()
 {
-	ResultPtr pRes = SJK.SD("*", "tw_bots_mobs", pWhereLocalWorld);
+	ResultPtr pRes = SJK.SD("*", "tw_bots_mobs");
 	while(pRes->next())
 	{
 		const int MobID = (int)pRes->getInt("ID");
 		const int BotID = pRes->getInt("BotID");
-		const int NumberOfMobs = pRes->getInt("Number");
-		
+
 		MobBotInfo::ms_aMobBot[MobID].m_WorldID = pRes->getInt("WorldID");
 		MobBotInfo::ms_aMobBot[MobID].m_Position = vec2(pRes->getInt("PositionX"), pRes->getInt("PositionY"));
 		MobBotInfo::ms_aMobBot[MobID].m_Power = pRes->getInt("Power");
@@ -188,6 +203,7 @@ void CBotCore::InitMobsBots(const char* pWhereLocalWorld)
 		MobBotInfo::ms_aMobBot[MobID].m_Level = pRes->getInt("Level");
 		MobBotInfo::ms_aMobBot[MobID].m_RespawnTick = pRes->getInt("Respawn");
 		MobBotInfo::ms_aMobBot[MobID].m_BotID = BotID;
+		MobBotInfo::ms_aMobBot[MobID].m_Number = pRes->getInt("Number");
 		str_copy(MobBotInfo::ms_aMobBot[MobID].m_aEffect, pRes->getString("Effect").c_str(), sizeof(MobBotInfo::ms_aMobBot[MobID].m_aEffect));
 		str_copy(MobBotInfo::ms_aMobBot[MobID].m_aBehavior, pRes->getString("Behavior").c_str(), sizeof(MobBotInfo::ms_aMobBot[MobID].m_aBehavior));
 
@@ -203,8 +219,6 @@ void CBotCore::InitMobsBots(const char* pWhereLocalWorld)
 		sscanf(pRes->getString("it_drop_chance").c_str(), "|%f|%f|%f|%f|%f|",
 			&MobBotInfo::ms_aMobBot[MobID].m_aRandomItem[0], &MobBotInfo::ms_aMobBot[MobID].m_aRandomItem[1], &MobBotInfo::ms_aMobBot[MobID].m_aRandomItem[2],
 			&MobBotInfo::ms_aMobBot[MobID].m_aRandomItem[3], &MobBotInfo::ms_aMobBot[MobID].m_aRandomItem[4]);
-		for(int c = 0; c < NumberOfMobs; c++)
-			GS()->CreateBot(TYPE_BOT_MOB, BotID, MobID);
 	}
 }
 
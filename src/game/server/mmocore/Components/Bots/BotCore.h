@@ -19,9 +19,9 @@ class CBotCore : public MmoComponent
 	void OnInit() override;
 	void OnInitWorld(const char* pWhereLocalWorld) override;
 
-	void InitQuestBots(const char* pWhereLocalWorld);
-	void InitNPCBots(const char* pWhereLocalWorld);
-	void InitMobsBots(const char* pWhereLocalWorld);
+	void InitQuestBots();
+	void InitNPCBots();
+	void InitMobsBots();
 
 public:
 	void ProcessingTalkingNPC(int OwnID, int TalkingID, const char* Message, int Emote, int TalkedFlag = TALKED_FLAG_FULL) const;
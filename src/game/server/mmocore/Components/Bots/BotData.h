@@ -52,6 +52,7 @@ struct NpcBotInfo
 	int m_BotID;
 	int m_Function;
 	int m_GivesQuestID;
+	int m_Number;
 	std::vector<DialogData> m_aDialog;
 
 	static bool IsNpcBotValid(int MobID)
@@ -123,6 +124,7 @@ struct MobBotInfo
 	int m_aValueItem[MAX_DROPPED_FROM_MOBS];
 	float m_aRandomItem[MAX_DROPPED_FROM_MOBS];
 	int m_BotID;
+	int m_Number;
 
 	static bool IsMobBotValid(int MobID)
 	{
@@ -17,8 +17,11 @@ GuildDoor::~GuildDoor() {}
 
 void GuildDoor::Tick()
 {
-	for(CCharacter* pChar = (CCharacter*)GameWorld()->FindFirst(CGameWorld::ENTTYPE_CHARACTER); pChar; pChar = (CCharacter*)pChar->TypeNext())
+	CCharacter *apEnts[MAX_CLIENTS];
+	const int Num = GameWorld()->FindEntitiesOnLine(m_Pos, m_PosTo, (float)g_Config.m_SvDoorRadiusHit, (CEntity**)apEnts, MAX_CLIENTS, CGameWorld::ENTTYPE_CHARACTER);
+	for(int i = 0; i < Num; i++)
 	{
+		CCharacter* pChar = apEnts[i];
 		CPlayer* pPlayer = pChar->GetPlayer();
 		if(m_GuildID == pPlayer->Acc().m_GuildID)
 			continue;
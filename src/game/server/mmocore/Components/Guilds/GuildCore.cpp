@@ -489,7 +489,7 @@ bool GuildCore::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int Vote
 		if(pPlayer->SpendCurrency(Get))
 		{
 			AddMoneyBank(GuildID, Get);
-			SJK.UD("tw_accounts_data", "GuildDeposit = GuildDeposit + '%d' WHERE ID = '%d'", Get, pPlayer->Acc().m_UserID);
+			SJK.UD("tw_accounts_data", "GuildDeposit = GuildDeposit + ? WHERE ID = ?", CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(Get).Int(pPlayer->Acc().m_UserID));
 			GS()->ChatGuild(GuildID, "{STR} deposit in treasury {INT}gold.", Server()->ClientName(ClientID), Get);
 			AddHistoryGuild(GuildID, "'%s' added to bank %dgold.", Server()->ClientName(ClientID), Get);
 			GS()->StrongUpdateVotes(ClientID, MENU_GUILD);
@@ -761,7 +761,7 @@ void GuildCore::CreateGuild(CPlayer *pPlayer, const char *pGuildName)
 
 	// we check the availability of the guild's name
 	CSqlString<64> GuildName(pGuildName);
-	ResultPtr pRes = SJK.SD("ID", "tw_guilds", "WHERE Name = '%s'", GuildName.cstr());
+	ResultPtr pRes = SJK.SD("ID", "tw_guilds", "WHERE Name = ?", CSqlParams().String(GuildName.str()));
 	if(pRes->next())
 	{
 		GS()->Chat(ClientID, "This guild name already useds!");
@@ -779,22 +779,34 @@ void GuildCore::CreateGuild(CPlayer *pPlayer, const char *pGuildName)
 	ResultPtr pResID = SJK.SD("ID", "tw_guilds", "ORDER BY ID DESC LIMIT 1");
 	const int InitID = pResID->next() ? pResID->getInt("ID")+1 : 1; // TODO: thread save ? hm need for table all time auto increment = 1; NEED FIX IT -- use some kind of uuid
 
-	// initialize the guild
-	str_copy(CGuildData::ms_aGuild[InitID].m_aName, GuildName.cstr(), sizeof(CGuildData::ms_aGuild[InitID].m_aName));
-	CGuildData::ms_aGuild[InitID].m_UserID = pPlayer->Acc().m_UserID;
-	CGuildData::ms_aGuild[InitID].m_Level = 1;
-	CGuildData::ms_aGuild[InitID].m_Exp = 0;
-	CGuildData::ms_aGuild[InitID].m_Bank = 0;
-	CGuildData::ms_aGuild[InitID].m_Score = 0;
-	CGuildData::ms_aGuild[InitID].m_aUpgrade[CGuildData::AVAILABLE_SLOTS].m_Value = 2;
-	CGuildData::ms_aGuild[InitID].m_aUpgrade[CGuildData::CHAIR_EXPERIENCE].m_Value = 1;
-	pPlayer->Acc().m_GuildID = InitID;
-
 	// we create a guild in the table
-	SJK.ID("tw_guilds", "(ID, Name, UserID) VALUES ('%d', '%s', '%d')", InitID, GuildName.cstr(), pPlayer->Acc().m_UserID);
-	SJK.UDS(1000, "tw_accounts_data", "GuildID = '%d' WHERE ID = '%d'", InitID, pPlayer->Acc().m_UserID);
-	GS()->Chat(-1, "New guilds [{STR}] have been created!", GuildName.cstr());
-	GS()->StrongUpdateVotes(ClientID, MAIN_MENU);
+	const int UserID = pPlayer->Acc().m_UserID;
+	SJK.ID("tw_guilds", "(ID, Name, UserID) VALUES (?, ?, ?)", CSqlParams().Int(InitID).String(GuildName.str()).Int(UserID));
+	SJK.UDS(1000, "tw_accounts_data", "GuildID = '%d' WHERE ID = '%d'", InitID, UserID);
+
+	// the guilds are shared by the worlds, the new one is added when they are not ticking
+	const std::string Name = GuildName.str();
+	Server()->ExecuteOnMainThread([this, ClientID, UserID, InitID, Name]()
+	{
+		// initialize the guild
+		CGuildData& Guild = CGuildData::ms_aGuild[InitID];
+		str_copy(Guild.m_aName, Name.c_str(), sizeof(Guild.m_aName));
+		Guild.m_UserID = UserID;
+		Guild.m_Level = 1;
+		Guild.m_Exp = 0;
+		Guild.m_Bank = 0;
+		Guild.m_Score = 0;
+		Guild.m_aUpgrade[CGuildData::AVAILABLE_SLOTS].m_Value = 2;
+		Guild.m_aUpgrade[CGuildData::CHAIR_EXPERIENCE].m_Value = 1;
+		GS()->Chat(-1, "New guilds [{STR}] have been created!", Name.c_str());
+
+		CPlayer* pPlayer = GS()->GetPlayer(ClientID, true);
+		if(pPlayer && pPlayer->Acc().m_UserID == UserID)
+		{
+			pPlayer->Acc().m_GuildID = InitID;
+			GS()->StrongUpdateVotes(ClientID, MAIN_MENU);
+		}
+	});
 }
 
 void GuildCore::DisbandGuild(int GuildID)
@@ -829,7 +841,7 @@ void GuildCore::DisbandGuild(int GuildID)
 		GS()->ResetVotes(i, MAIN_MENU);
 	}
 	SJK.UD("tw_accounts_data", "GuildID = NULL, GuildRank = NULL, GuildDeposit = '0' WHERE GuildID = '%d'", GuildID);
-	CGuildData::ms_aGuild.erase(GuildID);
+	Server()->ExecuteOnMainThread([GuildID]() { CGuildData::ms_aGuild.erase(GuildID); });
 }
 
 bool GuildCore::JoinGuild(int AccountID, int GuildID)
@@ -860,7 +872,7 @@ bool GuildCore::JoinGuild(int AccountID, int GuildID)
 		pPlayer->Acc().m_GuildRank = 0;
 		GS()->ResetVotes(pPlayer->GetCID(), MAIN_MENU);
 	}
-	SJK.UD("tw_accounts_data", "GuildID = '%d', GuildRank = NULL WHERE ID = '%d'", GuildID, AccountID);
+	SJK.UD("tw_accounts_data", "GuildID = ?, GuildRank = NULL WHERE ID = ?", CSqlParams().OrderKey(AccountID).Int(GuildID).Int(AccountID));
 	GS()->ChatGuild(GuildID, "Player {STR} join in your guild!", pPlayerName);
 	return true;
 }
@@ -891,7 +903,7 @@ void GuildCore::ExitGuild(int AccountID)
 			pPlayer->Acc().m_GuildID = 0;
 			GS()->ResetVotes(pPlayer->GetCID(), MAIN_MENU);
 		}
-		SJK.UD("tw_accounts_data", "GuildID = NULL, GuildRank = NULL, GuildDeposit = '0' WHERE ID = '%d'", AccountID);
+		SJK.UD("tw_accounts_data", "GuildID = NULL, GuildRank = NULL, GuildDeposit = '0' WHERE ID = ?", CSqlParams().OrderKey(AccountID).Int(AccountID));
 	}
 }
 
@@ -977,7 +989,7 @@ void GuildCore::ShowGuildPlayers(CPlayer* pPlayer, int GuildID)
 	int HideID = NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 1000;
 
 	pPlayer->m_VoteColored = GOLDEN_COLOR;
-	GS()->AVL(ClientID, "null", "List players of {STR}", CGuildData::ms_aGuild[GuildID].m_aName);
+	GS()->AVL(ClientID, "null", "List players of {STR}", GuildName(GuildID));
 
 	ResultPtr pRes = SJK.SD("ID, Nick, GuildRank, GuildDeposit", "tw_accounts_data", "WHERE GuildID = '%d'", GuildID);
 	while (pRes->next())
@@ -1022,26 +1034,30 @@ void GuildCore::ShowGuildPlayers(CPlayer* pPlayer, int GuildID)
 
 void GuildCore::AddExperience(int GuildID)
 {
-	CGuildData::ms_aGuild[GuildID].m_Exp += 1;
-
-	bool UpdateTable = false;
-	int ExperienceNeed = computeExperience(CGuildData::ms_aGuild[GuildID].m_Level);
-	for( ; CGuildData::ms_aGuild[GuildID].m_Exp >= ExperienceNeed; )
+	// the members of the guild can be in different worlds
+	Server()->ExecuteOnMainThread([this, GuildID]()
 	{
-		CGuildData::ms_aGuild[GuildID].m_Exp -= ExperienceNeed;
-		CGuildData::ms_aGuild[GuildID].m_Level++;
+		CGuildData::ms_aGuild[GuildID].m_Exp += 1;
 
-		ExperienceNeed = computeExperience(CGuildData::ms_aGuild[GuildID].m_Level);
-		if(CGuildData::ms_aGuild[GuildID].m_Exp < ExperienceNeed)
-			UpdateTable = true;
+		bool UpdateTable = false;
+		int ExperienceNeed = computeExperience(CGuildData::ms_aGuild[GuildID].m_Level);
+		for( ; CGuildData::ms_aGuild[GuildID].m_Exp >= ExperienceNeed; )
+		{
+			CGuildData::ms_aGuild[GuildID].m_Exp -= ExperienceNeed;
+			CGuildData::ms_aGuild[GuildID].m_Level++;
 
-		GS()->Chat(-1, "Guild {STR} raised the level up to {INT}", CGuildData::ms_aGuild[GuildID].m_aName, CGuildData::ms_aGuild[GuildID].m_Level);
-		GS()->ChatDiscord(DC_SERVER_INFO, "Information", "Guild {STR} raised the level up to {INT}", CGuildData::ms_aGuild[GuildID].m_aName, CGuildData::ms_aGuild[GuildID].m_Level);
-		AddHistoryGuild(GuildID, "Guild raised level to '%d'.", CGuildData::ms_aGuild[GuildID].m_Level);
-	}
+			ExperienceNeed = computeExperience(CGuildData::ms_aGuild[GuildID].m_Level);
+			if(CGuildData::ms_aGuild[GuildID].m_Exp < ExperienceNeed)
+				UpdateTable = true;
 
-	if(random_int()%10 == 2 || UpdateTable)
-		SJK.UD("tw_guilds", "Level = '%d', Experience = '%d' WHERE ID = '%d'", CGuildData::ms_aGuild[GuildID].m_Level, CGuildData::ms_aGuild[GuildID].m_Exp, GuildID);
+			GS()->Chat(-1, "Guild {STR} raised the level up to {INT}", CGuildData::ms_aGuild[GuildID].m_aName, CGuildData::ms_aGuild[GuildID].m_Level);
+			GS()->ChatDiscord(DC_SERVER_INFO, "Information", "Guild {STR} raised the level up to {INT}", CGuildData::ms_aGuild[GuildID].m_aName, CGuildData::ms_aGuild[GuildID].m_Level);
+			AddHistoryGuild(GuildID, "Guild raised level to '%d'.", CGuildData::ms_aGuild[GuildID].m_Level);
+		}
+
+		if(random_int()%10 == 2 || UpdateTable)
+			SJK.UD("tw_guilds", "Level = '%d', Experience = '%d' WHERE ID = '%d'", CGuildData::ms_aGuild[GuildID].m_Level, CGuildData::ms_aGuild[GuildID].m_Exp, GuildID);
+	});
 }
 
 bool GuildCore::AddMoneyBank(int GuildID, int Money)
@@ -1147,7 +1163,7 @@ void GuildCore::AddRank(int GuildID, const char *Rank)
 	const int InitID = pResID->next() ? pResID->getInt("ID")+1 : 1; // thread save ? hm need for table all time auto increment = 1; NEED FIX IT
 
 	CSqlString<64> cGuildRank = CSqlString<64>(Rank);
-	SJK.ID("tw_guilds_ranks", "(ID, GuildID, Name) VALUES ('%d', '%d', '%s')", InitID, GuildID, cGuildRank.cstr());
+	SJK.ID("tw_guilds_ranks", "(ID, GuildID, Name) VALUES (?, ?, ?)", CSqlParams().Int(InitID).Int(GuildID).String(cGuildRank.str()));
 	GS()->ChatGuild(GuildID, "Creates new rank [{STR}]!", Rank);
 	AddHistoryGuild(GuildID, "Added new rank '%s'.", Rank);
 
@@ -1178,8 +1194,7 @@ void GuildCore::ChangeRank(int RankID, int GuildID, const char *NewRank)
 	if(CGuildRankData::ms_aRankGuild.find(RankID) != CGuildRankData::ms_aRankGuild.end())
 	{
 		CSqlString<64> cGuildRank = CSqlString<64>(NewRank);
-		SJK.UD("tw_guilds_ranks", "Name = '%s' WHERE ID = '%d' AND GuildID = '%d'",
-			cGuildRank.cstr(), RankID, GuildID);
+		SJK.UD("tw_guilds_ranks", "Name = ? WHERE ID = ? AND GuildID = ?", CSqlParams().String(cGuildRank.str()).Int(RankID).Int(GuildID));
 		GS()->ChatGuild(GuildID, "Rank [{STR}] changes to [{STR}]", CGuildRankData::ms_aRankGuild[RankID].m_aRank, NewRank);
 		AddHistoryGuild(GuildID, "Rank '%s' changes to '%s'.", CGuildRankData::ms_aRankGuild[RankID].m_aRank, NewRank);
 		str_copy(CGuildRankData::ms_aRankGuild[RankID].m_aRank, NewRank, sizeof(CGuildRankData::ms_aRankGuild[RankID].m_aRank));
@@ -1209,7 +1224,7 @@ void GuildCore::ChangePlayerRank(int AccountID, int RankID)
 	if(pPlayer)
 		pPlayer->Acc().m_GuildRank = RankID;
 
-	SJK.UD("tw_accounts_data", "GuildRank = '%d' WHERE ID = '%d'", RankID, AccountID);
+	SJK.UD("tw_accounts_data", "GuildRank = ? WHERE ID = ?", CSqlParams().OrderKey(AccountID).Int(RankID).Int(AccountID));
 }
 
 // rank menu display
@@ -1267,6 +1282,10 @@ void GuildCore::SendInviteGuild(int GuildID, CPlayer *pPlayer)
 		return;
 	}
 
+	// the guild is selected from the list, it may be disbanded already
+	if(CGuildData::ms_aGuild.find(GuildID) == CGuildData::ms_aGuild.end())
+		return;
+
 	const int UserID = pPlayer->Acc().m_UserID;
 	ResultPtr pRes = SJK.SD("ID", "tw_guilds_invites", "WHERE GuildID = '%d' AND UserID = '%d'",  GuildID, UserID);
 	if(pRes->rowsCount() >= 1)
@@ -1283,49 +1302,63 @@ void GuildCore::SendInviteGuild(int GuildID, CPlayer *pPlayer)
 // show the invitation sheet to our guild
 void GuildCore::ShowInvitesGuilds(int ClientID, int GuildID)
 {
-	int HideID = NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 1900;
-	ResultPtr pRes = SJK.SD("*", "tw_guilds_invites", "WHERE GuildID = '%d'", GuildID);
-	while(pRes->next())
+	CPlayer* pPlayer = GS()->GetPlayer(ClientID, true);
+	if(!pPlayer)
+		return;
+
+	pPlayer->m_pMenuQuery = SJK.SDA("tw_guilds_invites.UserID, tw_accounts_data.Nick", "tw_guilds_invites", [this, ClientID](ResultPtr pRes)
 	{
-		const int SenderID = pRes->getInt("UserID");
-		const char *PlayerName = Job()->PlayerName(SenderID);
-		GS()->AVH(ClientID, HideID, LIGHT_BLUE_COLOR, "Sender {STR} to join guilds", PlayerName);
+		int HideID = NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 1900;
+		while(pRes->next())
 		{
-			GS()->AVM(ClientID, "MINVITEACCEPT", SenderID, HideID, "Accept {STR} to guild", PlayerName);
-			GS()->AVM(ClientID, "MINVITEREJECT", SenderID, HideID, "Reject {STR} to guild", PlayerName);
+			const int SenderID = pRes->getInt("UserID");
+			CSqlString<32> PlayerName(pRes->getString("Nick").c_str());
+			GS()->AVH(ClientID, HideID, LIGHT_BLUE_COLOR, "Sender {STR} to join guilds", PlayerName.str());
+			{
+				GS()->AVM(ClientID, "MINVITEACCEPT", SenderID, HideID, "Accept {STR} to guild", PlayerName.str());
+				GS()->AVM(ClientID, "MINVITEREJECT", SenderID, HideID, "Reject {STR} to guild", PlayerName.str());
+			}
+			HideID++;
 		}
-		HideID++;
-	}
-	GS()->AddVotesBackpage(ClientID);
+		GS()->AddVotesBackpage(ClientID);
+	}, "JOIN tw_accounts_data ON tw_accounts_data.ID = tw_guilds_invites.UserID WHERE tw_guilds_invites.GuildID = '%d'", GuildID);
 }
 
 // show the guild's top and call on them
 void GuildCore::ShowFinderGuilds(int ClientID)
 {
 	CPlayer* pPlayer = GS()->GetPlayer(ClientID, true);
+	if(!pPlayer)
+		return;
+
 	GS()->AVL(ClientID, "null", "You are not in guild!");
 	GS()->AV(ClientID, "null", "Use reason how Value.");
 	GS()->AV(ClientID, "null", "Example: Find guild: [], in reason name.");
 	GS()->AV(ClientID, "null");
 	GS()->AVM(ClientID, "MINVITENAME", 1, NOPE, "Find guild: {STR}", pPlayer->GetTempData().m_aGuildSearchBuf);
 
-	int HideID = NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 1800;
+	// the leader and the number of players are selected together with the guild
 	CSqlString<64> cGuildName = CSqlString<64>(pPlayer->GetTempData().m_aGuildSearchBuf);
-	ResultPtr pRes = SJK.SD("*", "tw_guilds", "WHERE Name LIKE '%%%s%%'", cGuildName.cstr());
-	while(pRes->next())
+	pPlayer->m_pMenuQuery = SJK.SDA("tw_guilds.ID, tw_guilds.Name, tw_guilds.AvailableSlots, IFNULL(tw_accounts_data.Nick, 'No found!') AS LeaderNick, "
+		"(SELECT COUNT(*) FROM tw_accounts_data AS Members WHERE Members.GuildID = tw_guilds.ID) AS PlayersCount", "tw_guilds", [this, ClientID](ResultPtr pRes)
 	{
-		const int GuildID = pRes->getInt("ID");
-		const int AvailableSlot = pRes->getInt("AvailableSlots");
-		const int PlayersCount = GetGuildPlayerValue(GuildID);
-		cGuildName = pRes->getString("Name").c_str();
-		GS()->AVH(ClientID, HideID, LIGHT_BLUE_COLOR, "{STR} : Leader {STR} : Players [{INT}/{INT}]",
-			cGuildName.cstr(), Job()->PlayerName(CGuildData::ms_aGuild[GuildID].m_UserID), PlayersCount, AvailableSlot);
-		GS()->AVM(ClientID, "null", NOPE, HideID, "House: {STR} | Bank: {INT} gold", (GetGuildHouseID(GuildID) <= 0 ? "No" : "Yes"), CGuildData::ms_aGuild[GuildID].m_Bank);
-		GS()->AVM(ClientID, "MINVITEVIEWPLAYERS", GuildID, HideID, "View player list");
-		GS()->AVM(ClientID, "MINVITESEND", GuildID, HideID, "Send request to join {STR}", cGuildName.cstr());
-		HideID++;
-	}
-	GS()->AddVotesBackpage(ClientID);
+		int HideID = NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 1800;
+		while(pRes->next())
+		{
+			const int GuildID = pRes->getInt("ID");
+			const int AvailableSlot = pRes->getInt("AvailableSlots");
+			const int PlayersCount = pRes->getInt("PlayersCount");
+			CSqlString<64> cGuildName(pRes->getString("Name").c_str());
+			CSqlString<32> cLeaderName(pRes->getString("LeaderNick").c_str());
+			GS()->AVH(ClientID, HideID, LIGHT_BLUE_COLOR, "{STR} : Leader {STR} : Players [{INT}/{INT}]",
+				cGuildName.cstr(), cLeaderName.str(), PlayersCount, AvailableSlot);
+			GS()->AVM(ClientID, "null", NOPE, HideID, "House: {STR} | Bank: {INT} gold", (GetGuildHouseID(GuildID) <= 0 ? "No" : "Yes"), CGuildData::ms_aGuild[GuildID].m_Bank);
+			GS()->AVM(ClientID, "MINVITEVIEWPLAYERS", GuildID, HideID, "View player list");
+			GS()->AVM(ClientID, "MINVITESEND", GuildID, HideID, "Send request to join {STR}", cGuildName.cstr());
+			HideID++;
+		}
+		GS()->AddVotesBackpage(ClientID);
+	}, "LEFT JOIN tw_accounts_data ON tw_accounts_data.ID = tw_guilds.UserID WHERE tw_guilds.Name LIKE CONCAT('%', ?, '%')", CSqlParams().String(cGuildName.str()));
 }
 
 /* #########################################################################
@@ -1334,15 +1367,21 @@ void GuildCore::ShowFinderGuilds(int ClientID)
 // list of stories
 void GuildCore::ShowHistoryGuild(int ClientID, int GuildID)
 {
+	CPlayer* pPlayer = GS()->GetPlayer(ClientID, true);
+	if(!pPlayer)
+		return;
+
 	// looking for the entire history of the guild in the database
-	char aBuf[128];
-	ResultPtr pRes = SJK.SD("*", "tw_guilds_history", "WHERE GuildID = '%d' ORDER BY ID DESC LIMIT 20", GuildID);
-	while(pRes->next())
+	pPlayer->m_pMenuQuery = SJK.SDA("Time, Text", "tw_guilds_history", [this, ClientID](ResultPtr pRes)
 	{
-		str_format(aBuf, sizeof(aBuf), "[%s] %s", pRes->getString("Time").c_str(), pRes->getString("Text").c_str());
-		GS()->AVM(ClientID, "null", NOPE, NOPE, "{STR}", aBuf);
-	}
-	GS()->AddVotesBackpage(ClientID);
+		char aBuf[128];
+		while(pRes->next())
+		{
+			str_format(aBuf, sizeof(aBuf), "[%s] %s", pRes->getString("Time").c_str(), pRes->getString("Text").c_str());
+			GS()->AVM(ClientID, "null", NOPE, NOPE, "{STR}", aBuf);
+		}
+		GS()->AddVotesBackpage(ClientID);
+	}, "WHERE GuildID = '%d' ORDER BY ID DESC LIMIT 20", GuildID);
 }
 
 // add to the guild history
@@ -1359,7 +1398,7 @@ void GuildCore::AddHistoryGuild(int GuildID, const char *Buffer, ...)
 	va_end(VarArgs);
 
 	CSqlString<64> cBuf = CSqlString<64>(aBuf);
-	SJK.ID("tw_guilds_history", "(GuildID, Text) VALUES ('%d', '%s')", GuildID, cBuf.cstr());
+	SJK.ID("tw_guilds_history", "(GuildID, Text) VALUES (?, ?)", CSqlParams().Int(GuildID).String(cBuf.str()));
 }
 
 /* #########################################################################
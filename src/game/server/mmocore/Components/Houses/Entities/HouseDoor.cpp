@@ -15,8 +15,11 @@ HouseDoor::HouseDoor(CGameWorld* pGameWorld, vec2 Pos)
 
 void HouseDoor::Tick()
 {
-	for(CCharacter* pChar = (CCharacter*)GameWorld()->FindFirst(CGameWorld::ENTTYPE_CHARACTER); pChar; pChar = (CCharacter*)pChar->TypeNext())
+	CCharacter *apEnts[MAX_CLIENTS];
+	const int Num = GameWorld()->FindEntitiesOnLine(m_Pos, m_PosTo, (float)g_Config.m_SvDoorRadiusHit, (CEntity**)apEnts, MAX_CLIENTS, CGameWorld::ENTTYPE_CHARACTER);
+	for(int i = 0; i < Num; i++)
 	{
+		CCharacter* pChar = apEnts[i];
 		vec2 IntersectPos = closest_point_on_line(m_Pos, m_PosTo, pChar->m_Core.m_Pos);
 		const float Distance = distance(IntersectPos, pChar->m_Core.m_Pos);
 		if(Distance <= g_Config.m_SvDoorRadiusHit)
@@ -11,6 +11,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
\ No newline at end of file
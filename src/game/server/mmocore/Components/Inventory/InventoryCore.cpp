@@ -73,19 +73,20 @@ void CInventoryCore::OnInitAccount(CPlayer *pPlayer)
 	ResultPtr pRes = SJK.SD("*", "tw_accounts_items", "WHERE UserID = '%d'", pPlayer->Acc().m_UserID);
 	while(pRes->next())
 	{
-		int ItemID = (int)pRes->getInt("ItemID");
-		CItemData::ms_aItems[ClientID][ItemID].SetItemOwner(pPlayer);
-		CItemData::ms_aItems[ClientID][ItemID].m_ItemID = ItemID;
-		CItemData::ms_aItems[ClientID][ItemID].m_Value = (int)pRes->getInt("Value");
-		CItemData::ms_aItems[ClientID][ItemID].m_Settings = (int)pRes->getInt("Settings");
-		CItemData::ms_aItems[ClientID][ItemID].m_Enchant = (int)pRes->getInt("Enchant");
-		CItemData::ms_aItems[ClientID][ItemID].m_Durability = (int)pRes->getInt("Durability");
+		CItemData& Item = CItemData::ms_aItems[ClientID][(int)pRes->getInt("ItemID")];
+		Item.SetItemOwner(pPlayer);
+		Item.m_Value = (int)pRes->getInt("Value");
+		Item.m_Settings = (int)pRes->getInt("Settings");
+		Item.m_Enchant = (int)pRes->getInt("Enchant");
+		Item.m_Durability = (int)pRes->getInt("Durability");
+		Item.m_Stored = true;
 	}
+	pPlayer->InvalidateItemsAttributes();
 }
 
 void CInventoryCore::OnResetClient(int ClientID)
 {
-	CItemData::ms_aItems.erase(ClientID);
+	CItemData::ms_aItems[ClientID].Clear();
 }
 
 bool CInventoryCore::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu)
@@ -150,12 +151,12 @@ bool CInventoryCore::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Repla
 		GS()->AV(ClientID, "null");
 
 		bool FindItem = false;
-		for(const auto& it : CItemData::ms_aItems[ClientID])
+		for(const CItemData& Item : CItemData::ms_aItems[ClientID])
 		{
-			if(!it.second.m_Value || it.second.Info().m_Function != pPlayer->m_aSortTabs[SORT_EQUIPING])
+			if(!Item.m_Value || Item.Info().m_Function != pPlayer->m_aSortTabs[SORT_EQUIPING])
 				continue;
 
-			ItemSelected(pPlayer, it.second, true);
+			ItemSelected(pPlayer, Item, true);
 			FindItem = true;
 		}
 
@@ -275,9 +276,9 @@ bool CInventoryCore::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, con
 void CInventoryCore::RepairDurabilityItems(CPlayer *pPlayer)
 {
 	const int ClientID = pPlayer->GetCID();
-	SJK.UD("tw_accounts_items", "Durability = '100' WHERE UserID = '%d'", pPlayer->Acc().m_UserID);
-	for(auto& it : CItemData::ms_aItems[ClientID])
-		it.second.m_Durability = 100;
+	SJK.UD("tw_accounts_items", "Durability = '100' WHERE UserID = ?", CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(pPlayer->Acc().m_UserID));
+	for(CItemData& Item : CItemData::ms_aItems[ClientID])
+		Item.m_Durability = 100;
 }
 
 void CInventoryCore::ListInventory(CPlayer *pPlayer, int TypeList, bool SortedFunction)
@@ -287,13 +288,13 @@ void CInventoryCore::ListInventory(CPlayer *pPlayer, int TypeList, bool SortedFu
 
 	// show a list of items to the player
 	bool Found = false;
-	for(const auto& it : CItemData::ms_aItems[ClientID])
+	for(const CItemData& Item : CItemData::ms_aItems[ClientID])
 	{
-		if(!it.second.m_Value || ((SortedFunction && it.second.Info().m_Function != TypeList)
-			|| (!SortedFunction && it.second.Info().m_Type != TypeList)))
+		if(!Item.m_Value || ((SortedFunction && Item.Info().m_Function != TypeList)
+			|| (!SortedFunction && Item.Info().m_Type != TypeList)))
 			continue;
 
-		ItemSelected(pPlayer, it.second);
+		ItemSelected(pPlayer, Item);
 		Found = true;
 	}
 	if(!Found)
@@ -302,12 +303,15 @@ void CInventoryCore::ListInventory(CPlayer *pPlayer, int TypeList, bool SortedFu
 
 int CInventoryCore::GiveItem(CPlayer *pPlayer, int ItemID, int Value, int Settings, int Enchant)
 {
-	const int ClientID = pPlayer->GetCID();
+	// the item in memory is the actual one, the whole row is written together with the pending changes
 	const int SecureID = SecureCheck(pPlayer, ItemID, Value, Settings, Enchant);
+	pPlayer->InvalidateItemsAttributes();
 	if(SecureID == 1)
 	{
-		SJK.UD("tw_accounts_items", "Value = '%d', Settings = '%d', Enchant = '%d' WHERE ItemID = '%d' AND UserID = '%d'",
-		       CItemData::ms_aItems[ClientID][ItemID].m_Value, CItemData::ms_aItems[ClientID][ItemID].m_Settings, CItemData::ms_aItems[ClientID][ItemID].m_Enchant, ItemID, pPlayer->Acc().m_UserID);
+		pPlayer->Acc().m_aSaveItems.erase(ItemID);
+		const CItemData &Item = CItemData::ms_aItems[pPlayer->GetCID()][ItemID];
+		SJK.UD("tw_accounts_items", "Value = ?, Settings = ?, Enchant = ?, Durability = ? WHERE ItemID = ? AND UserID = ?",
+			CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(Item.m_Value).Int(Item.m_Settings).Int(Item.m_Enchant).Int(Item.m_Durability).Int(ItemID).Int(pPlayer->Acc().m_UserID));
 	}
 	return SecureID;
 }
@@ -315,63 +319,66 @@ int CInventoryCore::GiveItem(CPlayer *pPlayer, int ItemID, int Value, int Settin
 int CInventoryCore::SecureCheck(CPlayer *pPlayer, int ItemID, int Value, int Settings, int Enchant)
 {
 	// check initialize and add the item
-	const int ClientID = pPlayer->GetCID();
-	ResultPtr pRes = SJK.SD("Value, Settings", "tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, pPlayer->Acc().m_UserID);
-	if(pRes->next())
+	CItemData &Item = CItemData::ms_aItems[pPlayer->GetCID()][ItemID];
+	if(Item.m_Stored)
 	{
-		CItemData::ms_aItems[ClientID][ItemID].m_Value = pRes->getInt("Value")+Value;
-		CItemData::ms_aItems[ClientID][ItemID].m_Settings = pRes->getInt("Settings")+Settings;
-		CItemData::ms_aItems[ClientID][ItemID].m_Enchant = Enchant;
+		Item.m_Value += Value;
+		Item.m_Settings += Settings;
+		Item.m_Enchant = Enchant;
 		return 1;
 	}
 
 	// create an object if not found
-	CItemData::ms_aItems[ClientID][ItemID].m_Value = Value;
-	CItemData::ms_aItems[ClientID][ItemID].m_Settings = Settings;
-	CItemData::ms_aItems[ClientID][ItemID].m_Enchant = Enchant;
-	CItemData::ms_aItems[ClientID][ItemID].m_Durability = 100;
-	SJK.ID("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES ('%d', '%d', '%d', '%d', '%d')",
-		ItemID, pPlayer->Acc().m_UserID, Value, Settings, Enchant);
+	Item.m_Value = Value;
+	Item.m_Settings = Settings;
+	Item.m_Enchant = Enchant;
+	Item.m_Durability = 100;
+	Item.m_Stored = true;
+	SJK.ID("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES (?, ?, ?, ?, ?)",
+		CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(ItemID).Int(pPlayer->Acc().m_UserID).Int(Value).Int(Settings).Int(Enchant));
 	return 2;
 }
 
 int CInventoryCore::RemoveItem(CPlayer *pPlayer, int ItemID, int Value, int Settings)
 {
 	const int SecureID = DeSecureCheck(pPlayer, ItemID, Value, Settings);
+	pPlayer->InvalidateItemsAttributes();
+	pPlayer->Acc().m_aSaveItems.erase(ItemID);
 	if(SecureID == 1)
 	{
-		SJK.UD("tw_accounts_items", "Value = Value - '%d', Settings = Settings - '%d' WHERE ItemID = '%d' AND UserID = '%d'",
-			Value, Settings, ItemID, pPlayer->Acc().m_UserID);
+		const CItemData &Item = CItemData::ms_aItems[pPlayer->GetCID()][ItemID];
+		SJK.UD("tw_accounts_items", "Value = ?, Settings = ?, Enchant = ?, Durability = ? WHERE ItemID = ? AND UserID = ?",
+			CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(Item.m_Value).Int(Item.m_Settings).Int(Item.m_Enchant).Int(Item.m_Durability).Int(ItemID).Int(pPlayer->Acc().m_UserID));
 	}
 	return SecureID;
 }
 
 int CInventoryCore::DeSecureCheck(CPlayer *pPlayer, int ItemID, int Value, int Settings)
 {
-	// we check the database
-	const int ClientID = pPlayer->GetCID();
-	ResultPtr pRes = SJK.SD("Value, Settings", "tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, pPlayer->Acc().m_UserID);
-	if(pRes->next())
+	// the item in memory is checked
+	CItemData &Item = CItemData::ms_aItems[pPlayer->GetCID()][ItemID];
+	if(Item.m_Stored)
 	{
 		// update if there is more
-		if(pRes->getInt("Value") > Value)
+		if(Item.m_Value > Value)
 		{
-			CItemData::ms_aItems[ClientID][ItemID].m_Value = pRes->getInt("Value")-Value;
-			CItemData::ms_aItems[ClientID][ItemID].m_Settings = pRes->getInt("Settings")-Settings;
+			Item.m_Value -= Value;
+			Item.m_Settings -= Settings;
 			return 1;
 		}
 
 		// remove the object if it is less than the required amount
-		CItemData::ms_aItems[ClientID][ItemID].m_Value = 0;
-		CItemData::ms_aItems[ClientID][ItemID].m_Settings = 0;
-		CItemData::ms_aItems[ClientID][ItemID].m_Enchant = 0;
-		SJK.DD("tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, pPlayer->Acc().m_UserID);
+		Item.m_Value = 0;
+		Item.m_Settings = 0;
+		Item.m_Enchant = 0;
+		Item.m_Stored = false;
+		SJK.DD("tw_accounts_items", "WHERE ItemID = ? AND UserID = ?", CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(ItemID).Int(pPlayer->Acc().m_UserID));
 		return 2;
 	}
 
-	CItemData::ms_aItems[ClientID][ItemID].m_Value = 0;
-	CItemData::ms_aItems[ClientID][ItemID].m_Settings = 0;
-	CItemData::ms_aItems[ClientID][ItemID].m_Enchant = 0;
+	Item.m_Value = 0;
+	Item.m_Settings = 0;
+	Item.m_Enchant = 0;
 	return 0;
 }
 
@@ -467,8 +474,8 @@ void CInventoryCore::ItemSelected(CPlayer* pPlayer, const CItemData& pItemPlayer
 int CInventoryCore::GetValueItemsType(CPlayer *pPlayer, int Type) const
 {
 	const int ClientID = pPlayer->GetCID();
-	return (int)std::count_if(CItemData::ms_aItems[ClientID].begin(), CItemData::ms_aItems[ClientID].end(), [Type](std::pair< const int, CItemData>& pItem)
-	                          {return pItem.second.m_Value > 0 && pItem.second.Info().m_Type == Type; });
+	return (int)std::count_if(CItemData::ms_aItems[ClientID].begin(), CItemData::ms_aItems[ClientID].end(), [Type](const CItemData& Item)
+	                          {return Item.m_Value > 0 && Item.Info().m_Type == Type; });
 }
 
 // TODO: FIX IT (lock .. unlock)
@@ -489,15 +496,15 @@ void CInventoryCore::AddItemSleep(int AccountID, int ItemID, int Value, int Mill
 			return;
 		}
 
-		ResultPtr pRes = SJK.SD("Value", "tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, AccountID);
+		// the value is added in the query, the queued writes of the account may not be done yet
+		ResultPtr pRes = SJK.SD("ID", "tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, AccountID);
 		if(pRes->next())
 		{
-			const int ReallyValue = (int)pRes->getInt("Value") + Value;
-			SJK.UD("tw_accounts_items", "Value = '%d' WHERE UserID = '%d' AND ItemID = '%d'", ReallyValue, AccountID, ItemID);
+			SJK.UD("tw_accounts_items", "Value = Value + ? WHERE UserID = ? AND ItemID = ?", CSqlParams().OrderKey(AccountID).Int(Value).Int(AccountID).Int(ItemID));
 			lock_sleep.unlock();
 			return;
 		}
-		SJK.ID("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES ('%d', '%d', '%d', '0', '0')", ItemID, AccountID, Value);
+		SJK.ID("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES (?, ?, ?, '0', '0')", CSqlParams().OrderKey(AccountID).Int(ItemID).Int(AccountID).Int(Value));
 		lock_sleep.unlock();
 	});
 	Thread.detach();
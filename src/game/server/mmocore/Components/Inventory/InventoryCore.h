@@ -11,7 +11,8 @@ class CInventoryCore : public MmoComponent
 	~CInventoryCore() override
 	{
 		CItemDataInfo::ms_aItemsInfo.clear();
-		CItemData::ms_aItems.clear();
+		for(CItemStorage& Items : CItemData::ms_aItems)
+			Items.Clear();
 	};
 
 	void OnPrepareInformation(class IStorageEngine* pStorage, class CDataFileWriter* pDataFile) override;
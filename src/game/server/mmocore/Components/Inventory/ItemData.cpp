@@ -8,7 +8,7 @@
 
 #include "RandomBox.h"
 
-std::map < int, std::map < int, CItemData > > CItemData::ms_aItems;
+CItemStorage CItemData::ms_aItems[MAX_CLIENTS];
 inline int randomRangecount(int startrandom, int endrandom, int count)
 {
 	int result = 0;
@@ -20,10 +20,14 @@ inline int randomRangecount(int startrandom, int endrandom, int count)
 	return result;
 }
 
+CGS* CItemData::GS() const
+{
+	return m_pPlayer->GS();
+}
+
 void CItemData::SetItemOwner(CPlayer* pPlayer)
 {
 	m_pPlayer = pPlayer;
-	m_pGS = m_pPlayer->GS();
 }
 
 bool CItemData::SetEnchant(int Enchant)
@@ -55,7 +59,7 @@ bool CItemData::SetDurability(int Durability)
 
 bool CItemData::Add(int Value, int Settings, int Enchant, bool Message)
 {
-	if(Value < 1 || !m_pPlayer || !m_pPlayer->IsAuthed())
+	if(Value < 1 || !m_pPlayer || !m_pPlayer->IsAuthed() || !CItemDataInfo::IsValid(m_ItemID))
 		return false;
 
 	const int ClientID = m_pPlayer->GetCID();
@@ -98,7 +102,7 @@ bool CItemData::Add(int Value, int Settings, int Enchant, bool Message)
 bool CItemData::Remove(int Value, int Settings)
 {
 	Value = min(Value, m_Value);
-	if(Value <= 0 || !m_pPlayer)
+	if(Value <= 0 || !m_pPlayer || !CItemDataInfo::IsValid(m_ItemID))
 		return false;
 
 	if(IsEquipped())
@@ -114,6 +118,7 @@ bool CItemData::Equip()
 		return false;
 
 	m_Settings ^= true;
+	m_pPlayer->InvalidateItemsAttributes();
 
 	if(Info().m_Type == TYPE_EQUIP)
 	{
@@ -269,13 +274,23 @@ bool CItemData::Drop(int Value)
 	return false;
 }
 
+// the item is only marked, it will be written by MmoController::FlushAccount
 bool CItemData::Save() const
 {
 	if(m_pPlayer && m_pPlayer->IsAuthed())
 	{
-		SJK.UD("tw_accounts_items", "Value = '%d', Settings = '%d', Enchant = '%d', Durability = '%d' WHERE UserID = '%d' AND ItemID = '%d'",
-			m_Value, m_Settings, m_Enchant, m_Durability, m_pPlayer->Acc().m_UserID, m_ItemID);
+		m_pPlayer->InvalidateItemsAttributes();
+		m_pPlayer->Acc().m_aSaveItems.insert(m_ItemID);
 		return true;
 	}
 	return false;
 }
+
+void CItemData::Flush() const
+{
+	if(!m_pPlayer || !m_pPlayer->IsAuthed() || m_pPlayer->Acc().m_aSaveItems.erase(m_ItemID) == 0)
+		return;
+
+	SJK.UD("tw_accounts_items", "Value = ?, Settings = ?, Enchant = ?, Durability = ? WHERE UserID = ? AND ItemID = ?",
+		CSqlParams().OrderKey(m_pPlayer->Acc().m_UserID).Int(m_Value).Int(m_Settings).Int(m_Enchant).Int(m_Durability).Int(m_pPlayer->Acc().m_UserID).Int(m_ItemID));
+}
@@ -2,13 +2,16 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #ifndef GAME_SERVER_COMPONENT_ITEM_DATA_H
 #define GAME_SERVER_COMPONENT_ITEM_DATA_H
+#include <engine/shared/protocol.h>
+
 #include "ItemInfoData.h"
 
+#include <deque>
+
 class CItemData
 {
-	class CGS* m_pGS;
 	class CPlayer* m_pPlayer;
-	class CGS* GS() const { return m_pGS; }
+	class CGS* GS() const;
 
 public:
 	int m_ItemID;
@@ -16,6 +19,7 @@ public:
 	int m_Settings;
 	int m_Enchant;
 	int m_Durability;
+	bool m_Stored; // the row of the item exists in the database
 
 	CItemDataInfo& Info() const { return CItemDataInfo::ms_aItemsInfo[m_ItemID]; }
 	int GetID() const { return m_ItemID; }
@@ -31,6 +35,7 @@ public:
 	bool Equip();
 	bool Use(int Value);
 	bool Drop(int Value);
+	void Flush() const;
 
 	// equip modules types functions
 	int GetEnchantStats(int AttributeID) const { return Info().GetInfoEnchantStats(AttributeID, m_Enchant); }
@@ -46,7 +51,39 @@ private:
 	bool Save() const;
 
 public:
-	static std::map < int, std::map < int, CItemData > > ms_aItems;
+	static class CItemStorage ms_aItems[MAX_CLIENTS];
+};
+
+// items of a client indexed by item id, slots are only appended so references to items stay valid
+class CItemStorage
+{
+	std::deque<CItemData> m_aItems;
+	CItemData m_EmptyItem;
+
+public:
+	CItemData& operator[](int ItemID)
+	{
+		// lookups of a missing item (id -1) or of an id that is not an item get a blank item,
+		// so the table only grows up to the largest id of the items
+		if(ItemID < 0 || (ItemID >= (int)m_aItems.size() && !CItemDataInfo::IsValid(ItemID)))
+		{
+			m_EmptyItem = CItemData();
+			m_EmptyItem.m_ItemID = ItemID;
+			return m_EmptyItem;
+		}
+
+		while((int)m_aItems.size() <= ItemID)
+		{
+			m_aItems.emplace_back();
+			m_aItems.back().m_ItemID = (int)m_aItems.size() - 1;
+		}
+		return m_aItems[ItemID];
+	}
+
+	// untouched slots have no value, loops skip them before reading the item information
+	std::deque<CItemData>::iterator begin() { return m_aItems.begin(); }
+	std::deque<CItemData>::iterator end() { return m_aItems.end(); }
+	void Clear() { m_aItems.clear(); }
 };
 
 #endif
\ No newline at end of file
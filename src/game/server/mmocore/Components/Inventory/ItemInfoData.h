@@ -27,6 +27,7 @@ public:
 	void FormatEnchantLevel(char* pBuffer, int Size, int Enchant) const;
 
 	static std::map< int, CItemDataInfo > ms_aItemsInfo;
+	static bool IsValid(int ItemID) { return ms_aItemsInfo.find(ItemID) != ms_aItemsInfo.end(); }
 };
 
 #endif
\ No newline at end of file
@@ -47,6 +47,7 @@ public:
 	std::vector<StructRandomItem>::iterator SelectRandomItem();
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
\ No newline at end of file
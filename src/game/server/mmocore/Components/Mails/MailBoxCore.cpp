@@ -84,7 +84,7 @@ void CMailBoxCore::SendInbox(const char* pFrom, int AccountID, const char* pName
 	const CSqlString<64> cFrom = CSqlString<64>(pFrom);
 
 	// send information about new message
-	if(GS()->ChatAccount(AccountID, "[Mailbox] New letter ({STR})!", cName.cstr()))
+	if(GS()->ChatAccount(AccountID, "[Mailbox] New letter ({STR})!", cName.str()))
 	{
 		const int MailLettersSize = GetMailLettersSize(AccountID);
 		if(MailLettersSize >= (int)MAILLETTER_MAX_CAPACITY)
@@ -97,17 +97,18 @@ void CMailBoxCore::SendInbox(const char* pFrom, int AccountID, const char* pName
 	// send new message
 	if (ItemID <= 0)
 	{
-		SJK.ID("tw_accounts_mailbox", "(Name, Description, UserID, FromSend) VALUES ('%s', '%s', '%d', '%s');", cName.cstr(), cDesc.cstr(), AccountID, cFrom.cstr());
+		SJK.ID("tw_accounts_mailbox", "(Name, Description, UserID, FromSend) VALUES (?, ?, ?, ?);",
+			CSqlParams().String(cName.str()).String(cDesc.str()).Int(AccountID).String(cFrom.str()));
 		return;
 	}
-	SJK.ID("tw_accounts_mailbox", "(Name, Description, ItemID, ItemValue, Enchant, UserID, FromSend) VALUES ('%s', '%s', '%d', '%d', '%d', '%d', '%s');",
-		 cName.cstr(), cDesc.cstr(), ItemID, Value, Enchant, AccountID, cFrom.cstr());
+	SJK.ID("tw_accounts_mailbox", "(Name, Description, ItemID, ItemValue, Enchant, UserID, FromSend) VALUES (?, ?, ?, ?, ?, ?, ?);",
+		CSqlParams().String(cName.str()).String(cDesc.str()).Int(ItemID).Int(Value).Int(Enchant).Int(AccountID).String(cFrom.str()));
 }
 
 bool CMailBoxCore::SendInbox(const char* pFrom, const char* pNickname, const char* pName, const char* pDesc, int ItemID, int Value, int Enchant)
 {
 	const CSqlString<64> cName = CSqlString<64>(pNickname);
-	ResultPtr pRes = SJK.SD("ID, Nick", "tw_accounts_data", "WHERE Nick = '%s'", cName.cstr());
+	ResultPtr pRes = SJK.SD("ID, Nick", "tw_accounts_data", "WHERE Nick = ?", CSqlParams().String(cName.str()));
 	if(pRes->next())
 	{
 		const int AccountID = pRes->getInt("ID");
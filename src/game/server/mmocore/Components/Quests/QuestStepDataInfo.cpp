@@ -15,33 +15,39 @@
 // ################# GLOBAL STEP STRUCTURE ######################
 void CQuestStepDataInfo::UpdateBot(CGS* pGS)
 {
-	CGS* pBotGS = (CGS*)pGS->Server()->GameServer(m_Bot->m_WorldID);
-	if(!pBotGS)
-		return;
-
-	// check it's if there's a active bot
-	int BotClientID = -1;
-	for(int i = MAX_PLAYERS; i < MAX_CLIENTS; i++)
+	// the bot can be in another world, it is changed when the worlds are not ticking
+	// the step is copied because the player's steps can be cleared before that
+	const CQuestStepDataInfo Step = *this;
+	pGS->Server()->ExecuteOnMainThread([Step, pGS]()
 	{
-		if(!pBotGS->m_apPlayers[i] || pBotGS->m_apPlayers[i]->GetBotType() != BotsTypes::TYPE_BOT_QUEST || pBotGS->m_apPlayers[i]->GetBotSub() != m_Bot->m_SubBotID)
-			continue;
-		BotClientID = i;
-	}
+		CGS* pBotGS = (CGS*)pGS->Server()->GameServer(Step.m_Bot->m_WorldID);
+		if(!pBotGS)
+			return;
 
-	// seek if all players have an active bot
-	const bool ActiveStepBot = IsActiveStep(pGS);
-	if(ActiveStepBot && BotClientID <= -1)
-	{
-		//dbg_msg("quest sync", "quest to step bot active, but mob not found create");
-		pBotGS->CreateBot(BotsTypes::TYPE_BOT_QUEST, m_Bot->m_BotID, m_Bot->m_SubBotID);
-	}
-	// if the bot is not active for more than one player
-	if(!ActiveStepBot && BotClientID >= MAX_PLAYERS)
-	{
-		//dbg_msg("quest sync", "mob found, but quest to step not active on players");
-		delete pBotGS->m_apPlayers[BotClientID];
-		pBotGS->m_apPlayers[BotClientID] = nullptr;
-	}
+		// check it's if there's a active bot
+		int BotClientID = -1;
+		for(int i = MAX_PLAYERS; i < MAX_CLIENTS; i++)
+		{
+			if(!pBotGS->m_apPlayers[i] || pBotGS->m_apPlayers[i]->GetBotType() != BotsTypes::TYPE_BOT_QUEST || pBotGS->m_apPlayers[i]->GetBotSub() != Step.m_Bot->m_SubBotID)
+				continue;
+			BotClientID = i;
+		}
+
+		// seek if all players have an active bot
+		const bool ActiveStepBot = Step.IsActiveStep(pGS);
+		if(ActiveStepBot && BotClientID <= -1)
+		{
+			//dbg_msg("quest sync", "quest to step bot active, but mob not found create");
+			pBotGS->CreateBot(BotsTypes::TYPE_BOT_QUEST, Step.m_Bot->m_BotID, Step.m_Bot->m_SubBotID);
+		}
+		// if the bot is not active for more than one player
+		if(!ActiveStepBot && BotClientID >= MAX_PLAYERS)
+		{
+			//dbg_msg("quest sync", "mob found, but quest to step not active on players");
+			delete pBotGS->m_apPlayers[BotClientID];
+			pBotGS->m_apPlayers[BotClientID] = nullptr;
+		}
+	});
 }
 
 bool CQuestStepDataInfo::IsActiveStep(CGS* pGS) const
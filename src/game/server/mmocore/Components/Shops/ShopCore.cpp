@@ -28,6 +28,17 @@ void CShopCore::OnTick()
 	}
 }
 
+void CShopCore::OnWakeWorld(int SleptTicks)
+{
+	if(GS()->GetWorldID() != MAIN_WORLD_ID)
+		return;
+
+	// the periodic check was skipped while the world was dormant
+	const int Period = Server()->TickSpeed() * (g_Config.m_SvTimeCheckAuction * 60);
+	if(Server()->Tick() / Period != (Server()->Tick() - SleptTicks) / Period)
+		CheckAuctionTime();
+}
+
 bool CShopCore::OnHandleTile(CCharacter* pChr, int IndexCollision)
 {
 	CPlayer* pPlayer = pChr->GetPlayer();
@@ -298,46 +309,52 @@ void CShopCore::ShowAuction(CPlayer* pPlayer)
 	GS()->ShowVotesItemValueInformation(pPlayer);
 	GS()->AV(ClientID, "null");
 
-	bool FoundItems = false;
-	int HideID = (int)(NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 400);
-	ResultPtr pRes = SJK.SD("*", "tw_store_items", "WHERE UserID > 0 ORDER BY Price");
-	while(pRes->next())
+	pPlayer->m_pMenuQuery = SJK.SDA("tw_store_items.*, IFNULL(tw_accounts_data.Nick, 'No found!') AS Nick", "tw_store_items", [this, ClientID](ResultPtr pRes)
 	{
-		const int ID = pRes->getInt("ID");
-		const int ItemID = pRes->getInt("ItemID");
-		const int Price = pRes->getInt("Price");
-		const int Enchant = pRes->getInt("Enchant");
-		const int ItemValue = pRes->getInt("ItemValue");
-		const int UserID = pRes->getInt("UserID");
-		CItemDataInfo &pBuyightItem = GS()->GetItemInfo(ItemID);
+		CPlayer* pPlayer = GS()->GetPlayer(ClientID, true);
+		if(!pPlayer)
+			return;
 
-		if(pBuyightItem.IsEnchantable())
+		bool FoundItems = false;
+		int HideID = (int)(NUM_TAB_MENU + CItemDataInfo::ms_aItemsInfo.size() + 400);
+		while(pRes->next())
 		{
-			char aEnchantBuf[16];
-			pBuyightItem.FormatEnchantLevel(aEnchantBuf, sizeof(aEnchantBuf), Enchant);
-			GS()->AVHI(ClientID, pBuyightItem.GetIcon(), HideID, LIGHT_GRAY_COLOR, "{STR}{STR} {STR} - {INT} gold",
-				(pPlayer->GetItem(ItemID).m_Value > 0 ? "✔ " : "\0"), pBuyightItem.GetName(), (Enchant > 0 ? aEnchantBuf : "\0"), Price);
-
-			char aAttributes[128];
-			pBuyightItem.FormatAttributes(pPlayer, aAttributes, sizeof(aAttributes), Enchant);
-			GS()->AVM(ClientID, "null", NOPE, HideID, "{STR}", aAttributes);
+			const int ID = pRes->getInt("ID");
+			const int ItemID = pRes->getInt("ItemID");
+			const int Price = pRes->getInt("Price");
+			const int Enchant = pRes->getInt("Enchant");
+			const int ItemValue = pRes->getInt("ItemValue");
+			CItemDataInfo &pBuyightItem = GS()->GetItemInfo(ItemID);
+
+			if(pBuyightItem.IsEnchantable())
+			{
+				char aEnchantBuf[16];
+				pBuyightItem.FormatEnchantLevel(aEnchantBuf, sizeof(aEnchantBuf), Enchant);
+				GS()->AVHI(ClientID, pBuyightItem.GetIcon(), HideID, LIGHT_GRAY_COLOR, "{STR}{STR} {STR} - {INT} gold",
+					(pPlayer->GetItem(ItemID).m_Value > 0 ? "✔ " : "\0"), pBuyightItem.GetName(), (Enchant > 0 ? aEnchantBuf : "\0"), Price);
+
+				char aAttributes[128];
+				pBuyightItem.FormatAttributes(pPlayer, aAttributes, sizeof(aAttributes), Enchant);
+				GS()->AVM(ClientID, "null", NOPE, HideID, "{STR}", aAttributes);
+			}
+			else
+			{
+				GS()->AVHI(ClientID, pBuyightItem.GetIcon(), HideID, LIGHT_GRAY_COLOR, "{STR}x{INT} ({INT}) - {INT} gold",
+					pBuyightItem.GetName(), ItemValue, pPlayer->GetItem(ItemID).m_Value, Price);
+			}
+
+			GS()->AVM(ClientID, "null", NOPE, HideID, "{STR}", pBuyightItem.GetDesc());
+			GS()->AVM(ClientID, "null", NOPE, HideID, "Seller {STR}", pRes->getString("Nick").c_str());
+			GS()->AVM(ClientID, "SHOP", ID, HideID, "Buy Price {INT} gold", Price);
+			FoundItems = true;
+			++HideID;
 		}
-		else
-		{
-			GS()->AVHI(ClientID, pBuyightItem.GetIcon(), HideID, LIGHT_GRAY_COLOR, "{STR}x{INT} ({INT}) - {INT} gold",
-				pBuyightItem.GetName(), ItemValue, pPlayer->GetItem(ItemID).m_Value, Price);
-		}
-
-		GS()->AVM(ClientID, "null", NOPE, HideID, "{STR}", pBuyightItem.GetDesc());
-		GS()->AVM(ClientID, "null", NOPE, HideID, "Seller {STR}", Job()->PlayerName(UserID));
-		GS()->AVM(ClientID, "SHOP", ID, HideID, "Buy Price {INT} gold", Price);
-		FoundItems = true;
-		++HideID;
-	}
-	if(!FoundItems)
-		GS()->AVL(ClientID, "null", "Currently there are no products.");
+		if(!FoundItems)
+			GS()->AVL(ClientID, "null", "Currently there are no products.");
 
-	GS()->AV(ClientID, "null");
+		GS()->AV(ClientID, "null");
+		GS()->AddVotesZoneNotice(ClientID);
+	}, "LEFT JOIN tw_accounts_data ON tw_accounts_data.ID = tw_store_items.UserID WHERE tw_store_items.UserID > 0 ORDER BY tw_store_items.Price");
 }
 
 void CShopCore::ShowMailShop(CPlayer *pPlayer, int StorageID)
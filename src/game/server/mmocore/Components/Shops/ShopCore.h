@@ -15,6 +15,7 @@ class CShopCore : public MmoComponent
 
 	void OnInit() override;
 	void OnTick() override;
+	void OnWakeWorld(int SleptTicks) override;
 	bool OnHandleTile(CCharacter* pChr, int IndexCollision) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
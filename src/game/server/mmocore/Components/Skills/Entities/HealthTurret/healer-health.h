@@ -19,6 +19,7 @@ public:
 	~CHealthHealer() override;
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 	void Reset() override;
 	void Tick() override;
 
@@ -18,6 +18,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
@@ -10,6 +10,7 @@ public:
 	CNoctisTeleport(CGameWorld *pGameWorld, vec2 Pos, CCharacter* pPlayerChar, int SkillBonus);
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 	void Reset() override;
 	void Tick() override;
 
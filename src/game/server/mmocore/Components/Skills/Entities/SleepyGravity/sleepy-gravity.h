@@ -18,6 +18,7 @@ public:
 	~CSleepyGravity() override;
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 	void Reset() override;
 	void Tick() override;
 
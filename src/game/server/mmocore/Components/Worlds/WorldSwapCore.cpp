@@ -6,6 +6,15 @@
 
 void CWorldSwapCore::OnInit()
 {
+	// one query for the settings of all worlds, the worlds are initialized after the main one
+	ResultPtr pRes = SJK.SD("WorldID, RespawnWorld, MusicID", "enum_worlds");
+	while(pRes->next())
+	{
+		const int WorldID = pRes->getInt("WorldID");
+		CWorldData::ms_aWorlds[WorldID].m_RespawnWorldID = pRes->getInt("RespawnWorld");
+		CWorldData::ms_aWorlds[WorldID].m_MusicID = pRes->getInt("MusicID");
+	}
+
 	SJK.SDT("*", "tw_world_swap", [&](ResultPtr pRes)
 	{
 		while(pRes->next())
@@ -33,14 +42,12 @@ void CWorldSwapCore::OnInitWorld(const char* pWhereLocalWorld)
 	const int WorldID = GS()->GetWorldID();
 	const CSqlString<32> cstrWorldName = CSqlString<32>(Server()->GetWorldName(WorldID));
 
-	ResultPtr pRes = SJK.SD("RespawnWorld, MusicID", "enum_worlds", pWhereLocalWorld);
-	if(pRes->next())
+	const auto pWorld = CWorldData::ms_aWorlds.find(WorldID);
+	if(pWorld != CWorldData::ms_aWorlds.end())
 	{
-		const int RespawnWorld = (int)pRes->getInt("RespawnWorld");
-		const int MusicID = (int)pRes->getInt("MusicID");
 		SJK.UD("enum_worlds", "Name = '%s' WHERE WorldID = '%d'", cstrWorldName.cstr(), WorldID);
-		GS()->SetRespawnWorld(RespawnWorld);
-		GS()->SetMapMusic(MusicID);
+		GS()->SetRespawnWorld(pWorld->second.m_RespawnWorldID);
+		GS()->SetMapMusic(pWorld->second.m_MusicID);
 		return;
 	}
 	SJK.ID("enum_worlds", "(WorldID, Name) VALUES ('%d', '%s')", WorldID, cstrWorldName.cstr());
@@ -13,6 +13,7 @@ class CWorldSwapCore : public MmoComponent
 	{
 		CWorldSwapData::ms_aWorldSwap.clear();
 		CWorldSwapPosition::ms_aWorldPositionLogic.clear();
+		CWorldData::ms_aWorlds.clear();
 	};
 
 	void OnInit() override;
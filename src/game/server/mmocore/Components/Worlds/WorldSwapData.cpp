@@ -3,4 +3,5 @@
 #include "WorldSwapData.h"
 
 std::map < int , CWorldSwapData > CWorldSwapData::ms_aWorldSwap;
-std::list < CWorldSwapPosition > CWorldSwapPosition::ms_aWorldPositionLogic;
\ No newline at end of file
+std::list < CWorldSwapPosition > CWorldSwapPosition::ms_aWorldPositionLogic;
+std::map < int , CWorldData > CWorldData::ms_aWorlds;
@@ -19,5 +19,12 @@ struct CWorldSwapPosition
 
 	static std::list< CWorldSwapPosition > ms_aWorldPositionLogic;
 };
+struct CWorldData
+{
+	int m_RespawnWorldID;
+	int m_MusicID;
+
+	static std::map< int, CWorldData > ms_aWorlds;
+};
 
 #endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include <game/server/gamecontext.h>
 
+MACRO_ALLOC_SLAB_IMPL(CDropBonuses, 256)
+
 CDropBonuses::CDropBonuses(CGameWorld *pGameWorld, vec2 Pos, vec2 Vel, float AngleForce, int Type, int Value)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_DROPBONUS, Pos, 24)
 {
@@ -6,6 +6,8 @@
 
 class CDropBonuses : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 	vec2 m_Vel;
 	float m_Angle;
 	float m_AngleForce;
@@ -21,6 +23,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
@@ -7,6 +7,8 @@
 
 #include <base/tl/base.h>
 
+MACRO_ALLOC_SLAB_IMPL(CDropItem, 64)
+
 CDropItem::CDropItem(CGameWorld *pGameWorld, vec2 Pos, vec2 Vel, float AngleForce, CItemData DropItem, int OwnerID)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_DROPITEM, Pos, 28.0f)
 {
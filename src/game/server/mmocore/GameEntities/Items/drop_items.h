@@ -6,6 +6,8 @@
 
 class CDropItem : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 	enum
 	{
 		NUM_IDS = 4,
@@ -28,6 +30,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 
 	bool TakeItem(int ClientID);
 };
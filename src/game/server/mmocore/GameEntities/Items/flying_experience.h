@@ -6,6 +6,8 @@
 
 class CFlyingExperience : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 private:
 	vec2 m_InitialVel;
 	float m_InitialAmount;
@@ -17,6 +19,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
@@ -21,6 +21,7 @@ public:
 	~CDecorationHouses() override;
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <engine/server.h>
 #include <engine/shared/config.h>
 
+MACRO_ALLOC_SLAB_IMPL(CLolPlasma, 256)
+
 CLolPlasma::CLolPlasma(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2 Vel, int Lifespan)
 	: CEntity(pGameWorld, CGameWorld::ENTTYPE_WORLD_TEXT, Pos)
 {
@@ -25,6 +27,7 @@ void CLolPlasma::Tick()
 		return;
 	}
 	m_Pos = (m_pParent ? m_pParent->GetPos() : vec2(0.0f, 0.0f)) + m_StartOff + (m_LocalPos += m_Vel);
+	GameWorld()->GridMove(this);
 }
 
 void CLolPlasma::Snap(int SnappingClient)
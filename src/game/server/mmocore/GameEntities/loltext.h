@@ -4,6 +4,8 @@
 
 class CLolPlasma : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 	vec2 m_LocalPos; // local coordinate system is origin'd wherever we actually start (i.e. this is (0,0) after creation)
 	vec2 m_Vel;
 	int m_Life; // remaining ticks
@@ -16,6 +18,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared() const override { return true; }
 };
 
 class CLoltext
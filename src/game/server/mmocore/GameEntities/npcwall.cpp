@@ -23,8 +23,11 @@ void CNPCWall::Tick()
 {
 	// We're looking for bots
 	m_Active = false;
-	for (CCharacter* pChar = (CCharacter*)GameWorld()->FindFirst(CGameWorld::ENTTYPE_CHARACTER); pChar; pChar = (CCharacter*)pChar->TypeNext())
+	CCharacter *apEnts[MAX_CLIENTS];
+	const int Num = GameWorld()->FindEntitiesOnLine(m_Pos, m_PosTo, (float)g_Config.m_SvDoorRadiusHit, (CEntity**)apEnts, MAX_CLIENTS, CGameWorld::ENTTYPE_CHARACTER);
+	for (int i = 0; i < Num; i++)
 	{
+		CCharacter* pChar = apEnts[i];
 		if (pChar->GetPlayer()->IsBot() && pChar->GetPlayer()->GetBotType() != BotsTypes::TYPE_BOT_MOB)
 		{
 			vec2 IntersectPos = closest_point_on_line(m_Pos, m_PosTo, pChar->m_Core.m_Pos);
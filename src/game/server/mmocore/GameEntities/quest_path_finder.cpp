@@ -36,6 +36,7 @@ void CQuestPathFinder::Tick()
 	const vec2 PlayerPosition = GS()->m_apPlayers[m_ClientID]->GetCharacter()->m_Core.m_Pos;
 	const vec2 Direction = normalize(PlayerPosition - m_TargetPos);
 	m_Pos = PlayerPosition - Direction * clamp(distance(m_Pos, m_TargetPos), 32.0f, 90.0f);
+	GameWorld()->GridMove(this);
 }
 
 void CQuestPathFinder::Snap(int SnappingClient)
@@ -4,6 +4,8 @@
 
 #include <game/server/gamecontext.h>
 
+MACRO_ALLOC_SLAB_IMPL(CSnapFull, 64)
+
 CSnapFull::CSnapFull(CGameWorld *pGameWorld, vec2 Pos, int SnapID, int ClientID, int Num, int Type, bool Changing, bool Projectile)
 : CEntity(pGameWorld, CGameWorld::ENTTYPE_SNAPEFFECT, Pos)
 {
@@ -85,6 +87,7 @@ void CSnapFull::Tick()
 			m_IsBack = false;
 	}
 	m_Pos = pOwner->GetCharacter()->m_Core.m_Pos;
+	GameWorld()->GridMove(this);
 }
 
 void CSnapFull::Snap(int SnappingClient)
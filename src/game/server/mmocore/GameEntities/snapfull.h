@@ -6,6 +6,8 @@
 
 class CSnapFull : public CEntity
 {
+	MACRO_ALLOC_SLAB()
+
 public:
 	CSnapFull(CGameWorld *pGameWorld, vec2 Pos, int SnapID, int ClientID, int Num, int Type, bool Changing, bool Projectile);
 	~CSnapFull() override;
@@ -14,6 +14,8 @@ protected:
 	class IServer* m_pServer;
 	class MmoController* m_Job;
 	friend MmoController; // provide access for the controller
+	const char* m_pName;
+	class CProfilerSection* m_pProfilerSection;
 
 	CGS* GS() const { return m_GameServer; }
 	IServer* Server() const { return m_pServer; }
@@ -27,6 +29,7 @@ private:
 	virtual void OnInit() {};
 	virtual void OnInitAccount(class CPlayer* pPlayer) {};
 	virtual void OnTick() {};
+	virtual void OnWakeWorld(int SleptTicks) {};
 	virtual void OnResetClient(int ClientID) {};
 	virtual bool OnHandleTile(class CCharacter* pChr, int IndexCollision) { return false; };
 	virtual bool OnHandleMenulist(class CPlayer* pPlayer, int Menulist, bool ReplaceMenu) { return false; };
@@ -4,6 +4,7 @@
 
 #include <engine/storage.h>
 #include <engine/shared/datafile.h>
+#include <engine/shared/profiler.h>
 #include <game/server/gamecontext.h>
 #include <teeother/system/string.h>
 
@@ -27,22 +28,22 @@
 MmoController::MmoController(CGS *pGameServer) : m_pGameServer(pGameServer)
 {
 	// order
-	m_Components.add(m_pBotsInfo = new CBotCore());
-	m_Components.add(m_pItemWork = new CInventoryCore());
-	m_Components.add(m_pCraftJob = new CCraftCore());
-	m_Components.add(m_pStorageWork = new CStorageCore());
-	m_Components.add(m_pShopmail = new CShopCore());
-	m_Components.add(m_pQuest = new QuestCore());
-	m_Components.add(m_pDungeonJob = new DungeonCore());
-	m_Components.add(new CAetherCore());
-	m_Components.add(m_pWorldSwapJob = new CWorldSwapCore());
-	m_Components.add(m_pHouseJob = new CHouseCore());
-	m_Components.add(m_pGuildJob = new GuildCore());
-	m_Components.add(m_pSkillJob = new CSkillsCore());
-	m_Components.add(m_pAccMain = new CAccountCore());
-	m_Components.add(m_pAccMiner = new CAccountMinerCore());
-	m_Components.add(m_pAccPlant = new CAccountPlantCore());
-	m_Components.add(m_pMailBoxJob = new CMailBoxCore());
+	m_Components.add(m_pBotsInfo = new CBotCore(), "bots");
+	m_Components.add(m_pItemWork = new CInventoryCore(), "inventory");
+	m_Components.add(m_pCraftJob = new CCraftCore(), "crafts");
+	m_Components.add(m_pStorageWork = new CStorageCore(), "storages");
+	m_Components.add(m_pShopmail = new CShopCore(), "shops");
+	m_Components.add(m_pQuest = new QuestCore(), "quests");
+	m_Components.add(m_pDungeonJob = new DungeonCore(), "dungeons");
+	m_Components.add(new CAetherCore(), "aethers");
+	m_Components.add(m_pWorldSwapJob = new CWorldSwapCore(), "worlds");
+	m_Components.add(m_pHouseJob = new CHouseCore(), "houses");
+	m_Components.add(m_pGuildJob = new GuildCore(), "guilds");
+	m_Components.add(m_pSkillJob = new CSkillsCore(), "skills");
+	m_Components.add(m_pAccMain = new CAccountCore(), "accounts");
+	m_Components.add(m_pAccMiner = new CAccountMinerCore(), "miner");
+	m_Components.add(m_pAccPlant = new CAccountPlantCore(), "plants");
+	m_Components.add(m_pMailBoxJob = new CMailBoxCore(), "mails");
 
 	for(auto& pComponent : m_Components.m_paComponents)
 	{
@@ -50,6 +51,10 @@ MmoController::MmoController(CGS *pGameServer) : m_pGameServer(pGameServer)
 		pComponent->m_GameServer = pGameServer;
 		pComponent->m_pServer = pGameServer->Server();
 
+		char aSection[64];
+		str_format(aSection, sizeof(aSection), "mmo/%s", pComponent->m_pName);
+		pComponent->m_pProfilerSection = CProfiler::WorldSection(m_pGameServer->GetWorldID(), aSection);
+
 		if(m_pGameServer->GetWorldID() == MAIN_WORLD_ID)
 			pComponent->OnInit();
 
@@ -67,7 +72,16 @@ MmoController::~MmoController()
 void MmoController::OnTick()
 {
 	for(auto& pComponent : m_Components.m_paComponents)
+	{
+		CProfilerScope ProfilerScope(pComponent->m_pProfilerSection);
 		pComponent->OnTick();
+	}
+}
+
+void MmoController::OnWakeWorld(int SleptTicks)
+{
+	for(auto& pComponent : m_Components.m_paComponents)
+		pComponent->OnWakeWorld(SleptTicks);
 }
 
 void MmoController::OnInitAccount(int ClientID)
@@ -155,79 +169,105 @@ void MmoController::ResetClientData(int ClientID)
 		pComponent->OnResetClient(ClientID);
 }
 
-// saving account
+// saving account, the changes are collected and written once per sv_save_interval
 void MmoController::SaveAccount(CPlayer *pPlayer, int Table) const
 {
 	if(!pPlayer->IsAuthed())
 		return;
 
+	pPlayer->Acc().m_SaveFlags |= 1 << Table;
+}
+
+void MmoController::FlushAccount(CPlayer *pPlayer) const
+{
+	if(!pPlayer->IsAuthed())
+		return;
+
+	const int SaveFlags = pPlayer->Acc().m_SaveFlags;
+	pPlayer->Acc().m_SaveFlags = 0;
+	for(int Table = SAVE_ACCOUNT; Table <= SAVE_LANGUAGE; Table++)
+	{
+		if(SaveFlags & (1 << Table))
+			WriteAccount(pPlayer, Table);
+	}
+
+	const std::set<int> aSaveItems = pPlayer->Acc().m_aSaveItems;
+	for(const int ItemID : aSaveItems)
+		pPlayer->GetItem(ItemID).Flush();
+}
+
+void MmoController::WriteAccount(CPlayer *pPlayer, int Table) const
+{
+	// the writes of one account keep their order, the accounts are written in parallel
 	if(Table == SAVE_STATS)
 	{
 		const int EquipDiscord = pPlayer->GetEquippedItemID(EQUIP_DISCORD);
-		SJK.UD("tw_accounts_data", "Level = '%d', Exp = '%d', DiscordEquip = '%d' WHERE ID = '%d'",
-			pPlayer->Acc().m_Level, pPlayer->Acc().m_Exp, EquipDiscord, pPlayer->Acc().m_UserID);
+		SJK.UD("tw_accounts_data", "Level = ?, Exp = ?, DiscordEquip = ? WHERE ID = ?",
+			CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(pPlayer->Acc().m_Level).Int(pPlayer->Acc().m_Exp).Int(EquipDiscord).Int(pPlayer->Acc().m_UserID));
 	}
 	else if(Table == SAVE_UPGRADES)
 	{
-		char aBuf[64];
-		dynamic_string Buffer;
+		// the field names are fixed, so the query is prepared once and only the values are bound
+		std::string Fields("Upgrade = ?");
+		CSqlParams Params;
+		Params.OrderKey(pPlayer->Acc().m_UserID);
+		Params.Int(pPlayer->Acc().m_Upgrade);
 		for(const auto& at : CGS::ms_aAttributsInfo)
 		{
 			if(str_comp_nocase(at.second.m_aFieldName, "unfield") == 0)
 				continue;
-			str_format(aBuf, sizeof(aBuf), ", %s = '%d' ", at.second.m_aFieldName, pPlayer->Acc().m_aStats[at.first]);
-			Buffer.append_at(Buffer.length(), aBuf);
+			Fields.append(", ").append(at.second.m_aFieldName).append(" = ?");
+			Params.Int(pPlayer->Acc().m_aStats[at.first]);
 		}
 
-		SJK.UD("tw_accounts_data", "Upgrade = '%d' %s WHERE ID = '%d'", pPlayer->Acc().m_Upgrade, Buffer.buffer(), pPlayer->Acc().m_UserID);
-		Buffer.clear();
+		Fields.append(" WHERE ID = ?");
+		SJK.UD("tw_accounts_data", Fields.c_str(), Params.Int(pPlayer->Acc().m_UserID));
 	}
 	else if(Table == SAVE_PLANT_DATA)
 	{
-		char aBuf[64];
-		dynamic_string Buffer;
+		std::string Fields;
+		CSqlParams Params;
+		Params.OrderKey(pPlayer->Acc().m_UserID);
 		for(int i = 0; i < NUM_JOB_ACCOUNTS_STATS; i++)
 		{
-			const char *pFieldName = pPlayer->Acc().m_aFarming[i].getFieldName();
-			const int JobValue = pPlayer->Acc().m_aFarming[i].m_Value;
-			str_format(aBuf, sizeof(aBuf), "%s = '%d' %s", pFieldName, JobValue, (i == NUM_JOB_ACCOUNTS_STATS-1 ? "" : ", "));
-			Buffer.append_at(Buffer.length(), aBuf);
+			Fields.append(i == 0 ? "" : ", ").append(pPlayer->Acc().m_aFarming[i].getFieldName()).append(" = ?");
+			Params.Int(pPlayer->Acc().m_aFarming[i].m_Value);
 		}
 
-		SJK.UD("tw_accounts_farming", "%s WHERE UserID = '%d'", Buffer.buffer(), pPlayer->Acc().m_UserID);
-		Buffer.clear();
+		Fields.append(" WHERE UserID = ?");
+		SJK.UD("tw_accounts_farming", Fields.c_str(), Params.Int(pPlayer->Acc().m_UserID));
 	}
 	else if(Table == SAVE_MINER_DATA)
 	{
-		char aBuf[64];
-		dynamic_string Buffer;
+		std::string Fields;
+		CSqlParams Params;
+		Params.OrderKey(pPlayer->Acc().m_UserID);
 		for(int i = 0; i < NUM_JOB_ACCOUNTS_STATS; i++)
 		{
-			const char* pFieldName = pPlayer->Acc().m_aMining[i].getFieldName();
-			const int JobValue = pPlayer->Acc().m_aMining[i].m_Value;
-			str_format(aBuf, sizeof(aBuf), "%s = '%d' %s", pFieldName, JobValue, (i == NUM_JOB_ACCOUNTS_STATS-1 ? "" : ", "));
-			Buffer.append_at(Buffer.length(), aBuf);
+			Fields.append(i == 0 ? "" : ", ").append(pPlayer->Acc().m_aMining[i].getFieldName()).append(" = ?");
+			Params.Int(pPlayer->Acc().m_aMining[i].m_Value);
 		}
 
-		SJK.UD("tw_accounts_mining", "%s WHERE UserID = '%d'", Buffer.buffer(), pPlayer->Acc().m_UserID);
-		Buffer.clear();
+		Fields.append(" WHERE UserID = ?");
+		SJK.UD("tw_accounts_mining", Fields.c_str(), Params.Int(pPlayer->Acc().m_UserID));
 	}
 	else if(Table == SAVE_GUILD_DATA)
 	{
-		SJK.UD("tw_accounts_data", "GuildID = '%d', GuildRank = '%d' WHERE ID = '%d'", pPlayer->Acc().m_GuildID, pPlayer->Acc().m_GuildRank, pPlayer->Acc().m_UserID);
+		SJK.UD("tw_accounts_data", "GuildID = ?, GuildRank = ? WHERE ID = ?",
+			CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(pPlayer->Acc().m_GuildID).Int(pPlayer->Acc().m_GuildRank).Int(pPlayer->Acc().m_UserID));
 	}
 	else if(Table == SAVE_POSITION)
 	{
 		const int LatestCorrectWorldID = Account()->GetHistoryLatestCorrectWorldID(pPlayer);
-		SJK.UD("tw_accounts_data", "WorldID = '%d' WHERE ID = '%d'", LatestCorrectWorldID, pPlayer->Acc().m_UserID);
+		SJK.UD("tw_accounts_data", "WorldID = ? WHERE ID = ?", CSqlParams().OrderKey(pPlayer->Acc().m_UserID).Int(LatestCorrectWorldID).Int(pPlayer->Acc().m_UserID));
 	}
 	else if(Table == SAVE_LANGUAGE)
 	{
-		SJK.UD("tw_accounts", "Language = '%s' WHERE ID = '%d'", pPlayer->GetLanguage(), pPlayer->Acc().m_UserID);
+		SJK.UD("tw_accounts", "Language = ? WHERE ID = ?", CSqlParams().OrderKey(pPlayer->Acc().m_UserID).String(GS()->Server()->GetClientLanguage(pPlayer->GetCID())).Int(pPlayer->Acc().m_UserID));
 	}
 	else
 	{
-		SJK.UD("tw_accounts", "Username = '%s' WHERE ID = '%d'", pPlayer->Acc().m_aLogin, pPlayer->Acc().m_UserID);
+		SJK.UD("tw_accounts", "Username = ? WHERE ID = ?", CSqlParams().OrderKey(pPlayer->Acc().m_UserID).String(pPlayer->Acc().m_aLogin).Int(pPlayer->Acc().m_UserID));
 	}
 }
 
@@ -263,58 +303,79 @@ void MmoController::ShowLoadingProgress(const char* pLoading, int Size) const
 
 void MmoController::ShowTopList(CPlayer* pPlayer, int TypeID) const
 {
+	// the rows come in a later tick, the back page is added after them
 	const int ClientID = pPlayer->GetCID();
-	pPlayer->m_VoteColored = SMALL_LIGHT_GRAY_COLOR;
+	auto ShowRows = [this, ClientID](std::function<void(ResultPtr&)> Rows)
+	{
+		return [this, ClientID, Rows](ResultPtr pRes)
+		{
+			CPlayer* pPlayer = GS()->GetPlayer(ClientID, true);
+			if(!pPlayer)
+				return;
+
+			pPlayer->m_VoteColored = SMALL_LIGHT_GRAY_COLOR;
+			Rows(pRes);
+			GS()->AddVotesBackpage(ClientID);
+		};
+	};
+
 	if(TypeID == GUILDS_LEVELING)
 	{
-		ResultPtr pRes = SJK.SD("*", "tw_guilds", "ORDER BY Level DESC, Experience DESC LIMIT 10");
-		while (pRes->next())
+		pPlayer->m_pMenuQuery = SJK.SDA("Name, Level, Experience", "tw_guilds", ShowRows([this, ClientID](ResultPtr& pRes)
 		{
-			char NameGuild[64];
-			const int Rank = pRes->getRow();
-			const int Level = pRes->getInt("Level");
-			const int Experience = pRes->getInt("Experience");
-			str_copy(NameGuild, pRes->getString("Name").c_str(), sizeof(NameGuild));
-			GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, NameGuild, Level, Experience);
-		}
+			while(pRes->next())
+			{
+				char NameGuild[64];
+				const int Rank = pRes->getRow();
+				const int Level = pRes->getInt("Level");
+				const int Experience = pRes->getInt("Experience");
+				str_copy(NameGuild, pRes->getString("Name").c_str(), sizeof(NameGuild));
+				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, NameGuild, Level, Experience);
+			}
+		}), "ORDER BY Level DESC, Experience DESC LIMIT 10");
 	}
 	else if (TypeID == GUILDS_WEALTHY)
 	{
-		ResultPtr pRes = SJK.SD("*", "tw_guilds", "ORDER BY Bank DESC LIMIT 10");
-		while (pRes->next())
+		pPlayer->m_pMenuQuery = SJK.SDA("Name, Bank", "tw_guilds", ShowRows([this, ClientID](ResultPtr& pRes)
 		{
-			char NameGuild[64];
-			const int Rank = pRes->getRow();
-			const int Gold = pRes->getInt("Bank");
-			str_copy(NameGuild, pRes->getString("Name").c_str(), sizeof(NameGuild));
-			GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {INT}", Rank, NameGuild, Gold);
-		}
+			while(pRes->next())
+			{
+				char NameGuild[64];
+				const int Rank = pRes->getRow();
+				const int Gold = pRes->getInt("Bank");
+				str_copy(NameGuild, pRes->getString("Name").c_str(), sizeof(NameGuild));
+				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {INT}", Rank, NameGuild, Gold);
+			}
+		}), "ORDER BY Bank DESC LIMIT 10");
 	}
 	else if (TypeID == PLAYERS_LEVELING)
 	{
-		ResultPtr pRes = SJK.SD("*", "tw_accounts_data", "ORDER BY Level DESC, Exp DESC LIMIT 10");
-		while (pRes->next())
+		pPlayer->m_pMenuQuery = SJK.SDA("Nick, Level, Exp", "tw_accounts_data", ShowRows([this, ClientID](ResultPtr& pRes)
 		{
-			char Nick[64];
-			const int Rank = pRes->getRow();
-			const int Level = pRes->getInt("Level");
-			const int Experience = pRes->getInt("Exp");
-			str_copy(Nick, pRes->getString("Nick").c_str(), sizeof(Nick));
-			GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, Nick, Level, Experience);
-		}
+			while(pRes->next())
+			{
+				char Nick[64];
+				const int Rank = pRes->getRow();
+				const int Level = pRes->getInt("Level");
+				const int Experience = pRes->getInt("Exp");
+				str_copy(Nick, pRes->getString("Nick").c_str(), sizeof(Nick));
+				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, Nick, Level, Experience);
+			}
+		}), "ORDER BY Level DESC, Exp DESC LIMIT 10");
 	}
 	else if (TypeID == PLAYERS_WEALTHY)
 	{
-		ResultPtr pRes = SJK.SD("*", "tw_accounts_items", "WHERE ItemID = '%d' ORDER BY Value DESC LIMIT 10", (int)itGold);
-		while (pRes->next())
+		pPlayer->m_pMenuQuery = SJK.SDA("tw_accounts_items.Value, tw_accounts_data.Nick", "tw_accounts_items", ShowRows([this, ClientID](ResultPtr& pRes)
 		{
-			char Nick[64];
-			const int Rank = pRes->getRow();
-			const int Gold = pRes->getInt("Value");
-			const int UserID = pRes->getInt("UserID");
-			str_copy(Nick, PlayerName(UserID), sizeof(Nick));
-			GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {INT}", Rank, Nick, Gold);
-		}
+			while(pRes->next())
+			{
+				char Nick[64];
+				const int Rank = pRes->getRow();
+				const int Gold = pRes->getInt("Value");
+				str_copy(Nick, pRes->getString("Nick").c_str(), sizeof(Nick));
+				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {INT}", Rank, Nick, Gold);
+			}
+		}), "JOIN tw_accounts_data ON tw_accounts_data.ID = tw_accounts_items.UserID WHERE tw_accounts_items.ItemID = '%d' ORDER BY tw_accounts_items.Value DESC LIMIT 10", (int)itGold);
 	}
 }
 
@@ -15,8 +15,9 @@ class MmoController
 	class CStack
 	{
 	public:
-		void add(class MmoComponent *pComponent)
+		void add(class MmoComponent *pComponent, const char *pName)
 		{
+			pComponent->m_pName = pName;
  			m_paComponents.push_back(pComponent);
 		}
 
@@ -47,6 +48,8 @@ class MmoController
 	class CSkillsCore* m_pSkillJob;
 	class CWorldSwapCore* m_pWorldSwapJob;
 
+	void WriteAccount(CPlayer *pPlayer, int Table) const;
+
 public:
 	explicit MmoController(CGS *pGameServer);
 	~MmoController();
@@ -73,6 +76,7 @@ public:
 
 	// global systems
 	void OnTick();
+	void OnWakeWorld(int SleptTicks);
 	bool OnPlayerHandleTile(CCharacter *pChr, int IndexCollision);
 	bool OnPlayerHandleMainMenu(int ClientID, int Menulist, bool ReplaceMenu);
 	void OnInitAccount(int ClientID);
@@ -86,6 +90,7 @@ public:
 	void LoadLogicWorld() const;
 	static const char* PlayerName(int AccountID);
 	void SaveAccount(CPlayer *pPlayer, int Table) const;
+	void FlushAccount(CPlayer *pPlayer) const;
 	void ShowLoadingProgress(const char* pLoading, int Size) const;
 	void ShowTopList(CPlayer* pPlayer, int TypeID) const;
 };
@@ -1,202 +1,574 @@
 /* Pathfind class by Sushi */
 #include "PathFinder.h"
 
+#include <engine/server.h>
 #include <game/collision.h>
 #include <game/layers.h>
 
-CPathfinder::CPathfinder(class CLayers* Layers, class CCollision* Collision) : m_pLayers(Layers), m_pCollision(Collision)
+// the node states of one graph, they are valid only for the generation that wrote them so nothing is cleared between searches
+class CSearchState
 {
-	m_ClosedNodes = 0;
-	m_FinalSize = 0;
-	m_StartIndex = -1;
-	m_EndIndex = -1;
+public:
+	struct CState
+	{
+		int m_Parent;
+		int m_G;
+		bool m_IsClosed;
+		bool m_IsOpen;
+	};
+
+	CSearchState() : m_Generation(0) {}
+
+	void Prepare(int NumNodes)
+	{
+		if((int)m_aState.size() < NumNodes)
+		{
+			m_aState.resize(NumNodes);
+			m_aGeneration.resize(NumNodes, 0);
+		}
+
+		m_Open.SetSize(NumNodes);
+		m_Open.MakeEmpty();
+		if(++m_Generation == 0)
+		{
+			std::fill(m_aGeneration.begin(), m_aGeneration.end(), 0);
+			m_Generation = 1;
+		}
+	}
+
+	CState& State(int Index)
+	{
+		if(m_aGeneration[Index] != m_Generation)
+		{
+			m_aGeneration[Index] = m_Generation;
+			m_aState[Index] = { -1, 0, false, false };
+		}
+		return m_aState[Index];
+	}
+
+	CIndexedBinaryHeap m_Open;
+
+private:
+	std::vector<CState> m_aState;
+	std::vector<unsigned> m_aGeneration;
+	unsigned m_Generation;
+};
+
+// the scratch buffers of one search, every worker keeps its own and reuses it
+class CPathfinder::CSearch
+{
+public:
+	CSearchState m_Grid;
+	CSearchState m_Nav;
+	std::vector<int> m_aDistance;
+	std::vector<int> m_aQueue;
+	std::vector<int> m_aTiles;
+	std::vector<int> m_aNavPath;
+	std::vector<CNavEdge> m_aStartEdges;
+	std::vector<CNavEdge> m_aEndEdges;
+};
 
+CPathfinder::CPathfinder(IServer* pServer, CLayers* Layers, CCollision* Collision) : m_pServer(pServer), m_pLayers(Layers), m_pCollision(Collision)
+{
+	m_PendingRequests = 0;
+	m_LastRequestID = 0;
 	m_LayerWidth = m_pLayers->GameLayer()->m_Width;
 	m_LayerHeight = m_pLayers->GameLayer()->m_Height;
 
 	// set size for array
 	m_lMap.set_size(m_LayerWidth * m_LayerHeight);
-	m_lNodes.set_size(m_LayerWidth * m_LayerHeight);
-	m_lFinalPath.set_size(MAX_WAY_CALC);
-
-	// init size for heap
-	m_Open.SetSize(4 * MAX_WAY_CALC);
-
-	int ID = 0;
 	for (int i = 0; i < m_LayerHeight; i++)
 	{
 		for (int j = 0; j < m_LayerWidth; j++)
 		{
 			CNode Node;
 			Node.m_Pos = vec2(j, i);
-			Node.m_Parent = -1;
-			Node.m_ID = ID;
-			Node.m_G = 0;
-			Node.m_H = 0;
-			Node.m_F = 0;
-			Node.m_IsClosed = false;
-			Node.m_IsOpen = false;
-			if (m_pCollision->CheckPoint(j * 32 + 16, i * 32 + 16))
-				Node.m_IsCol = true;
-			else
-				Node.m_IsCol = false;
+			Node.m_IsCol = m_pCollision->CheckPoint(j * 32 + 16, i * 32 + 16);
 
 			// add the node to the list
 			m_lMap[i * m_LayerWidth + j] = Node;
-			ID++;
 		}
 	}
+
+	BuildNavigation();
 }
 
 CPathfinder::~CPathfinder()
 {
+	// the workers read the map, wait for the searches that are still running
+	while(m_PendingRequests.load(std::memory_order_acquire) > 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
 	m_lMap.clear();
-	m_lFinalPath.clear();
-	m_lNodes.clear();
 }
 
-void CPathfinder::Init()
+int CPathfinder::RequestPath(int ClientID, vec2 StartPos, vec2 SearchPos)
 {
-	m_ClosedNodes = 0;
-	m_FinalSize = 0;
-	m_Open.MakeEmpty();
-	m_lNodes = m_lMap;
+	// the requests of a world are made by its tick only, 0 is kept for no request
+	if(++m_LastRequestID <= 0)
+		m_LastRequestID = 1;
+	const int RequestID = m_LastRequestID;
+	m_PendingRequests++;
+	m_pServer->EnqueuePathSearch([this, ClientID, RequestID, StartPos, SearchPos]()
+	{
+		static thread_local CSearch s_Search;
+
+		CResult Result;
+		Result.m_ClientID = ClientID;
+		Result.m_RequestID = RequestID;
+		Result.m_Target = SearchPos;
+		FindPath(&s_Search, StartPos, SearchPos, Result.m_aPath);
+		AddResult(std::move(Result));
+	});
+	return RequestID;
 }
 
-void CPathfinder::SetStart(vec2 Pos)
+void CPathfinder::AddResult(CResult&& Result)
 {
-	Pos.x = clamp((int)Pos.x, 0, m_LayerWidth * 32);
-	Pos.y = clamp((int)Pos.y, 0, m_LayerHeight * 32);
-	int Index = GetIndex((int)(Pos.x / 32), (int)(Pos.y / 32));
+	{
+		std::lock_guard<std::mutex> Lock(m_ResultsLock);
+		m_aResults.push_back(std::move(Result));
+	}
+	m_PendingRequests.fetch_sub(1, std::memory_order_release);
+}
 
-	m_lNodes[Index].m_Parent = START;
-	m_lNodes[Index].m_IsClosed = true;
-	m_ClosedNodes++;
-	m_StartIndex = Index;
+void CPathfinder::TakeResults(std::vector<CResult>& aResults)
+{
+	aResults.clear();
+	std::lock_guard<std::mutex> Lock(m_ResultsLock);
+	aResults.swap(m_aResults);
 }
 
-void CPathfinder::SetEnd(vec2 Pos)
+int CPathfinder::GetIndex(int XPos, int YPos) const
 {
-	int Index = GetIndex((int)(Pos.x / 32), (int)(Pos.y / 32));
-	m_lNodes[Index].m_Parent = END;
-	m_EndIndex = Index;
+	return XPos + m_LayerWidth * YPos;
 }
 
+int CPathfinder::ClusterOf(int Tile) const
+{
+	return (Tile / m_LayerWidth / CLUSTER_SIZE) * m_ClustersX + (Tile % m_LayerWidth) / CLUSTER_SIZE;
+}
 
-int CPathfinder::GetIndex(int XPos, int YPos) const
+CPathfinder::CBounds CPathfinder::ClusterBounds(int Cluster) const
 {
-	return XPos + m_pLayers->GameLayer()->m_Width * YPos;
+	const int MinX = (Cluster % m_ClustersX) * CLUSTER_SIZE;
+	const int MinY = (Cluster / m_ClustersX) * CLUSTER_SIZE;
+	return { MinX, MinY, min(MinX + (int)CLUSTER_SIZE, m_LayerWidth), min(MinY + (int)CLUSTER_SIZE, m_LayerHeight) };
 }
 
-void CPathfinder::FindPath()
+void CPathfinder::BuildNavigation()
 {
-	int CurrentIndex = m_StartIndex;
-	if (m_StartIndex > -1 && m_EndIndex > -1)
+	// connected areas, a target in another area is never reachable
+	const int NumTiles = m_lMap.size();
+	m_aTileArea.assign(NumTiles, -1);
+
+	std::vector<int> aStack;
+	int NumAreas = 0;
+	for(int i = 0; i < NumTiles; i++)
 	{
-		while (m_ClosedNodes < MAX_WAY_CALC && m_lNodes[CurrentIndex].m_ID != m_EndIndex)
+		if(m_lMap[i].m_IsCol || m_aTileArea[i] != -1)
+			continue;
+
+		m_aTileArea[i] = NumAreas;
+		aStack.push_back(i);
+		while(!aStack.empty())
 		{
-			for (int i = 0; i < 4; i++)
+			const int Tile = aStack.back();
+			aStack.pop_back();
+
+			const int x = Tile % m_LayerWidth;
+			const int y = Tile / m_LayerWidth;
+			const int aNeighbours[4] = { x + 1 < m_LayerWidth ? Tile + 1 : -1, x > 0 ? Tile - 1 : -1,
+				y + 1 < m_LayerHeight ? Tile + m_LayerWidth : -1, y > 0 ? Tile - m_LayerWidth : -1 };
+			for(int Next : aNeighbours)
 			{
-				// get the working index
-				int WorkingIndex = -1;
-
-				switch (i)
-				{
-				case 0:
-					if (CurrentIndex + 1 < m_lNodes.size())
-						WorkingIndex = CurrentIndex + 1;
-					break;
-				case 1:
-					if (CurrentIndex - 1 >= 0)
-						WorkingIndex = CurrentIndex - 1;
-					break;
-				case 2:
-					if (CurrentIndex + m_LayerWidth < m_lNodes.size())
-						WorkingIndex = CurrentIndex + m_LayerWidth;
-					break;
-				case 3:
-					if (CurrentIndex - m_LayerWidth >= 0)
-						WorkingIndex = CurrentIndex - m_LayerWidth;
-				}
-
-				if (WorkingIndex > -1 && !m_lNodes[WorkingIndex].m_IsCol && !m_lNodes[WorkingIndex].m_IsClosed)
-				{
-					if (!m_lNodes[WorkingIndex].m_IsOpen)
-					{
-						// set its parent
-						m_lNodes[WorkingIndex].m_Parent = CurrentIndex;
-
-						// calculate the important values
-						m_lNodes[WorkingIndex].m_G = m_lNodes[CurrentIndex].m_G + 1;
-						m_lNodes[WorkingIndex].m_H = (abs((int)(m_lNodes[WorkingIndex].m_Pos.x - m_lNodes[m_EndIndex].m_Pos.x)) + abs((int)(m_lNodes[WorkingIndex].m_Pos.y - m_lNodes[m_EndIndex].m_Pos.y)));
-						m_lNodes[WorkingIndex].m_F = m_lNodes[WorkingIndex].m_G + m_lNodes[WorkingIndex].m_H;
-
-						m_lNodes[WorkingIndex].m_IsOpen = true;
-
-						m_Open.Insert(m_lNodes[WorkingIndex]);
-					}
-					else
-					{
-						// recalculate the G and F Value
-						if (m_lNodes[WorkingIndex].m_G > m_lNodes[CurrentIndex].m_G + 1)
-						{
-							// set new parent
-							m_lNodes[WorkingIndex].m_Parent = CurrentIndex;
-
-							// important values (H value wont change)
-							m_lNodes[WorkingIndex].m_G = m_lNodes[CurrentIndex].m_G + 1;
-							m_lNodes[WorkingIndex].m_F = m_lNodes[WorkingIndex].m_G + m_lNodes[WorkingIndex].m_H;
-
-							m_Open.Replace(m_lNodes[WorkingIndex]);
-						}
-					}
-				}
+				if(Next < 0 || m_lMap[Next].m_IsCol || m_aTileArea[Next] != -1)
+					continue;
+
+				m_aTileArea[Next] = NumAreas;
+				aStack.push_back(Next);
 			}
+		}
+		NumAreas++;
+	}
 
-			if (m_Open.GetSize() < 1)
-				return;
+	// entrances along the borders of the clusters
+	m_ClustersX = (m_LayerWidth + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	m_ClustersY = (m_LayerHeight + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	m_aNavNodes.clear();
+	m_aClusterNodes.assign(m_ClustersX * m_ClustersY, std::vector<int>());
 
-			// get Lowest F from heap and set new CurrentIndex
-			CurrentIndex = m_Open.GetMin()->m_ID;
+	std::unordered_map<int, int> aTileNodes;
+	auto ScanBorder = [&](int FirstA, int FirstB, int Step, int Length)
+	{
+		int RunStart = -1;
+		for(int i = 0; i <= Length; i++)
+		{
+			const bool Free = i < Length && !m_lMap[FirstA + i * Step].m_IsCol && !m_lMap[FirstB + i * Step].m_IsCol;
+			if(Free && RunStart < 0)
+				RunStart = i;
+			if(Free || RunStart < 0)
+				continue;
 
-			// delete it \o/
-			m_Open.RemoveMin();
+			// long openings get an entrance at both ends, short ones in the middle
+			const int RunEnd = i - 1;
+			if(RunEnd - RunStart + 1 >= 6)
+			{
+				AddTransition(aTileNodes, FirstA + RunStart * Step, FirstB + RunStart * Step);
+				AddTransition(aTileNodes, FirstA + RunEnd * Step, FirstB + RunEnd * Step);
+			}
+			else
+			{
+				const int Middle = (RunStart + RunEnd) / 2;
+				AddTransition(aTileNodes, FirstA + Middle * Step, FirstB + Middle * Step);
+			}
+			RunStart = -1;
+		}
+	};
 
-			// set the one with lowest score to closed list and begin new from there
-			m_lNodes[CurrentIndex].m_IsClosed = true;
-			m_ClosedNodes++;
+	for(int cy = 0; cy < m_ClustersY; cy++)
+	{
+		for(int cx = 0; cx < m_ClustersX; cx++)
+		{
+			const CBounds Bounds = ClusterBounds(cy * m_ClustersX + cx);
+			if(Bounds.m_MaxX < m_LayerWidth)
+				ScanBorder(GetIndex(Bounds.m_MaxX - 1, Bounds.m_MinY), GetIndex(Bounds.m_MaxX, Bounds.m_MinY), m_LayerWidth, Bounds.m_MaxY - Bounds.m_MinY);
+			if(Bounds.m_MaxY < m_LayerHeight)
+				ScanBorder(GetIndex(Bounds.m_MinX, Bounds.m_MaxY - 1), GetIndex(Bounds.m_MinX, Bounds.m_MaxY), 1, Bounds.m_MaxX - Bounds.m_MinX);
 		}
+	}
+
+	// walkable tiles bucketed by cluster for the roaming targets
+	m_aWalkableOffsets.assign(m_aClusterNodes.size() + 1, 0);
+	for(int i = 0; i < NumTiles; i++)
+	{
+		if(!m_lMap[i].m_IsCol)
+			m_aWalkableOffsets[ClusterOf(i) + 1]++;
+	}
+	for(int Cluster = 0; Cluster < (int)m_aClusterNodes.size(); Cluster++)
+		m_aWalkableOffsets[Cluster + 1] += m_aWalkableOffsets[Cluster];
+
+	std::vector<int> aFill(m_aWalkableOffsets.begin(), m_aWalkableOffsets.end() - 1);
+	m_aWalkableTiles.resize(m_aWalkableOffsets.back());
+	for(int i = 0; i < NumTiles; i++)
+	{
+		if(!m_lMap[i].m_IsCol)
+			m_aWalkableTiles[aFill[ClusterOf(i)]++] = i;
+	}
 
-		// go backwards and return final path :-O
-		while (m_lNodes[CurrentIndex].m_ID != m_StartIndex)
+	// links between the entrances of the same cluster
+	CSearch Search;
+	int NumEdges = 0;
+	for(int Cluster = 0; Cluster < (int)m_aClusterNodes.size(); Cluster++)
+	{
+		const CBounds Bounds = ClusterBounds(Cluster);
+		for(int From : m_aClusterNodes[Cluster])
 		{
-			m_lFinalPath[m_FinalSize] = m_lNodes[CurrentIndex];
-			m_FinalSize++;
+			ClusterDistances(&Search, m_aNavNodes[From].m_Tile, Cluster);
+			for(int To : m_aClusterNodes[Cluster])
+			{
+				const int Tile = m_aNavNodes[To].m_Tile;
+				const int Distance = Search.m_aDistance[(Tile / m_LayerWidth - Bounds.m_MinY) * CLUSTER_SIZE + Tile % m_LayerWidth - Bounds.m_MinX];
+				if(To != From && Distance > 0)
+					m_aNavNodes[From].m_aEdges.push_back({ To, Distance });
+			}
+			NumEdges += (int)m_aNavNodes[From].m_aEdges.size();
+		}
+	}
 
-			// get next node
-			CurrentIndex = m_lNodes[CurrentIndex].m_Parent;
+	dbg_msg("pathfinder", "navigation %dx%d: %d areas, %d clusters, %d entrances, %d links", m_LayerWidth, m_LayerHeight,
+		NumAreas, (int)m_aClusterNodes.size(), (int)m_aNavNodes.size(), NumEdges);
+}
+
+void CPathfinder::AddTransition(std::unordered_map<int, int>& aTileNodes, int TileA, int TileB)
+{
+	int aNodes[2];
+	const int aTiles[2] = { TileA, TileB };
+	for(int i = 0; i < 2; i++)
+	{
+		const auto pNode = aTileNodes.find(aTiles[i]);
+		if(pNode != aTileNodes.end())
+		{
+			aNodes[i] = pNode->second;
+			continue;
 		}
+
+		aNodes[i] = (int)m_aNavNodes.size();
+		const int Cluster = ClusterOf(aTiles[i]);
+		m_aNavNodes.push_back({ aTiles[i], Cluster, std::vector<CNavEdge>() });
+		m_aClusterNodes[Cluster].push_back(aNodes[i]);
+		aTileNodes[aTiles[i]] = aNodes[i];
 	}
+
+	m_aNavNodes[aNodes[0]].m_aEdges.push_back({ aNodes[1], 1 });
+	m_aNavNodes[aNodes[1]].m_aEdges.push_back({ aNodes[0], 1 });
 }
 
-vec2 CPathfinder::GetRandomWaypoint()
+// breadth-first distances from the tile to every tile of the cluster, -1 if it is not reachable inside the cluster
+void CPathfinder::ClusterDistances(CSearch* pSearch, int FromTile, int Cluster) const
 {
-	array<vec2> lPossibleWaypoints;
-	for (int i = 0; i < m_LayerHeight; i++)
+	const CBounds Bounds = ClusterBounds(Cluster);
+	auto LocalIndex = [&](int Tile) { return (Tile / m_LayerWidth - Bounds.m_MinY) * CLUSTER_SIZE + Tile % m_LayerWidth - Bounds.m_MinX; };
+
+	std::vector<int>& aDistance = pSearch->m_aDistance;
+	std::vector<int>& aQueue = pSearch->m_aQueue;
+	aDistance.assign(CLUSTER_SIZE * CLUSTER_SIZE, -1);
+	aQueue.clear();
+
+	aDistance[LocalIndex(FromTile)] = 0;
+	aQueue.push_back(FromTile);
+	for(size_t Head = 0; Head < aQueue.size(); Head++)
 	{
-		for (int j = 0; j < m_LayerWidth; j++)
+		const int Tile = aQueue[Head];
+		const int x = Tile % m_LayerWidth;
+		const int y = Tile / m_LayerWidth;
+		const int aNeighbours[4] = { x + 1 < Bounds.m_MaxX ? Tile + 1 : -1, x > Bounds.m_MinX ? Tile - 1 : -1,
+			y + 1 < Bounds.m_MaxY ? Tile + m_LayerWidth : -1, y > Bounds.m_MinY ? Tile - m_LayerWidth : -1 };
+		for(int Next : aNeighbours)
+		{
+			if(Next < 0 || m_lMap[Next].m_IsCol || aDistance[LocalIndex(Next)] != -1)
+				continue;
+
+			aDistance[LocalIndex(Next)] = aDistance[LocalIndex(Tile)] + 1;
+			aQueue.push_back(Next);
+		}
+	}
+}
+
+void CPathfinder::FindPath(CSearch* pSearch, vec2 StartPos, vec2 SearchPos, std::vector<vec2>& aPath) const
+{
+	const int From = GetIndex(clamp((int)(StartPos.x / 32), 0, m_LayerWidth - 1), clamp((int)(StartPos.y / 32), 0, m_LayerHeight - 1));
+	const int To = GetIndex(clamp((int)(SearchPos.x / 32), 0, m_LayerWidth - 1), clamp((int)(SearchPos.y / 32), 0, m_LayerHeight - 1));
+
+	std::vector<int>& aTiles = pSearch->m_aTiles;
+	aTiles.clear();
+
+	bool Found = false;
+	if(m_aTileArea[From] != -1 && m_aTileArea[From] == m_aTileArea[To])
+	{
+		if(ClusterOf(From) == ClusterOf(To))
+			Found = FindGridPath(pSearch, From, To, ClusterBounds(ClusterOf(From)), CLUSTER_SIZE * CLUSTER_SIZE, false, aTiles);
+		if(!Found)
+		{
+			aTiles.clear();
+			Found = FindNavPath(pSearch, From, To, aTiles);
+		}
+	}
+
+	// the target can not be reached, go as close as the limited search on the tiles gets
+	if(!Found)
+	{
+		aTiles.clear();
+		FindGridPath(pSearch, From, To, { 0, 0, m_LayerWidth, m_LayerHeight }, MAX_WAY_CALC, true, aTiles);
+	}
+
+	aPath.reserve(aTiles.size());
+	for(int Tile : aTiles)
+		aPath.push_back(vec2(m_lMap[Tile].m_Pos.x * 32 + 16, m_lMap[Tile].m_Pos.y * 32 + 16));
+}
+
+// A* over the tiles inside the bounds, with Partial the path to the last closed tile is kept when the limit is reached
+bool CPathfinder::FindGridPath(CSearch* pSearch, int From, int To, const CBounds& Bounds, int MaxClosed, bool Partial, std::vector<int>& aTiles) const
+{
+	CSearchState& Grid = pSearch->m_Grid;
+	Grid.Prepare(m_lMap.size());
+
+	const int EndX = To % m_LayerWidth;
+	const int EndY = To / m_LayerWidth;
+	Grid.State(From).m_IsOpen = true;
+	Grid.m_Open.Insert(From, 0);
+
+	int ClosedNodes = 0;
+	int CurrentIndex = From;
+	bool Found = false;
+	bool Limited = false;
+	while (Grid.m_Open.GetSize() > 0)
+	{
+		// get Lowest F from heap and set it to closed list
+		CurrentIndex = Grid.m_Open.GetMin();
+		Grid.m_Open.RemoveMin();
+		CSearchState::CState& Current = Grid.State(CurrentIndex);
+		Current.m_IsClosed = true;
+		if (CurrentIndex == To)
+		{
+			Found = true;
+			break;
+		}
+		if (++ClosedNodes >= MaxClosed)
 		{
-			if (m_lMap[i * m_LayerWidth + j].m_IsClosed || m_lMap[i * m_LayerWidth + j].m_IsCol)
+			Limited = true;
+			break;
+		}
+
+		const int x = CurrentIndex % m_LayerWidth;
+		const int y = CurrentIndex / m_LayerWidth;
+		const int aWorkingIndex[4] = { x + 1 < Bounds.m_MaxX ? CurrentIndex + 1 : -1, x > Bounds.m_MinX ? CurrentIndex - 1 : -1,
+			y + 1 < Bounds.m_MaxY ? CurrentIndex + m_LayerWidth : -1, y > Bounds.m_MinY ? CurrentIndex - m_LayerWidth : -1 };
+		for (int WorkingIndex : aWorkingIndex)
+		{
+			if (WorkingIndex < 0 || m_lMap[WorkingIndex].m_IsCol)
 				continue;
 
-			lPossibleWaypoints.add(m_lMap[i * m_LayerWidth + j].m_Pos);
+			CSearchState::CState& Working = Grid.State(WorkingIndex);
+			if (Working.m_IsClosed || (Working.m_IsOpen && Working.m_G <= Current.m_G + 1))
+				continue;
+
+			Working.m_Parent = CurrentIndex;
+			Working.m_G = Current.m_G + 1;
+			const int F = Working.m_G + abs(WorkingIndex % m_LayerWidth - EndX) + abs(WorkingIndex / m_LayerWidth - EndY);
+			if (Working.m_IsOpen)
+			{
+				Grid.m_Open.DecreaseKey(WorkingIndex, F);
+			}
+			else
+			{
+				Working.m_IsOpen = true;
+				Grid.m_Open.Insert(WorkingIndex, F);
+			}
+		}
+	}
+
+	if (!Found && !(Partial && Limited))
+		return false;
+
+	// go backwards and return final path from the start
+	const size_t Begin = aTiles.size();
+	for (; CurrentIndex != From; CurrentIndex = Grid.State(CurrentIndex).m_Parent)
+		aTiles.push_back(CurrentIndex);
+	std::reverse(aTiles.begin() + Begin, aTiles.end());
+	return Found;
+}
+
+// A* over the entrances of the clusters, then every step is refined to tiles inside its cluster
+bool CPathfinder::FindNavPath(CSearch* pSearch, int From, int To, std::vector<int>& aTiles) const
+{
+	const int StartCluster = ClusterOf(From);
+	const int EndCluster = ClusterOf(To);
+	const int START = (int)m_aNavNodes.size();
+	const int END = START + 1;
+
+	// temporary links of the start and the end to the entrances of their clusters
+	auto LinkEntrances = [&](int Tile, int Cluster, std::vector<CNavEdge>& aEdges)
+	{
+		const CBounds Bounds = ClusterBounds(Cluster);
+		ClusterDistances(pSearch, Tile, Cluster);
+		aEdges.clear();
+		for(int Node : m_aClusterNodes[Cluster])
+		{
+			const int NodeTile = m_aNavNodes[Node].m_Tile;
+			const int Distance = pSearch->m_aDistance[(NodeTile / m_LayerWidth - Bounds.m_MinY) * CLUSTER_SIZE + NodeTile % m_LayerWidth - Bounds.m_MinX];
+			if(Distance >= 0)
+				aEdges.push_back({ Node, Distance });
+		}
+	};
+	LinkEntrances(From, StartCluster, pSearch->m_aStartEdges);
+	LinkEntrances(To, EndCluster, pSearch->m_aEndEdges);
+
+	auto TileOf = [&](int Node) { return Node == START ? From : (Node == END ? To : m_aNavNodes[Node].m_Tile); };
+	const int EndX = To % m_LayerWidth;
+	const int EndY = To / m_LayerWidth;
+
+	CSearchState& Nav = pSearch->m_Nav;
+	Nav.Prepare(START + 2);
+	Nav.State(START).m_IsOpen = true;
+	Nav.m_Open.Insert(START, 0);
+
+	auto Relax = [&](int CurrentNode, int Node, int Cost)
+	{
+		const int G = Nav.State(CurrentNode).m_G + Cost;
+		CSearchState::CState& Working = Nav.State(Node);
+		if(Working.m_IsClosed || (Working.m_IsOpen && Working.m_G <= G))
+			return;
+
+		Working.m_Parent = CurrentNode;
+		Working.m_G = G;
+		const int Tile = TileOf(Node);
+		const int F = G + abs(Tile % m_LayerWidth - EndX) + abs(Tile / m_LayerWidth - EndY);
+		if(Working.m_IsOpen)
+		{
+			Nav.m_Open.DecreaseKey(Node, F);
+		}
+		else
+		{
+			Working.m_IsOpen = true;
+			Nav.m_Open.Insert(Node, F);
+		}
+	};
+
+	bool Found = false;
+	while(Nav.m_Open.GetSize() > 0)
+	{
+		const int CurrentNode = Nav.m_Open.GetMin();
+		Nav.m_Open.RemoveMin();
+		Nav.State(CurrentNode).m_IsClosed = true;
+		if(CurrentNode == END)
+		{
+			Found = true;
+			break;
+		}
+
+		const std::vector<CNavEdge>& aEdges = CurrentNode == START ? pSearch->m_aStartEdges : m_aNavNodes[CurrentNode].m_aEdges;
+		for(const CNavEdge& Edge : aEdges)
+			Relax(CurrentNode, Edge.m_To, Edge.m_Cost);
+
+		if(CurrentNode != START && m_aNavNodes[CurrentNode].m_Cluster == EndCluster)
+		{
+			for(const CNavEdge& Edge : pSearch->m_aEndEdges)
+			{
+				if(Edge.m_To == CurrentNode)
+					Relax(CurrentNode, END, Edge.m_Cost);
+			}
 		}
 	}
 
-	if (lPossibleWaypoints.size())
+	if(!Found)
+		return false;
+
+	std::vector<int>& aNavPath = pSearch->m_aNavPath;
+	aNavPath.clear();
+	for(int Node = END; Node != START; Node = Nav.State(Node).m_Parent)
+		aNavPath.push_back(Node);
+	std::reverse(aNavPath.begin(), aNavPath.end());
+
+	// steps between clusters are neighbour tiles, steps inside a cluster are searched on its tiles
+	int PrevTile = From;
+	for(int Node : aNavPath)
 	{
-		int Rand = secure_rand() % lPossibleWaypoints.size();
-		return lPossibleWaypoints[Rand];
+		const int Tile = TileOf(Node);
+		if(Tile == PrevTile)
+			continue;
+
+		if(ClusterOf(Tile) != ClusterOf(PrevTile))
+			aTiles.push_back(Tile);
+		else if(!FindGridPath(pSearch, PrevTile, Tile, ClusterBounds(ClusterOf(Tile)), CLUSTER_SIZE * CLUSTER_SIZE, false, aTiles))
+			return false;
+		PrevTile = Tile;
 	}
-	return vec2(0, 0);
-}
\ No newline at end of file
+	return true;
+}
+
+// a random walkable tile in the clusters around the position, reachable from it if possible
+vec2 CPathfinder::GetRandomWaypoint(vec2 Around) const
+{
+	if(m_aWalkableTiles.empty())
+		return vec2(0, 0);
+
+	const int CenterX = clamp((int)(Around.x / 32), 0, m_LayerWidth - 1);
+	const int CenterY = clamp((int)(Around.y / 32), 0, m_LayerHeight - 1);
+	const int Area = m_aTileArea[GetIndex(CenterX, CenterY)];
+	for(int Try = 0; Try < 8; Try++)
+	{
+		const int ClusterX = clamp(CenterX / CLUSTER_SIZE + random_num(-ROAM_CLUSTERS, ROAM_CLUSTERS), 0, m_ClustersX - 1);
+		const int ClusterY = clamp(CenterY / CLUSTER_SIZE + random_num(-ROAM_CLUSTERS, ROAM_CLUSTERS), 0, m_ClustersY - 1);
+		const int Cluster = ClusterY * m_ClustersX + ClusterX;
+		const int NumTiles = m_aWalkableOffsets[Cluster + 1] - m_aWalkableOffsets[Cluster];
+		if(NumTiles <= 0)
+			continue;
+
+		const int Tile = m_aWalkableTiles[m_aWalkableOffsets[Cluster] + random_int() % NumTiles];
+		if(Area == -1 || m_aTileArea[Tile] == Area)
+			return m_lMap[Tile].m_Pos;
+	}
+
+	return m_lMap[m_aWalkableTiles[random_int() % m_aWalkableTiles.size()]].m_Pos;
+}
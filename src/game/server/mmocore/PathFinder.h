@@ -1,70 +1,111 @@
 #ifndef GAME_PATHFIND_H
 #define GAME_PATHFIND_H
 
+#include <base/tl/array.h>
+
 #include "BinaryHeap.h"
 
 #define MAX_WAY_CALC 50000
 
-// player object
+// shared pathfinding of a world, the searches are done by the workers of the server
 class CPathfinder
 {
 public:
-	CPathfinder(class CLayers* Layers, class CCollision* Collision);
+	CPathfinder(class IServer* pServer, class CLayers* Layers, class CCollision* Collision);
 	~CPathfinder();
 
 	struct CNode
 	{
 		vec2 m_Pos;
-		int m_Parent;
-		int m_ID;
-		int m_G;
-		int m_H;
-		int m_F;
 		bool m_IsCol;
-		bool m_IsClosed;
-		bool m_IsOpen;
+	};
 
-		bool operator<(const CNode& Other) const { return (this->m_F < Other.m_F); }
-		bool operator==(const CNode& Other) const { return (this->m_ID < Other.m_ID); }
+	struct CResult
+	{
+		int m_ClientID;
+		int m_RequestID;
+		vec2 m_Target;
+		std::vector<vec2> m_aPath;
 	};
 
-	void Init();
-	void SetStart(vec2 Pos);
-	void SetEnd(vec2 Pos);
+	// queue the search, the results are picked up by the world with TakeResults,
+	// the returned id is unique in the world so a result can be matched with the request that is still wanted
+	int RequestPath(int ClientID, vec2 StartPos, vec2 SearchPos);
+	void TakeResults(std::vector<CResult>& aResults);
 
 	int GetIndex(int XPos, int YPos) const;
-
-	vec2 GetRandomWaypoint();
-
-	void FindPath();
+	vec2 GetRandomWaypoint(vec2 Around) const;
 
 	array<CNode> m_lMap;
-	array<CNode> m_lFinalPath;
 
-	int m_FinalSize;
 private:
+	class CSearch;
+
+	/*
+		Navigation graph (hierarchical A*)
+		The map is split into clusters, the walkable tiles on both sides of a cluster border are the
+		entrances. Entrances are linked to their neighbour across the border and to the other entrances
+		of their cluster, so a search crosses the map on the small graph and is refined cluster by cluster.
+	*/
 	enum
 	{
-		START = -3,
-		END = -4,
+		CLUSTER_SIZE = 16,
+		ROAM_CLUSTERS = 4,
 	};
 
-	class CLayers *m_pLayers;
-	class CCollision *m_pCollision;
+	struct CBounds
+	{
+		int m_MinX;
+		int m_MinY;
+		int m_MaxX;
+		int m_MaxY;
+	};
 
-	array<CNode> m_lNodes;
+	struct CNavEdge
+	{
+		int m_To;
+		int m_Cost;
+	};
+
+	struct CNavNode
+	{
+		int m_Tile;
+		int m_Cluster;
+		std::vector<CNavEdge> m_aEdges;
+	};
+
+	std::vector<CNavNode> m_aNavNodes;
+	std::vector<std::vector<int>> m_aClusterNodes;
+	std::vector<int> m_aTileArea;
 
-	// binary heap for open nodes
-	CBinaryHeap<CNode> m_Open;
+	// walkable tiles grouped by cluster, the tiles of a cluster start at its offset
+	std::vector<int> m_aWalkableTiles;
+	std::vector<int> m_aWalkableOffsets;
+	int m_ClustersX;
+	int m_ClustersY;
 
-	int m_StartIndex;
-	int m_EndIndex;
+	void BuildNavigation();
+	void AddTransition(std::unordered_map<int, int>& aTileNodes, int TileA, int TileB);
+	int ClusterOf(int Tile) const;
+	CBounds ClusterBounds(int Cluster) const;
+	void ClusterDistances(CSearch* pSearch, int FromTile, int Cluster) const;
+
+	void FindPath(CSearch* pSearch, vec2 StartPos, vec2 SearchPos, std::vector<vec2>& aPath) const;
+	bool FindGridPath(CSearch* pSearch, int From, int To, const CBounds& Bounds, int MaxClosed, bool Partial, std::vector<int>& aTiles) const;
+	bool FindNavPath(CSearch* pSearch, int From, int To, std::vector<int>& aTiles) const;
+	void AddResult(CResult&& Result);
+
+	class IServer *m_pServer;
+	class CLayers *m_pLayers;
+	class CCollision *m_pCollision;
 
 	int m_LayerWidth;
 	int m_LayerHeight;
 
-	// fake array sizes
-	int m_ClosedNodes;
+	std::mutex m_ResultsLock;
+	std::vector<CResult> m_aResults;
+	std::atomic<int> m_PendingRequests;
+	int m_LastRequestID;
 };
 
 #endif
@@ -2,6 +2,8 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "player.h"
 
+#include <engine/shared/config.h>
+
 #include "gamecontext.h"
 #include "gamemodes/dungeon.h"
 
@@ -15,7 +17,7 @@
 #include "mmocore/Components/Inventory/ItemData.h"
 #include "mmocore/Components/Skills/SkillData.h"
 
-MACRO_ALLOC_POOL_ID_IMPL(CPlayer, MAX_CLIENTS * ENGINE_MAX_WORLDS + MAX_CLIENTS)
+MACRO_ALLOC_SLAB_IMPL(CPlayer, 32)
 
 IServer* CPlayer::Server() const { return m_pGS->Server(); };
 CPlayer::CPlayer(CGS *pGS, int ClientID) : m_pGS(pGS), m_ClientID(ClientID)
@@ -28,6 +30,7 @@ CPlayer::CPlayer(CGS *pGS, int ClientID) : m_pGS(pGS), m_ClientID(ClientID)
 	m_aPlayerTick[TickState::Die] = Server()->Tick();
 	m_PrevTuningParams = *pGS->Tuning();
 	m_NextTuningParams = m_PrevTuningParams;
+	m_ItemsAttributesDirty = true;
 
 	// constructor only for players
 	if(m_ClientID < MAX_PLAYERS)
@@ -36,6 +39,11 @@ CPlayer::CPlayer(CGS *pGS, int ClientID) : m_pGS(pGS), m_ClientID(ClientID)
 		m_OpenVoteMenu = MenuList::MAIN_MENU;
 		m_MoodState = MOOD_NORMAL;
 		Acc().m_Team = GetStartTeam();
+
+		// the entries of the client are created here, so the worlds ticked in parallel don't insert into the shared maps
+		GetTempData();
+		CSkillData::ms_aSkills[m_ClientID];
+		CQuestData::ms_aPlayerQuests[m_ClientID];
 		GS()->SendTuningParams(ClientID);
 		ClearTalking();
 	}
@@ -43,6 +51,11 @@ CPlayer::CPlayer(CGS *pGS, int ClientID) : m_pGS(pGS), m_ClientID(ClientID)
 
 CPlayer::~CPlayer()
 {
+	if(m_pMenuQuery)
+		m_pMenuQuery->Cancel();
+	if(m_pAuthQuery)
+		m_pAuthQuery->Cancel();
+
 	m_aHiddenMenu.clear();
 	delete m_pCharacter;
 	m_pCharacter = nullptr;
@@ -63,6 +76,9 @@ void CPlayer::Tick()
 		return;
 
 	Server()->SetClientScore(m_ClientID, Acc().m_Level);
+	if((Server()->Tick() + m_ClientID) % (Server()->TickSpeed() * g_Config.m_SvSaveInterval) == 0)
+		GS()->Mmo()->FlushAccount(this);
+
 	{
 		IServer::CClientInfo Info;
 		if (Server()->GetClientInfo(m_ClientID, &Info))
@@ -108,9 +124,10 @@ void CPlayer::PostTick()
 
 void CPlayer::EffectsTick()
 {
-	if(Server()->Tick() % Server()->TickSpeed() != 0 || CGS::ms_aEffects[m_ClientID].empty())
+	if(Server()->Tick() % Server()->TickSpeed() != 0)
 		return;
 
+	std::lock_guard<std::mutex> Lock(CGS::ms_EffectsLock);
 	for(auto pEffect = CGS::ms_aEffects[m_ClientID].begin(); pEffect != CGS::ms_aEffects[m_ClientID].end();)
 	{
 		pEffect->second--;
@@ -158,7 +175,11 @@ void CPlayer::Snap(int SnappingClient)
 	if(!Server()->ClientIngame(m_ClientID))
 		return;
 
-	CNetObj_PlayerInfo *pPlayerInfo = static_cast<CNetObj_PlayerInfo *>(Server()->SnapNewItem(NETOBJTYPE_PLAYERINFO, m_ClientID, sizeof(CNetObj_PlayerInfo)));
+	const int ProtocolID = Server()->TranslateClientID(GS()->GetWorldID(), m_ClientID);
+	if(ProtocolID < 0)
+		return;
+
+	CNetObj_PlayerInfo *pPlayerInfo = static_cast<CNetObj_PlayerInfo *>(Server()->SnapNewItem(NETOBJTYPE_PLAYERINFO, ProtocolID, sizeof(CNetObj_PlayerInfo)));
 	if(!pPlayerInfo)
 		return;
 
@@ -174,7 +195,7 @@ void CPlayer::Snap(int SnappingClient)
 	if(!GS()->IsMmoClient(SnappingClient) || GetTeam() == TEAM_SPECTATORS || !IsAuthed())
 		return;
 
-	CNetObj_Mmo_ClientInfo *pClientInfo = static_cast<CNetObj_Mmo_ClientInfo *>(Server()->SnapNewItem(NETOBJTYPE_MMO_CLIENTINFO, m_ClientID, sizeof(CNetObj_Mmo_ClientInfo)));
+	CNetObj_Mmo_ClientInfo *pClientInfo = static_cast<CNetObj_Mmo_ClientInfo *>(Server()->SnapNewItem(NETOBJTYPE_MMO_CLIENTINFO, ProtocolID, sizeof(CNetObj_Mmo_ClientInfo)));
 	if(!pClientInfo)
 		return;
 
@@ -189,6 +210,7 @@ void CPlayer::Snap(int SnappingClient)
 	pClientInfo->m_Armor = GetMana();
 
 	dynamic_string Buffer;
+	std::unique_lock<std::mutex> EffectsLock(CGS::ms_EffectsLock);
 	for (auto& eff : CGS::ms_aEffects[m_ClientID])
 	{
 		char aBuf[32];
@@ -196,6 +218,7 @@ void CPlayer::Snap(int SnappingClient)
 		str_format(aBuf, sizeof(aBuf), "%s %d%s ", eff.first.c_str(), Minutes ? eff.second / 60 : eff.second, Minutes ? "m" : "");
 		Buffer.append_at(Buffer.length(), aBuf);
 	}
+	EffectsLock.unlock();
 	StrToInts(pClientInfo->m_Potions, 12, Buffer.buffer());
 	Buffer.clear();
 
@@ -245,8 +268,7 @@ void CPlayer::TryRespawn()
 		GetTempData().m_TempTeleportPos = vec2(-1, -1);
 	}
 
-	const int AllocMemoryCell = MAX_CLIENTS*GS()->GetWorldID()+m_ClientID;
-	m_pCharacter = new(AllocMemoryCell) CCharacter(&GS()->m_World);
+	m_pCharacter = new CCharacter(&GS()->m_World);
 	m_pCharacter->Spawn(this, SpawnPos);
 	GS()->CreatePlayerSpawn(SpawnPos);
 	m_Spawned = false;
@@ -380,24 +402,29 @@ void CPlayer::GiveEffect(const char* Potion, int Sec, float Chance)
 	if(RandomChance < Chance)
 	{
 		GS()->Chat(m_ClientID, "You got the effect {STR} time {INT}sec.", Potion, Sec);
-		CGS::ms_aEffects[m_ClientID][Potion] = Sec;
+		{
+			std::lock_guard<std::mutex> Lock(CGS::ms_EffectsLock);
+			CGS::ms_aEffects[m_ClientID][Potion] = Sec;
+		}
 		GS()->CreateTextEffect(m_pCharacter->m_Core.m_Pos, Potion, TEXTEFFECT_FLAG_POTION|TEXTEFFECT_FLAG_ADDING);
 	}
 }
 
 bool CPlayer::IsActiveEffect(const char* Potion) const
 {
+	std::lock_guard<std::mutex> Lock(CGS::ms_EffectsLock);
 	return CGS::ms_aEffects[m_ClientID].find(Potion) != CGS::ms_aEffects[m_ClientID].end();
 }
 
 void CPlayer::ClearEffects()
 {
+	std::lock_guard<std::mutex> Lock(CGS::ms_EffectsLock);
 	CGS::ms_aEffects[m_ClientID].clear();
 }
 
-const char *CPlayer::GetLanguage() const
+CLocalization::CLanguage *CPlayer::GetLanguage() const
 {
-	return Server()->GetClientLanguage(m_ClientID);
+	return Server()->GetClientLanguageInfo(m_ClientID);
 }
 
 void CPlayer::UpdateTempData(int Health, int Mana)
@@ -576,9 +603,9 @@ bool CPlayer::ParseVoteUpgrades(const char *CMD, const int VoteID, const int Vot
 
 CItemData& CPlayer::GetItem(int ItemID)
 {
-	CItemData::ms_aItems[m_ClientID][ItemID].m_ItemID = ItemID;
-	CItemData::ms_aItems[m_ClientID][ItemID].SetItemOwner(this);
-	return CItemData::ms_aItems[m_ClientID][ItemID];
+	CItemData& Item = CItemData::ms_aItems[m_ClientID][ItemID];
+	Item.SetItemOwner(this);
+	return Item;
 }
 
 CSkillData& CPlayer::GetSkill(int SkillID)
@@ -597,11 +624,15 @@ CQuestData& CPlayer::GetQuest(int QuestID)
 
 int CPlayer::GetEquippedItemID(int EquipID, int SkipItemID) const
 {
-	for(const auto& it : CItemData::ms_aItems[m_ClientID])
+	if(m_ItemsAttributesDirty)
+		UpdateItemsAttributes();
+
+	for(int ItemID : m_aEquippedItems)
 	{
-		if(!it.second.m_Value || !it.second.m_Settings || it.second.Info().m_Function != EquipID || it.first == SkipItemID)
+		const CItemData& Item = CItemData::ms_aItems[m_ClientID][ItemID];
+		if(!Item.m_Value || !Item.m_Settings || Item.Info().m_Function != EquipID || ItemID == SkipItemID)
 			continue;
-		return it.first;
+		return ItemID;
 	}
 	return -1;
 }
@@ -627,18 +658,41 @@ int CPlayer::GetAttributeCount(int BonusID, bool ActiveFinalStats)
 	return AttributEx;
 }
 
-// TODO: not optimized algorithm
 int CPlayer::GetItemsAttributeCount(int AttributeID) const
 {
-	int SummingSize = 0;
-	for(const auto& it : CItemData::ms_aItems[m_ClientID])
+	if(AttributeID < StSpreadShotgun || AttributeID >= STATS_PLAYER_NUM)
+		return 0;
+
+	if(m_ItemsAttributesDirty)
+		UpdateItemsAttributes();
+	return m_aItemsAttributes[AttributeID];
+}
+
+void CPlayer::UpdateItemsAttributes() const
+{
+	mem_zero(m_aItemsAttributes, sizeof(m_aItemsAttributes));
+	m_aEquippedItems.clear();
+	for(const CItemData& Item : CItemData::ms_aItems[m_ClientID])
 	{
-		if(!it.second.IsEquipped() || !it.second.Info().IsEnchantable() || !it.second.Info().GetInfoEnchantStats(AttributeID))
+		if(!Item.m_Value || !Item.m_Settings)
 			continue;
 
-		SummingSize += it.second.GetEnchantStats(AttributeID);
+		m_aEquippedItems.push_back(Item.GetID());
+		if(!Item.IsEquipped() || !Item.Info().IsEnchantable())
+			continue;
+
+		const int *pAttributes = Item.Info().m_aAttribute;
+		for(int i = 0; i < STATS_MAX_FOR_ITEM; i++)
+		{
+			// an attribute listed twice on the item is counted once
+			const int AttributeID = pAttributes[i];
+			if(AttributeID < StSpreadShotgun || AttributeID >= STATS_PLAYER_NUM || std::find(pAttributes, pAttributes + i, AttributeID) != pAttributes + i)
+				continue;
+
+			m_aItemsAttributes[AttributeID] += Item.GetEnchantStats(AttributeID);
+		}
 	}
-	return SummingSize;
+	m_ItemsAttributesDirty = false;
 }
 
 int CPlayer::GetLevelTypeAttribute(int Class)
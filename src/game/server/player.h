@@ -8,6 +8,7 @@
 #include "mmocore/Components/Quests/QuestData.h"
 #include "mmocore/Components/Skills/SkillData.h"
 
+#include <engine/server/sql_connect_pool.h>
 #include <game/voting.h>
 #include "entities/character.h"
 
@@ -19,7 +20,7 @@ enum
 
 class CPlayer
 {
-	MACRO_ALLOC_POOL_ID()
+	MACRO_ALLOC_SLAB()
 
 	struct StructLatency
 	{
@@ -45,6 +46,12 @@ class CPlayer
 	char m_aFormatDialogText[512];
 	std::map < int, bool > m_aHiddenMenu;
 
+	// equipped items and the sums of their attributes, rebuilt on the first read after the inventory changes
+	mutable int m_aItemsAttributes[STATS_PLAYER_NUM];
+	mutable std::vector<int> m_aEquippedItems;
+	mutable bool m_ItemsAttributesDirty;
+	void UpdateItemsAttributes() const;
+
 protected:
 	CCharacter* m_pCharacter;
 	CGS* m_pGS;
@@ -80,6 +87,13 @@ public:
 	CVoteOptionsCallback m_ActiveMenuOptionCallback;
 	VoteCallBack m_ActiveMenuRegisteredCallback;
 
+	// asynchronous database queries, they are canceled together with the player
+	SqlQueryHandle m_pMenuQuery;
+	SqlQueryHandle m_pAuthQuery;
+
+	// the rows of the menu are not there yet, the footer is added together with them
+	bool IsMenuLoading() const { return m_pMenuQuery && !m_pMenuQuery->IsDone() && !m_pMenuQuery->IsCanceled(); }
+
 	/* #########################################################################
 		FUNCTIONS PLAYER ENGINE
 	######################################################################### */
@@ -104,6 +118,7 @@ public:
 	virtual int GetEquippedItemID(int EquipID, int SkipItemID = -1) const;
 	virtual int GetAttributeCount(int BonusID, bool ActiveFinalStats = false);
 	int GetItemsAttributeCount(int AttributeID) const;
+	void InvalidateItemsAttributes() { m_ItemsAttributesDirty = true; }
 	virtual void UpdateTempData(int Health, int Mana);
 	virtual void SendClientInfo(int TargetID);
 
@@ -139,7 +154,7 @@ public:
 		FUNCTIONS PLAYER ACCOUNT
 	######################################################################### */
 	bool SpendCurrency(int Price, int ItemID = 1);
-	const char* GetLanguage() const;
+	CLocalization::CLanguage* GetLanguage() const;
 	void AddExp(int Exp);
 	void AddMoney(int Money);
 
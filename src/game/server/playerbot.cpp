@@ -10,17 +10,21 @@
 #include "mmocore/Components/Bots/BotCore.h"
 #include "mmocore/Components/Worlds/WorldSwapCore.h"
 
-MACRO_ALLOC_POOL_ID_IMPL(CPlayerBot, MAX_CLIENTS * ENGINE_MAX_WORLDS + MAX_CLIENTS)
+MACRO_ALLOC_SLAB_IMPL(CPlayerBot, 64)
 
 CPlayerBot::CPlayerBot(CGS *pGS, int ClientID, int BotID, int SubBotID, int SpawnPoint)
 	: CPlayer(pGS, ClientID), m_BotType(SpawnPoint), m_BotID(BotID), m_SubBotID(SubBotID), m_BotHealth(0), m_LastPosTick(0), m_PathSize(0)
 {
 	m_DungeonAllowedSpawn = false;
+	m_PathRequestID = 0;
 	(this)->SendClientInfo(-1);
 }
 
 CPlayerBot::~CPlayerBot()
 {
+	// the slot can be taken by another bot before the search is done
+	m_PathRequestID = 0;
+
 	for(int i = 0; i < MAX_PLAYERS; i++)
 		DataBotInfo::ms_aDataBot[m_BotID].m_aActiveQuestBot[i] = false;
 
@@ -29,6 +33,7 @@ CPlayerBot::~CPlayerBot()
 	Msg.m_pReason = "\0";
 	Msg.m_Silent = true;
 	Server()->SendPackMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_NORECORD, -1, (this)->GetPlayerWorldID());
+	Server()->UnmapClientID(GS()->GetWorldID(), m_ClientID);
 
 	delete m_pCharacter;
 	m_pCharacter = nullptr;
@@ -39,6 +44,10 @@ void CPlayerBot::Tick()
 	if(!Server()->ClientIngame(m_ClientID))
 		return;
 
+	// the id was taken by a player when the world was full, the bot is shown again once an id is free
+	if(Server()->TranslateClientID(GS()->GetWorldID(), m_ClientID) == -1 && Server()->MapClientID(GS()->GetWorldID(), m_ClientID) != -1)
+		SendClientInfo(-1);
+
 	if(m_pCharacter && !m_pCharacter->IsAlive())
 	{
 		delete m_pCharacter;
@@ -50,7 +59,7 @@ void CPlayerBot::Tick()
 		if(m_pCharacter->IsAlive() && GS()->CheckingPlayersDistance(m_pCharacter->GetPos(), 1000.0f))
 		{
 			m_ViewPos = m_pCharacter->GetPos();
-			ThreadMobsPathFinder();
+			RequestMobsPathFinder();
 		}
 		else
 		{
@@ -68,6 +77,25 @@ void CPlayerBot::PostTick()
 	EffectsTick();
 }
 
+// catch up the per-second timers of a bot whose world was dormant
+void CPlayerBot::FastForward(int Ticks)
+{
+	const int Seconds = Ticks / Server()->TickSpeed();
+	if(Seconds <= 0)
+		return;
+
+	for(auto pEffect = m_aEffects.begin(); pEffect != m_aEffects.end();)
+	{
+		pEffect->second -= Seconds;
+		if(pEffect->second <= 0)
+		{
+			pEffect = m_aEffects.erase(pEffect);
+			continue;
+		}
+		++pEffect;
+	}
+}
+
 void CPlayerBot::EffectsTick()
 {
 	if(Server()->Tick() % Server()->TickSpeed() != 0)
@@ -175,8 +203,7 @@ void CPlayerBot::TryRespawn()
 	}
 
 	// create character
-	const int AllocMemoryCell = MAX_CLIENTS*GS()->GetWorldID()+m_ClientID;
-	m_pCharacter = new(AllocMemoryCell) CCharacterBotAI(&GS()->m_World);
+	m_pCharacter = new CCharacterBotAI(&GS()->m_World);
 	m_pCharacter->Spawn(this, SpawnPos);
 
 	// so that no effects can be seen that an NPC that is not visible to one player is visible to another player
@@ -233,7 +260,11 @@ void CPlayerBot::Snap(int SnappingClient)
 	if(!Server()->ClientIngame(m_ClientID) || !IsActiveSnappingBot(SnappingClient))
 		return;
 
-	CNetObj_PlayerInfo *pPlayerInfo = static_cast<CNetObj_PlayerInfo *>(Server()->SnapNewItem(NETOBJTYPE_PLAYERINFO, m_ClientID, sizeof(CNetObj_PlayerInfo)));
+	const int ProtocolID = Server()->TranslateClientID(GS()->GetWorldID(), m_ClientID);
+	if(ProtocolID < 0)
+		return;
+
+	CNetObj_PlayerInfo *pPlayerInfo = static_cast<CNetObj_PlayerInfo *>(Server()->SnapNewItem(NETOBJTYPE_PLAYERINFO, ProtocolID, sizeof(CNetObj_PlayerInfo)));
 	if(!pPlayerInfo)
 		return;
 
@@ -245,7 +276,7 @@ void CPlayerBot::Snap(int SnappingClient)
 	if(!GS()->IsMmoClient(SnappingClient))
 		return;
 
-	CNetObj_Mmo_ClientInfo *pClientInfo = static_cast<CNetObj_Mmo_ClientInfo *>(Server()->SnapNewItem(NETOBJTYPE_MMO_CLIENTINFO, m_ClientID, sizeof(CNetObj_Mmo_ClientInfo)));
+	CNetObj_Mmo_ClientInfo *pClientInfo = static_cast<CNetObj_Mmo_ClientInfo *>(Server()->SnapNewItem(NETOBJTYPE_MMO_CLIENTINFO, ProtocolID, sizeof(CNetObj_Mmo_ClientInfo)));
 	if(!pClientInfo)
 		return;
 
@@ -382,65 +413,46 @@ int CPlayerBot::GetPlayerWorldID() const
 	return QuestBotInfo::ms_aQuestBot[m_SubBotID].m_WorldID;
 }
 
-std::atomic_flag g_ThreadPathWritedNow;
-void CPlayerBot::FindThreadPath(CGS* pGameServer, CPlayerBot* pBotPlayer, vec2 StartPos, vec2 SearchPos)
+void CPlayerBot::HandlePathResult(CPathfinder::CResult& Result)
 {
-	if(!pGameServer || !pBotPlayer || length(StartPos) <= 0 || length(SearchPos) <= 0 || g_ThreadPathWritedNow.test_and_set(std::memory_order_acquire))
+	// the result of an older bot in this slot or of a search that was replaced
+	if(Result.m_RequestID != m_PathRequestID)
 		return;
 
-	while(pBotPlayer->m_ThreadReadNow.load(std::memory_order_acquire))
-		std::this_thread::sleep_for(std::chrono::microseconds(1));
-	pGameServer->PathFinder()->Init();
-	pGameServer->PathFinder()->SetStart(StartPos);
-	pGameServer->PathFinder()->SetEnd(SearchPos);
-	pGameServer->PathFinder()->FindPath();
-	pBotPlayer->m_PathSize = pGameServer->PathFinder()->m_FinalSize;
-	for(int i = pBotPlayer->m_PathSize - 1, j = 0; i >= 0; i--, j++)
-		pBotPlayer->m_WayPoints[j] = vec2(pGameServer->PathFinder()->m_lFinalPath[i].m_Pos.x * 32 + 16, pGameServer->PathFinder()->m_lFinalPath[i].m_Pos.y * 32 + 16);
-
-	g_ThreadPathWritedNow.clear(std::memory_order_release);
-}
+	m_PathRequestID = 0;
 
-void CPlayerBot::GetThreadRandomWaypointTarget(CGS* pGameServer, CPlayerBot* pBotPlayer)
-{
-	if(!pGameServer || !pBotPlayer || g_ThreadPathWritedNow.test_and_set(std::memory_order_acquire))
+	// the target has moved away while the path was searched
+	if(m_TargetPos == vec2(0, 0) || distance(Result.m_Target, m_TargetPos) > 128.0f)
 		return;
 
-	while(pBotPlayer->m_ThreadReadNow.load(std::memory_order_acquire))
-		std::this_thread::sleep_for(std::chrono::microseconds(1));
-	const vec2 TargetPos = pGameServer->PathFinder()->GetRandomWaypoint();
-	pBotPlayer->m_TargetPos = vec2(TargetPos.x * 32, TargetPos.y * 32);
-
-	g_ThreadPathWritedNow.clear(std::memory_order::memory_order_release);
+	m_WayPoints.swap(Result.m_aPath);
+	m_PathSize = (int)m_WayPoints.size();
 }
 
-void CPlayerBot::ThreadMobsPathFinder()
+void CPlayerBot::RequestMobsPathFinder()
 {
-	if(!m_pCharacter || !m_pCharacter->IsAlive())
+	if(!m_pCharacter || !m_pCharacter->IsAlive() || m_PathRequestID)
 		return;
 
 	if(GetBotType() == TYPE_BOT_MOB)
 	{
 		if(m_TargetPos != vec2(0, 0) && (Server()->Tick() + 3 * m_ClientID) % (Server()->TickSpeed()) == 0)
 		{
-			std::thread(&FindThreadPath, GS(), this, m_ViewPos, m_TargetPos).detach();
+			if(length(m_ViewPos) <= 0)
+				return;
+
+			m_PathRequestID = GS()->PathFinder()->RequestPath(m_ClientID, m_ViewPos, m_TargetPos);
 		}
 		else if(m_TargetPos == vec2(0, 0) || distance(m_ViewPos, m_TargetPos) < 60.0f)
 		{
 			m_LastPosTick = Server()->Tick() + (Server()->TickSpeed() * 2 + rand() % 4);
-			std::thread(&GetThreadRandomWaypointTarget, GS(), this).detach();
+			m_TargetPos = GS()->PathFinder()->GetRandomWaypoint(MobBotInfo::ms_aMobBot[m_SubBotID].m_Position) * 32.0f;
 		}
 	}
 }
 
 void CPlayerBot::ClearWayPoint()
 {
-	if(!m_WayPoints.empty())
-	{
-		bool Status = false;
-		if(!m_ThreadReadNow.compare_exchange_strong(Status, true, std::memory_order::memory_order_acquire, std::memory_order::memory_order_relaxed))
-			return;
-		m_WayPoints.clear();
-		m_ThreadReadNow.store(false, std::memory_order::memory_order_release);
-	}
+	m_WayPoints.clear();
+	m_PathSize = 0;
 }
\ No newline at end of file
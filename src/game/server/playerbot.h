@@ -4,30 +4,30 @@
 #define GAME_SERVER_PLAYER_BOT_H
 
 #include "player.h"
+#include "mmocore/PathFinder.h"
 
 class CPlayerBot : public CPlayer
 {
-	MACRO_ALLOC_POOL_ID()
+	MACRO_ALLOC_SLAB()
 
 	int m_BotType;
 	int m_BotID;
 	int m_SubBotID;
 	int m_BotHealth;
 	int m_DungeonAllowedSpawn;
-	std::map<int, vec2> m_WayPoints;
+	std::vector<vec2> m_WayPoints;
+	int m_PathRequestID; // the search in flight, 0 if none
 
 public:
 	int m_LastPosTick;
 	int m_PathSize;
 	vec2 m_TargetPos;
-	std::atomic_bool m_ThreadReadNow;
 
 	CPlayerBot(CGS *pGS, int ClientID, int BotID, int SubBotID, int SpawnPoint);
 	~CPlayerBot() override;
 
 	vec2& GetWayPoint(int Index) { return m_WayPoints[Index]; }
-	static void FindThreadPath(CGS* pGameServer, CPlayerBot* pBotPlayer, vec2 StartPos, vec2 SearchPos);
-	static void GetThreadRandomWaypointTarget(CGS* pGameServer, CPlayerBot* pBotPlayer);
+	void HandlePathResult(CPathfinder::CResult& Result);
 	void ClearWayPoint();
 
 	int GetTeam() override { return TEAM_BLUE; }
@@ -56,6 +56,7 @@ public:
 	void Tick() override;
 	void PostTick() override;
 	void Snap(int SnappingClient) override;
+	void FastForward(int Ticks);
 	void SetDungeonAllowedSpawn(bool Spawn) { m_DungeonAllowedSpawn = Spawn; }
 
 private:
@@ -70,9 +71,9 @@ private:
 	void GenerateNick(char* buffer, int size_buffer) const;
 
 	/***********************************************************************************/
-	/*  Thread path finderdon't want to secure m_TargetPos, or m_WayPoints with mutex  */
+	/*  Path finder requests, the results come back through HandlePathResult            */
 	/***********************************************************************************/
-	void ThreadMobsPathFinder();
+	void RequestMobsPathFinder();
 };
 
 #endif
@@ -185,6 +185,16 @@ MACRO_CONFIG_STR(SvMySqlLogin, sv_sql_login, 32, "root", CFGFLAG_SERVER, "MySQL
 MACRO_CONFIG_STR(SvMySqlPassword, sv_sql_password, 32, "", CFGFLAG_SERVER, "MySQL Password")
 MACRO_CONFIG_INT(SvMySqlPort, sv_sql_port, 3306, 0, 65000, CFGFLAG_SERVER, "MySQL Port")
 MACRO_CONFIG_INT(SvMySqlPoolSize, sv_sql_pool_size, 3, 1, 12, CFGFLAG_SERVER, "MySQL Pool size");
+MACRO_CONFIG_INT(SvMySqlQueueSize, sv_sql_queue_size, 512, 16, 65536, CFGFLAG_SERVER, "Maximum pending asynchronous queries per MySQL pool worker")
+MACRO_CONFIG_INT(SvWorldThreads, sv_world_threads, 0, 0, 64, CFGFLAG_SERVER, "Number of threads that tick the worlds in parallel (0 - all worlds are ticked in the main thread)")
+MACRO_CONFIG_INT(SvSaveInterval, sv_save_interval, 10, 1, 600, CFGFLAG_SERVER, "Seconds between writes of the changed account data to the database")
+MACRO_CONFIG_INT(SvPathfinderThreads, sv_pathfinder_threads, 2, 1, 16, CFGFLAG_SERVER, "Number of threads that search the paths of the mobs")
+MACRO_CONFIG_INT(SvSnapThreads, sv_snap_threads, 0, 0, 64, CFGFLAG_SERVER, "Number of threads that delta and compress the snapshots of the clients (0 - done in the main thread)")
+MACRO_CONFIG_INT(SvDormantWorlds, sv_dormant_worlds, 1, 0, 1, CFGFLAG_SERVER, "Stop the simulation of worlds without players")
+MACRO_CONFIG_INT(SvDormantDelay, sv_dormant_delay, 10, 0, 600, CFGFLAG_SERVER, "Seconds without players before a world becomes dormant")
+MACRO_CONFIG_INT(SvProfiler, sv_profiler, 1, 0, 1, CFGFLAG_SERVER, "Measure the tick, snapshot and database times (profiler command)")
+MACRO_CONFIG_INT(SvProfilerDump, sv_profiler_dump, 0, 0, 3600, CFGFLAG_SERVER, "Seconds between writes of the profiler to sv_profiler_dump_file (0 - disabled)")
+MACRO_CONFIG_STR(SvProfilerDumpFile, sv_profiler_dump_file, 128, "profiler.json", CFGFLAG_SERVER, "File the profiler is written to")
 
 MACRO_CONFIG_INT(SvLoltextHspace, sv_loltext_hspace, 7, 7, 25, CFGFLAG_SERVER, "horizontal offset between loltext 'pixels'")
 MACRO_CONFIG_INT(SvLoltextVspace, sv_loltext_vspace, 7, 7, 25, CFGFLAG_SERVER, "vertical offset between loltext 'pixels'")
@@ -10,7 +10,7 @@
 #include <cstdarg>
 
 CLocalization::CLanguage::CLanguage()
-	: m_Loaded(false), m_Direction(CLocalization::DIRECTION_LTR),
+	: m_Loaded(false), m_Direction(CLocalization::DIRECTION_LTR), m_pParent(nullptr),
 	m_pPluralRules(nullptr), m_pValueFormater(nullptr), m_pNumberFormater(nullptr), m_pPercentFormater(nullptr)
 {
 	m_aName[0] = 0;
@@ -19,7 +19,7 @@ CLocalization::CLanguage::CLanguage()
 }
 
 CLocalization::CLanguage::CLanguage(const char* pName, const char* pFilename, const char* pParentFilename)
-	: m_Loaded(false), m_Direction(CLocalization::DIRECTION_LTR),
+	: m_Loaded(false), m_Direction(CLocalization::DIRECTION_LTR), m_pParent(nullptr),
 	m_pPluralRules(nullptr), m_pValueFormater(nullptr), m_pNumberFormater(nullptr), m_pPercentFormater(nullptr)
 {
 	str_copy(m_aName, pName, sizeof(m_aName));
@@ -342,12 +342,30 @@ bool CLocalization::Init()
 		}
 	}
 
+	// the parents are resolved once, so the fallback doesn't search them by name
+	for(int i = 0; i < m_pLanguages.size(); i++)
+	{
+		for(int j = 0; j < m_pLanguages.size() && m_pLanguages[i]->GetParentFilename()[0]; j++)
+		{
+			if(i != j && str_comp(m_pLanguages[j]->GetFilename(), m_pLanguages[i]->GetParentFilename()) == 0)
+			{
+				m_pLanguages[i]->m_pParent = m_pLanguages[j];
+				break;
+			}
+		}
+	}
+
+	// the fallbacks of the main language are used by every client
+	CLanguage* pParent = m_pMainLanguage ? m_pMainLanguage->GetParent() : nullptr;
+	for(int Depth = 0; pParent && Depth < 4; pParent = pParent->GetParent(), Depth++)
+		LoadLanguage(pParent);
+
 	// clean up
 	json_value_free(pJsonData);
 	return true;
 }
 
-const char* CLocalization::LocalizeWithDepth(const char* pLanguageCode, const char* pText, int Depth)
+CLocalization::CLanguage* CLocalization::GetLanguage(const char* pLanguageCode)
 {
 	CLanguage* pLanguage = m_pMainLanguage;
 	if(pLanguageCode)
@@ -362,61 +380,64 @@ const char* CLocalization::LocalizeWithDepth(const char* pLanguageCode, const ch
 		}
 	}
 
-	if(!pLanguage)
-		return pText;
+	if(pLanguage)
+		LoadLanguage(pLanguage);
+	return pLanguage;
+}
+
+void CLocalization::LoadLanguage(CLanguage* pLanguage)
+{
+	if(pLanguage->IsLoaded())
+		return;
 
+	std::lock_guard<std::mutex> Lock(m_LoadLock);
 	if(!pLanguage->IsLoaded())
 		pLanguage->Load(this, Storage());
+}
+
+const char* CLocalization::LocalizeWithDepth(CLanguage* pLanguage, const char* pText, int Depth)
+{
+	if(!pLanguage)
+		return pText;
+
+	LoadLanguage(pLanguage);
 
 	const char* pResult = pLanguage->Localize(pText);
 	if(pResult)
 		return pResult;
-	if(pLanguage->GetParentFilename()[0] && Depth < 4)
-		return LocalizeWithDepth(pLanguage->GetParentFilename(), pText, Depth + 1);
+	if(pLanguage->GetParent() && Depth < 4)
+		return LocalizeWithDepth(pLanguage->GetParent(), pText, Depth + 1);
 	return pText;
 }
 
-const char* CLocalization::Localize(const char* pLanguageCode, const char* pText)
+const char* CLocalization::Localize(CLanguage* pLanguage, const char* pText)
 {
-	return LocalizeWithDepth(pLanguageCode, pText, 0);
+	return LocalizeWithDepth(pLanguage ? pLanguage : m_pMainLanguage, pText, 0);
 }
 
-const char* CLocalization::LocalizeWithDepth_P(const char* pLanguageCode, int Number, const char* pText, int Depth)
+const char* CLocalization::LocalizeWithDepth_P(CLanguage* pLanguage, int Number, const char* pText, int Depth)
 {
-	CLanguage* pLanguage = m_pMainLanguage;
-	if(pLanguageCode)
-	{
-		for(int i = 0; i < m_pLanguages.size(); i++)
-		{
-			if(str_comp(m_pLanguages[i]->GetFilename(), pLanguageCode) == 0)
-			{
-				pLanguage = m_pLanguages[i];
-				break;
-			}
-		}
-	}
-
 	if(!pLanguage)
 		return pText;
 
-	if(!pLanguage->IsLoaded())
-		pLanguage->Load(this, Storage());
+	LoadLanguage(pLanguage);
 
 	const char* pResult = pLanguage->Localize_P(Number, pText);
 	if(pResult)
 		return pResult;
-	if(pLanguage->GetParentFilename()[0] && Depth < 4)
-		return LocalizeWithDepth_P(pLanguage->GetParentFilename(), Number, pText, Depth + 1);
+	if(pLanguage->GetParent() && Depth < 4)
+		return LocalizeWithDepth_P(pLanguage->GetParent(), Number, pText, Depth + 1);
 	return pText;
 }
 
-const char* CLocalization::Localize_P(const char* pLanguageCode, int Number, const char* pText)
+const char* CLocalization::Localize_P(CLanguage* pLanguage, int Number, const char* pText)
 {
-	return LocalizeWithDepth_P(pLanguageCode, Number, pText, 0);
+	return LocalizeWithDepth_P(pLanguage ? pLanguage : m_pMainLanguage, Number, pText, 0);
 }
 
 void CLocalization::AppendNumber(dynamic_string& Buffer, int& BufferIter, CLanguage* pLanguage, int Number)
 {
+	std::lock_guard<std::mutex> Lock(m_ConverterLock);
 	UChar aBufUtf16[128];
 
 	UErrorCode Status = U_ZERO_ERROR;
@@ -443,6 +464,7 @@ void CLocalization::AppendNumber(dynamic_string& Buffer, int& BufferIter, CLangu
 
 void CLocalization::AppendValue(dynamic_string& Buffer, int& BufferIter, CLanguage* pLanguage, int Number)
 {
+	std::lock_guard<std::mutex> Lock(m_ConverterLock);
 	UChar aBufUtf16[128];
 
 	UErrorCode Status = U_ZERO_ERROR;
@@ -468,6 +490,7 @@ void CLocalization::AppendValue(dynamic_string& Buffer, int& BufferIter, CLangua
 
 void CLocalization::AppendPercent(dynamic_string& Buffer, int& BufferIter, CLanguage* pLanguage, double Number)
 {
+	std::lock_guard<std::mutex> Lock(m_ConverterLock);
 	UChar aBufUtf16[128];
 
 	UErrorCode Status = U_ZERO_ERROR;
@@ -491,103 +514,110 @@ void CLocalization::AppendPercent(dynamic_string& Buffer, int& BufferIter, CLang
 	}
 }
 
-void CLocalization::Format_V(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs)
+void CLocalization::CFormat::Compile(const char* pText)
 {
-	CLanguage* pLanguage = m_pMainLanguage;
-	if(pLanguageCode)
+	m_Text = pText;
+	m_aParts.clear();
+
+	// the parameters are {STR}, {INT}, {VAL} and {PRC}, unknown ones are dropped and an unclosed one cuts the rest
+	const char* pStr = m_Text.c_str();
+	int Start = 0;
+	for(int Iter = 0; pStr[Iter]; Iter++)
 	{
-		for(int i = 0; i < m_pLanguages.size(); i++)
-		{
-			if(str_comp(m_pLanguages[i]->GetFilename(), pLanguageCode) != 0)
-				continue;
+		if(pStr[Iter] != '{')
+			continue;
 
-			pLanguage = m_pLanguages[i];
-			break;
+		int End = Iter + 1;
+		while(pStr[End] && pStr[End] != '}')
+			End++;
+		if(!pStr[End])
+		{
+			if(Iter > Start)
+				m_aParts.push_back({PART_TEXT, Start, Iter - Start});
+			return;
 		}
-	}
 
-	if(!pLanguage)
-	{
-		Buffer.append(pText);
-		return;
+		if(Iter > Start)
+			m_aParts.push_back({PART_TEXT, Start, Iter - Start});
+
+		const char* pType = pStr + Iter + 1;
+		if(str_comp_num("STR", pType, 3) == 0)
+			m_aParts.push_back({PART_STR, 0, 0});
+		else if(str_comp_num("INT", pType, 3) == 0)
+			m_aParts.push_back({PART_INT, 0, 0});
+		else if(str_comp_num("VAL", pType, 3) == 0)
+			m_aParts.push_back({PART_VAL, 0, 0});
+		else if(str_comp_num("PRC", pType, 3) == 0)
+			m_aParts.push_back({PART_PRC, 0, 0});
+
+		Iter = End;
+		Start = End + 1;
 	}
 
-	// start parameters of the end of the name and type string
+	const int Length = (int)m_Text.size();
+	if(Length > Start)
+		m_aParts.push_back({PART_TEXT, Start, Length - Start});
+}
+
+void CLocalization::FormatCompiled(dynamic_string& Buffer, CLanguage* pLanguage, const CFormat* pFormat, va_list VarArgs)
+{
 	const int BufferStart = Buffer.length();
 	int BufferIter = BufferStart;
-	int ParamTypeStart = -1;
 
 	// argument parsing
 	va_list VarArgsIter;
 	va_copy(VarArgsIter, VarArgs);
 
-	// character positions
-	int Iter = 0;
-	int Start = 0;
-
-	// parse text to search for positions
-	while(pText[Iter])
+	const char* pText = pFormat->m_Text.c_str();
+	for(const CFormat::CPart& Part : pFormat->m_aParts)
 	{
-		if(ParamTypeStart >= 0)
+		switch(Part.m_Type)
 		{
-			if(pText[Iter] != '}')
-			{
-				Iter = str_utf8_forward(pText, Iter);
-				continue;
-			}
-
-			// we get data from an argument parsing arguments
-			if(str_comp_num("STR", pText + ParamTypeStart, 3) == 0)
-			{
-				const char* pVarArgValue = va_arg(VarArgsIter, const char*);
-				const char* pTranslatedValue = pLanguage->Localize(pVarArgValue);
-				BufferIter = Buffer.append_at(BufferIter, (pTranslatedValue ? pTranslatedValue : pVarArgValue));
-			}
-			else if(str_comp_num("INT", pText + ParamTypeStart, 3) == 0)
-			{
-				const int pVarArgValue = va_arg(VarArgsIter, int);
-				AppendNumber(Buffer, BufferIter, pLanguage, pVarArgValue);
-			}
-			else if(str_comp_num("VAL", pText + ParamTypeStart, 3) == 0)
-			{
-				const int pVarArgValue = va_arg(VarArgsIter, int);
-				AppendValue(Buffer, BufferIter, pLanguage, pVarArgValue);
-			}
-			else if(str_comp_num("PRC", pText + ParamTypeStart, 3) == 0)
-			{
-				const double pVarArgValue = va_arg(VarArgsIter, double);
-				AppendPercent(Buffer, BufferIter, pLanguage, pVarArgValue);
-			}
-
-			//
-			Start = Iter + 1;
-			ParamTypeStart = -1;
-		}
-
-		// parameter parsing start
-		else
+		case CFormat::PART_TEXT:
+			BufferIter = Buffer.append_at_num(BufferIter, pText + Part.m_Start, Part.m_Length);
+			break;
+		case CFormat::PART_STR:
 		{
-			if(pText[Iter] == '{')
-			{
-				BufferIter = Buffer.append_at_num(BufferIter, pText + Start, Iter - Start);
-				Iter++;
-				ParamTypeStart = Iter;
-			}
+			const char* pVarArgValue = va_arg(VarArgsIter, const char*);
+			const char* pTranslatedValue = pLanguage->Localize(pVarArgValue);
+			BufferIter = Buffer.append_at(BufferIter, (pTranslatedValue ? pTranslatedValue : pVarArgValue));
+			break;
+		}
+		case CFormat::PART_INT:
+			AppendNumber(Buffer, BufferIter, pLanguage, va_arg(VarArgsIter, int));
+			break;
+		case CFormat::PART_VAL:
+			AppendValue(Buffer, BufferIter, pLanguage, va_arg(VarArgsIter, int));
+			break;
+		case CFormat::PART_PRC:
+			AppendPercent(Buffer, BufferIter, pLanguage, va_arg(VarArgsIter, double));
+			break;
 		}
-
-		Iter = str_utf8_forward(pText, Iter);
 	}
 
 	// close the argument macro
 	va_end(VarArgsIter);
 
-	if(Iter > 0 && ParamTypeStart == -1)
-		Buffer.append_at_num(BufferIter, pText + Start, Iter - Start);
-
 	if(pLanguage->GetWritingDirection() == DIRECTION_RTL)
 		ArabicShaping(Buffer, BufferStart);
 }
 
+void CLocalization::Format_V(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, va_list VarArgs)
+{
+	if(!pLanguage)
+		pLanguage = m_pMainLanguage;
+	if(!pLanguage)
+	{
+		Buffer.append(pText);
+		return;
+	}
+
+	// the texts that are formatted without localization are mostly built at runtime, they are not cached
+	CFormat Format;
+	Format.Compile(pText);
+	FormatCompiled(Buffer, pLanguage, &Format, VarArgs);
+}
+
 void CLocalization::Format(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...)
 {
 	va_list VarArgs;
@@ -598,11 +628,51 @@ void CLocalization::Format(dynamic_string& Buffer, const char* pLanguageCode, co
 	va_end(VarArgs);
 }
 
-void CLocalization::Format_VL(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs)
+void CLocalization::Format(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, ...)
 {
-	const char* pLocalText = Localize(pLanguageCode, pText);
+	va_list VarArgs;
+	va_start(VarArgs, pText);
 
-	Format_V(Buffer, pLanguageCode, pLocalText, VarArgs);
+	Format_V(Buffer, pLanguage, pText, VarArgs);
+
+	va_end(VarArgs);
+}
+
+void CLocalization::Format_VL(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, va_list VarArgs)
+{
+	if(!pLanguage)
+		pLanguage = m_pMainLanguage;
+	if(!pLanguage)
+	{
+		Buffer.append(pText);
+		return;
+	}
+
+	// the translation of the text is compiled on the first use in this language
+	const CFormat* pFormat = nullptr;
+	{
+		std::lock_guard<std::mutex> Lock(pLanguage->m_FormatsLock);
+		auto Iter = pLanguage->m_Formats.find(pText);
+		if(Iter != pLanguage->m_Formats.end())
+			pFormat = &Iter->second;
+	}
+
+	if(!pFormat)
+	{
+		CFormat Format;
+		Format.Compile(Localize(pLanguage, pText));
+
+		std::lock_guard<std::mutex> Lock(pLanguage->m_FormatsLock);
+		if((int)pLanguage->m_Formats.size() < CLanguage::MAX_FORMATS)
+			pFormat = &pLanguage->m_Formats.emplace(pText, std::move(Format)).first->second;
+		else
+		{
+			FormatCompiled(Buffer, pLanguage, &Format, VarArgs);
+			return;
+		}
+	}
+
+	FormatCompiled(Buffer, pLanguage, pFormat, VarArgs);
 }
 
 void CLocalization::Format_L(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...)
@@ -615,11 +685,21 @@ void CLocalization::Format_L(dynamic_string& Buffer, const char* pLanguageCode,
 	va_end(VarArgs);
 }
 
-void CLocalization::Format_VLP(dynamic_string& Buffer, const char* pLanguageCode, int Number, const char* pText, va_list VarArgs)
+void CLocalization::Format_L(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, ...)
+{
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+
+	Format_VL(Buffer, pLanguage, pText, VarArgs);
+
+	va_end(VarArgs);
+}
+
+void CLocalization::Format_VLP(dynamic_string& Buffer, CLanguage* pLanguage, int Number, const char* pText, va_list VarArgs)
 {
-	const char* pLocalText = Localize_P(pLanguageCode, Number, pText);
+	const char* pLocalText = Localize_P(pLanguage, Number, pText);
 
-	Format_V(Buffer, pLanguageCode, pLocalText, VarArgs);
+	Format_V(Buffer, pLanguage, pLocalText, VarArgs);
 }
 
 void CLocalization::Format_LP(dynamic_string& Buffer, const char* pLanguageCode, int Number, const char* pText, ...)
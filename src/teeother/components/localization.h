@@ -24,8 +24,41 @@ public:
 		NUM_PLURALTYPES,
 	};
 
+	// a text split once into the parts that are copied and the parameters, formatting it is a single pass
+	class CFormat
+	{
+	public:
+		enum
+		{
+			PART_TEXT=0,
+			PART_STR,
+			PART_INT,
+			PART_VAL,
+			PART_PRC,
+		};
+
+		struct CPart
+		{
+			int m_Type;
+			int m_Start;
+			int m_Length;
+		};
+
+		std::string m_Text;
+		std::vector<CPart> m_aParts;
+
+		void Compile(const char* pText);
+	};
+
 	class CLanguage
 	{
+		friend class CLocalization;
+
+		enum
+		{
+			MAX_FORMATS=4096, // texts that are not keys (already formatted ones) must not grow the cache forever
+		};
+
 	protected:
 		class CEntry
 		{
@@ -49,10 +82,15 @@ public:
 		char m_aName[64];
 		char m_aFilename[64];
 		char m_aParentFilename[64];
-		bool m_Loaded;
+		std::atomic<bool> m_Loaded;
 		int m_Direction;
 
 		hashtable< CEntry, 128 > m_Translations;
+		CLanguage* m_pParent;
+
+		// compiled formats by the untranslated text
+		std::mutex m_FormatsLock;
+		std::unordered_map<std::string, CFormat> m_Formats;
 
 	public:
 		UPluralRules* m_pPluralRules;
@@ -65,6 +103,7 @@ public:
 		~CLanguage();
 
 		inline const char* GetParentFilename() const { return m_aParentFilename; }
+		inline CLanguage* GetParent() const { return m_pParent; }
 		inline const char* GetFilename() const { return m_aFilename; }
 		inline const char* GetName() const { return m_aName; }
 		inline int GetWritingDirection() const { return m_Direction; }
@@ -85,18 +124,22 @@ public:
 protected:
 	CLanguage* m_pMainLanguage;
 	UConverter* m_pUtf8Converter;
+	std::mutex m_ConverterLock; // the converter keeps a state, the worlds can format at the same time
+	std::mutex m_LoadLock; // the languages are loaded on the first use, it can be in any world
 
 public:
 	array<CLanguage*> m_pLanguages;
 	fixed_string128 m_Cfg_MainLanguage;
 
 protected:
-	const char* LocalizeWithDepth(const char* pLanguageCode, const char* pText, int Depth);
-	const char* LocalizeWithDepth_P(const char* pLanguageCode, int Number, const char* pText, int Depth);
+	void LoadLanguage(CLanguage* pLanguage);
+	const char* LocalizeWithDepth(CLanguage* pLanguage, const char* pText, int Depth);
+	const char* LocalizeWithDepth_P(CLanguage* pLanguage, int Number, const char* pText, int Depth);
 
 	void AppendNumber(dynamic_string& Buffer, int& BufferIter, CLanguage* pLanguage, int Number);
 	void AppendValue(dynamic_string& Buffer, int& BufferIter, CLanguage* pLanguage, int Number);
 	void AppendPercent(dynamic_string& Buffer, int& BufferIter, CLanguage* pLanguage, double Number);
+	void FormatCompiled(dynamic_string& Buffer, CLanguage* pLanguage, const CFormat* pFormat, va_list VarArgs);
 
 public:
 	CLocalization(class IStorageEngine* pStorage);
@@ -107,19 +150,29 @@ public:
 
 	inline bool GetWritingDirection() const { return (!m_pMainLanguage ? DIRECTION_LTR : m_pMainLanguage->GetWritingDirection()); }
 
+	//language of the code, the main language when there is none, resolve it once and keep the pointer
+	CLanguage* GetLanguage(const char* pLanguageCode);
+
 	//localize
-	const char* Localize(const char* pLanguageCode, const char* pText);
+	const char* Localize(const char* pLanguageCode, const char* pText) { return Localize(GetLanguage(pLanguageCode), pText); }
+	const char* Localize(CLanguage* pLanguage, const char* pText);
 	//localize and find the appropriate plural form based on Number
-	const char* Localize_P(const char* pLanguageCode, int Number, const char* pText);
+	const char* Localize_P(const char* pLanguageCode, int Number, const char* pText) { return Localize_P(GetLanguage(pLanguageCode), Number, pText); }
+	const char* Localize_P(CLanguage* pLanguage, int Number, const char* pText);
 
 	//format
-	void Format_V(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs);
+	void Format_V(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs) { Format_V(Buffer, GetLanguage(pLanguageCode), pText, VarArgs); }
+	void Format_V(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, va_list VarArgs);
 	void Format(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...);
+	void Format(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, ...);
 	//localize, format
-	void Format_VL(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs);
+	void Format_VL(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs) { Format_VL(Buffer, GetLanguage(pLanguageCode), pText, VarArgs); }
+	void Format_VL(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, va_list VarArgs);
 	void Format_L(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...);
+	void Format_L(dynamic_string& Buffer, CLanguage* pLanguage, const char* pText, ...);
 	//localize, find the appropriate plural form based on Number and format
-	void Format_VLP(dynamic_string& Buffer, const char* pLanguageCode, int Number, const char* pText, va_list VarArgs);
+	void Format_VLP(dynamic_string& Buffer, const char* pLanguageCode, int Number, const char* pText, va_list VarArgs) { Format_VLP(Buffer, GetLanguage(pLanguageCode), Number, pText, VarArgs); }
+	void Format_VLP(dynamic_string& Buffer, CLanguage* pLanguage, int Number, const char* pText, va_list VarArgs);
 	void Format_LP(dynamic_string& Buffer, const char* pLanguageCode, int Number, const char* pText, ...);
 
 	void ArabicShaping(dynamic_string& Buffer, int BufferStart = 0);
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <thread>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <string>
 #include <functional>
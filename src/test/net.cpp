@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+enum
+{
+	PACKET_STRIDE = 64,
+	MAX_PACKETS = 160,
+};
+
+// binds a socket of the address' type to the first free port
+static bool CreateSocket(NETSOCKET *pSocket, NETADDR *pAddr)
+{
+	for(int i = 0; i < 256; i++)
+	{
+		pAddr->port = 20000 + (pid() + i * 101) % 20000;
+		*pSocket = net_udp_create(*pAddr, 0);
+		if((pSocket->type&pAddr->type) == pAddr->type)
+			return true;
+		net_udp_close(*pSocket);
+	}
+	return false;
+}
+
+static void FillPacket(unsigned char *pData, int *pSize, int Index)
+{
+	*pSize = 1 + (Index * 7) % (PACKET_STRIDE - 1);
+	for(int i = 0; i < *pSize; i++)
+		pData[i] = (unsigned char)(Index + i);
+}
+
+// receives until Num packets arrived, the loopback delivers them right away
+static int RecvAll(NETSOCKET Socket, NETADDR *pAddrs, unsigned char *pData, int *pSizes, int Num)
+{
+	int Received = 0;
+	for(int Tries = 0; Received < Num && Tries < 100; Tries++)
+	{
+		int Got = net_udp_recv_batch(Socket, pAddrs + Received, pData + Received * PACKET_STRIDE, pSizes + Received, PACKET_STRIDE, Num - Received);
+		if(Got == 0)
+			thread_sleep(1);
+		Received += Got;
+	}
+	return Received;
+}
+
+static void ExpectPacket(const unsigned char *pData, int Size, int Index)
+{
+	unsigned char aExpected[PACKET_STRIDE];
+	int ExpectedSize;
+	FillPacket(aExpected, &ExpectedSize, Index);
+	ASSERT_EQ(Size, ExpectedSize);
+	EXPECT_EQ(mem_comp(pData, aExpected, Size), 0);
+}
+
+static void SendRecv(const char *pLocalhost, int Num)
+{
+	NETSOCKET Sender, Receiver;
+	NETADDR SenderAddr, ReceiverAddr;
+	ASSERT_EQ(net_addr_from_str(&SenderAddr, pLocalhost), 0);
+	ReceiverAddr = SenderAddr;
+	if(!CreateSocket(&Receiver, &ReceiverAddr))
+		GTEST_SKIP() << "no " << pLocalhost << " loopback";
+	ASSERT_TRUE(CreateSocket(&Sender, &SenderAddr));
+
+	static unsigned char s_aSend[MAX_PACKETS * PACKET_STRIDE];
+	static unsigned char s_aRecv[MAX_PACKETS * PACKET_STRIDE];
+	NETADDR aTargets[MAX_PACKETS];
+	NETADDR aFrom[MAX_PACKETS];
+	int aSendSizes[MAX_PACKETS];
+	int aRecvSizes[MAX_PACKETS];
+	for(int i = 0; i < Num; i++)
+	{
+		aTargets[i] = ReceiverAddr;
+		FillPacket(s_aSend + i * PACKET_STRIDE, &aSendSizes[i], i);
+	}
+
+	EXPECT_EQ(net_udp_send_batch(Sender, aTargets, s_aSend, aSendSizes, PACKET_STRIDE, Num), Num);
+	ASSERT_EQ(RecvAll(Receiver, aFrom, s_aRecv, aRecvSizes, Num), Num);
+	for(int i = 0; i < Num; i++)
+	{
+		ExpectPacket(s_aRecv + i * PACKET_STRIDE, aRecvSizes[i], i);
+		EXPECT_EQ(net_addr_comp(&aFrom[i], &SenderAddr, 1), 0);
+	}
+
+	net_udp_close(Sender);
+	net_udp_close(Receiver);
+}
+
+TEST(NetBatch, Ipv4)
+{
+	SendRecv("127.0.0.1", 10);
+}
+
+TEST(NetBatch, Ipv6)
+{
+	SendRecv("[::1]", 10);
+}
+
+TEST(NetBatch, MoreThanOneBatch)
+{
+	SendRecv("127.0.0.1", 150);
+}
+
+TEST(NetBatch, Mixed)
+{
+	NETSOCKET Sender, Receiver4, Receiver6;
+	NETADDR SenderAddr, Receiver4Addr, Receiver6Addr;
+	net_addr_from_str(&Receiver4Addr, "127.0.0.1");
+	net_addr_from_str(&Receiver6Addr, "[::1]");
+	mem_zero(&SenderAddr, sizeof(SenderAddr));
+	SenderAddr.type = NETTYPE_ALL;
+	if(!CreateSocket(&Receiver6, &Receiver6Addr))
+		GTEST_SKIP() << "no IPv6 loopback";
+	ASSERT_TRUE(CreateSocket(&Receiver4, &Receiver4Addr));
+	ASSERT_TRUE(CreateSocket(&Sender, &SenderAddr));
+
+	// every third packet goes to IPv6, so both families are split over several batches
+	const int Num = 100;
+	static unsigned char s_aSend[MAX_PACKETS * PACKET_STRIDE];
+	static unsigned char s_aRecv4[MAX_PACKETS * PACKET_STRIDE];
+	static unsigned char s_aRecv6[MAX_PACKETS * PACKET_STRIDE];
+	NETADDR aTargets[MAX_PACKETS];
+	NETADDR aFrom4[MAX_PACKETS];
+	NETADDR aFrom6[MAX_PACKETS];
+	int aSendSizes[MAX_PACKETS];
+	int aRecv4Sizes[MAX_PACKETS];
+	int aRecv6Sizes[MAX_PACKETS];
+	int Num4 = 0;
+	int Num6 = 0;
+	for(int i = 0; i < Num; i++)
+	{
+		if(i % 3 == 0)
+		{
+			aTargets[i] = Receiver6Addr;
+			Num6++;
+		}
+		else
+		{
+			aTargets[i] = Receiver4Addr;
+			Num4++;
+		}
+		FillPacket(s_aSend + i * PACKET_STRIDE, &aSendSizes[i], i);
+	}
+
+	EXPECT_EQ(net_udp_send_batch(Sender, aTargets, s_aSend, aSendSizes, PACKET_STRIDE, Num), Num);
+	ASSERT_EQ(RecvAll(Receiver4, aFrom4, s_aRecv4, aRecv4Sizes, Num4), Num4);
+	ASSERT_EQ(RecvAll(Receiver6, aFrom6, s_aRecv6, aRecv6Sizes, Num6), Num6);
+
+	NETADDR From4, From6;
+	net_addr_from_str(&From4, "127.0.0.1");
+	net_addr_from_str(&From6, "[::1]");
+	From4.port = From6.port = SenderAddr.port;
+
+	// each family keeps the order it was sent in
+	int Index4 = 0;
+	int Index6 = 0;
+	for(int i = 0; i < Num; i++)
+	{
+		if(i % 3 == 0)
+		{
+			ExpectPacket(s_aRecv6 + Index6 * PACKET_STRIDE, aRecv6Sizes[Index6], i);
+			EXPECT_EQ(net_addr_comp(&aFrom6[Index6], &From6, 1), 0);
+			Index6++;
+		}
+		else
+		{
+			ExpectPacket(s_aRecv4 + Index4 * PACKET_STRIDE, aRecv4Sizes[Index4], i);
+			EXPECT_EQ(net_addr_comp(&aFrom4[Index4], &From4, 1), 0);
+			Index4++;
+		}
+	}
+
+	net_udp_close(Sender);
+	net_udp_close(Receiver4);
+	net_udp_close(Receiver6);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/network.h>
+
+class CNetServerIndex : public ::testing::Test
+{
+protected:
+	CNetServer *m_pServer;
+
+	void SetUp()
+	{
+		m_pServer = new CNetServer;
+
+		// the tokens of the server are random
+		ASSERT_EQ(secure_random_init(), 0);
+
+		NETADDR BindAddr;
+		net_addr_from_str(&BindAddr, "127.0.0.1");
+		ASSERT_TRUE(m_pServer->Open(BindAddr, 0, NET_MAX_CLIENTS, NET_MAX_CLIENTS, 0, 0, 0));
+	}
+
+	void TearDown()
+	{
+		m_pServer->Close();
+		delete m_pServer;
+	}
+
+	static int Hash(const NETADDR *pAddr) { return CNetServer::AddrHash(pAddr); }
+	int Find(const NETADDR *pAddr) const { return m_pServer->FindSlot(pAddr); }
+	int FirstInBucket(int Hash) const { return m_pServer->m_aAddrHashFirst[Hash]; }
+	int SlotBucket(int ClientID) const { return m_pServer->m_aSlots[ClientID].m_AddrHash; }
+
+	// puts the slot online with the peer address like an accepted connect does
+	void Connect(int ClientID, const NETADDR *pAddr)
+	{
+		NETADDR Addr = *pAddr;
+		m_pServer->m_aSlots[ClientID].m_Connection.Connect(&Addr);
+		m_pServer->HashSlot(ClientID);
+	}
+
+	void Drop(int ClientID) { m_pServer->Drop(ClientID, 0); }
+
+	int BucketLength(int Hash) const
+	{
+		int Length = 0;
+		for(int i = m_pServer->m_aAddrHashFirst[Hash]; i != -1; i = m_pServer->m_aSlots[i].m_NextInHash)
+			Length++;
+		return Length;
+	}
+
+	// finds loopback addresses that all land in one bucket
+	static void CollidingAddrs(NETADDR *pAddrs, int Num)
+	{
+		NETADDR Addr;
+		net_addr_from_str(&Addr, "127.0.0.1");
+		Addr.port = 1;
+		const int Bucket = Hash(&Addr);
+		for(int Found = 0; Found < Num; Addr.port++)
+		{
+			if(Hash(&Addr) == Bucket)
+				pAddrs[Found++] = Addr;
+		}
+	}
+
+	// finds a loopback address in another bucket than the given one
+	static NETADDR OtherBucketAddr(const NETADDR *pAddr)
+	{
+		NETADDR Addr = *pAddr;
+		do
+			Addr.port++;
+		while(Hash(&Addr) == Hash(pAddr));
+		return Addr;
+	}
+};
+
+TEST_F(CNetServerIndex, Collisions)
+{
+	NETADDR aAddrs[4];
+	CollidingAddrs(aAddrs, 4);
+	const int Bucket = Hash(&aAddrs[0]);
+
+	Connect(3, &aAddrs[0]);
+	Connect(7, &aAddrs[1]);
+	Connect(11, &aAddrs[2]);
+
+	EXPECT_EQ(BucketLength(Bucket), 3);
+	EXPECT_EQ(Find(&aAddrs[0]), 3);
+	EXPECT_EQ(Find(&aAddrs[1]), 7);
+	EXPECT_EQ(Find(&aAddrs[2]), 11);
+	EXPECT_EQ(Find(&aAddrs[3]), -1);
+}
+
+TEST_F(CNetServerIndex, UnhashMiddle)
+{
+	NETADDR aAddrs[3];
+	CollidingAddrs(aAddrs, 3);
+	const int Bucket = Hash(&aAddrs[0]);
+
+	// the slots are put in front of the chain, so slot 1 ends up in its middle
+	Connect(0, &aAddrs[0]);
+	Connect(1, &aAddrs[1]);
+	Connect(2, &aAddrs[2]);
+	ASSERT_EQ(FirstInBucket(Bucket), 2);
+
+	Drop(1);
+	EXPECT_EQ(SlotBucket(1), -1);
+	EXPECT_EQ(BucketLength(Bucket), 2);
+	EXPECT_EQ(Find(&aAddrs[0]), 0);
+	EXPECT_EQ(Find(&aAddrs[1]), -1);
+	EXPECT_EQ(Find(&aAddrs[2]), 2);
+
+	// the head and the tail unhash as well
+	Drop(2);
+	EXPECT_EQ(FirstInBucket(Bucket), 0);
+	EXPECT_EQ(Find(&aAddrs[0]), 0);
+	Drop(0);
+	EXPECT_EQ(FirstInBucket(Bucket), -1);
+	EXPECT_EQ(Find(&aAddrs[0]), -1);
+}
+
+TEST_F(CNetServerIndex, ReuseSlot)
+{
+	NETADDR aAddrs[2];
+	CollidingAddrs(aAddrs, 2);
+	const NETADDR Other = OtherBucketAddr(&aAddrs[0]);
+
+	Connect(5, &aAddrs[0]);
+	Drop(5);
+
+	// a different address in another bucket
+	Connect(5, &Other);
+	EXPECT_EQ(Find(&aAddrs[0]), -1);
+	EXPECT_EQ(Find(&Other), 5);
+	EXPECT_EQ(FirstInBucket(Hash(&aAddrs[0])), -1);
+	EXPECT_EQ(SlotBucket(5), Hash(&Other));
+	Drop(5);
+
+	// a different address in the same bucket
+	Connect(5, &aAddrs[1]);
+	EXPECT_EQ(Find(&aAddrs[0]), -1);
+	EXPECT_EQ(Find(&aAddrs[1]), 5);
+	EXPECT_EQ(BucketLength(Hash(&aAddrs[0])), 1);
+	EXPECT_EQ(Find(&Other), -1);
+}
@@ -0,0 +1,601 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/message.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/config.h>
+#include <engine/shared/network.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+#include <game/version.h>
+#include <generated/protocol.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/*
+	Load test
+		Headless clients that speak the 0.7 protocol to a server, they log in (the accounts
+		are registered on the first run), walk, shoot, hook and open the vote menus.
+		The snapshots are unpacked and acked as by the real client, so the server sends deltas.
+		Put crapnet between the clients and the server to add latency and loss.
+
+		load_test -s 127.0.0.1:8303 -n 64 -t 60 -r <rcon password>
+
+		-s <address>	server address
+		-n <num>		number of clients
+		-t <seconds>	duration of the test
+		-c <ms>			delay between the connects of the clients
+		-a <prefix>		prefix of the account names, the client index is added
+		-w <password>	password of the accounts
+		-r <password>	rcon password, the server profiler is reset at the start and printed at the end
+		-f <filter>		filter of the printed profiler sections
+		-m				announce the clients as mmo clients
+*/
+
+static NETADDR s_ServerAddr;
+static int s_NumClients = 16;
+static int s_Duration = 60;
+static int s_ConnectDelay = 50;
+static const char *s_pAccountPrefix = "loadtest";
+static const char *s_pAccountPassword = "loadtest";
+static const char *s_pRconPassword = "";
+static const char *s_pProfilerFilter = "tick";
+static bool s_MmoClients = false;
+
+static CSnapshotDelta s_SnapshotDelta;
+
+// distributions and counters of all clients
+static std::vector<int> s_aLatencies;
+static std::vector<int> s_aSnapIntervals;
+static int s_NumConnected = 0;
+static int s_NumEntered = 0;
+static int s_NumDropped = 0;
+static int s_NumSnapshots = 0;
+static int s_NumSnapErrors = 0;
+static int s_NumVotes = 0;
+
+class CFakeClient
+{
+	enum
+	{
+		STATE_OFFLINE = 0,
+		STATE_CONNECTING,
+		STATE_LOADING,
+		STATE_INGAME,
+	};
+
+	int m_Index;
+	int m_State;
+	char m_aName[16];
+	CNetClient m_Net;
+
+	// snapshots
+	CSnapshotStorage m_Snapshots;
+	char m_aSnapshotIncomingData[CSnapshot::MAX_SIZE];
+	unsigned m_SnapshotParts;
+	int m_CurrentRecvTick;
+	int m_AckGameTick;
+	int64 m_LastSnapshotTime;
+
+	// behaviour
+	CNetObj_PlayerInput m_Input;
+	float m_TargetAngle;
+	int64 m_NextInput;
+	int64 m_NextMove;
+	int64 m_NextPing;
+	int64 m_PingSent;
+	int64 m_EnterTime;
+	int64 m_NextVote;
+	int m_LoginStep;
+	bool m_RconSent;
+	std::vector<std::string> m_aVoteOptions;
+
+	template<class T>
+	void SendPackMsg(T *pMsg, int Flags)
+	{
+		CMsgPacker Packer(pMsg->MsgID(), false);
+		if(pMsg->Pack(&Packer))
+			return;
+		SendMsg(&Packer, Flags);
+	}
+
+	void SendMsg(CMsgPacker *pMsg, int Flags)
+	{
+		CNetChunk Packet;
+		mem_zero(&Packet, sizeof(Packet));
+		Packet.m_ClientID = 0;
+		Packet.m_pData = pMsg->Data();
+		Packet.m_DataSize = pMsg->Size();
+		if(Flags&MSGFLAG_VITAL)
+			Packet.m_Flags |= NETSENDFLAG_VITAL;
+		if(Flags&MSGFLAG_FLUSH)
+			Packet.m_Flags |= NETSENDFLAG_FLUSH;
+		m_Net.Send(&Packet);
+	}
+
+	void SendChat(const char *pText)
+	{
+		CNetMsg_Cl_Say Msg;
+		Msg.m_Mode = CHAT_ALL;
+		Msg.m_Target = -1;
+		Msg.m_pMessage = pText;
+		SendPackMsg(&Msg, MSGFLAG_VITAL);
+	}
+
+	void SendStartInfo()
+	{
+		static const char *s_apSkinParts[6] = { "standard", "", "", "standard", "standard", "standard" };
+
+		CNetMsg_Cl_StartInfo Msg;
+		Msg.m_pName = m_aName;
+		Msg.m_pClan = "";
+		Msg.m_Country = -1;
+		for(int p = 0; p < 6; p++)
+		{
+			Msg.m_apSkinPartNames[p] = s_apSkinParts[p];
+			Msg.m_aUseCustomColors[p] = 0;
+			Msg.m_aSkinPartColors[p] = 0;
+		}
+		SendPackMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+	}
+
+	void SendInput()
+	{
+		CMsgPacker Msg(NETMSG_INPUT, true);
+		Msg.AddInt(m_AckGameTick);
+		Msg.AddInt(m_CurrentRecvTick + 1);
+		Msg.AddInt(sizeof(m_Input));
+		const int *pData = (const int *)&m_Input;
+		for(unsigned i = 0; i < sizeof(m_Input) / sizeof(int); i++)
+			Msg.AddInt(pData[i]);
+		Msg.AddInt(0);
+		SendMsg(&Msg, MSGFLAG_FLUSH);
+	}
+
+	void OnSnapshot(int Msg, CUnpacker *pUnpacker, int64 Now)
+	{
+		int NumParts = 1;
+		int Part = 0;
+		const int GameTick = pUnpacker->GetInt();
+		const int DeltaTick = GameTick - pUnpacker->GetInt();
+		int PartSize = 0;
+		int Crc = 0;
+
+		if(Msg == NETMSG_SNAP)
+		{
+			NumParts = pUnpacker->GetInt();
+			Part = pUnpacker->GetInt();
+		}
+
+		if(Msg != NETMSG_SNAPEMPTY)
+		{
+			Crc = pUnpacker->GetInt();
+			PartSize = pUnpacker->GetInt();
+		}
+
+		const char *pData = (const char *)pUnpacker->GetRaw(PartSize);
+		if(pUnpacker->Error() || NumParts < 1 || NumParts > CSnapshot::MAX_PARTS || Part < 0 || Part >= NumParts || PartSize < 0 || PartSize > MAX_SNAPSHOT_PACKSIZE)
+			return;
+
+		if(GameTick < m_CurrentRecvTick)
+			return;
+
+		if(GameTick != m_CurrentRecvTick)
+		{
+			m_SnapshotParts = 0;
+			m_CurrentRecvTick = GameTick;
+		}
+
+		mem_copy(m_aSnapshotIncomingData + Part * MAX_SNAPSHOT_PACKSIZE, pData, PartSize);
+		m_SnapshotParts |= 1 << Part;
+		if(m_SnapshotParts != (unsigned)((1 << NumParts) - 1))
+			return;
+		m_SnapshotParts = 0;
+
+		// find the snapshot the server used for the delta
+		static CSnapshot s_EmptySnap;
+		s_EmptySnap.Clear();
+		CSnapshot *pDeltaShot = &s_EmptySnap;
+		if(DeltaTick >= 0 && m_Snapshots.Get(DeltaTick, 0, &pDeltaShot, 0) < 0)
+		{
+			// the server has to resend a full snapshot
+			m_AckGameTick = -1;
+			return;
+		}
+
+		// decompress and unpack
+		unsigned char aDeltaData[CSnapshot::MAX_SIZE];
+		unsigned char aSnapData[CSnapshot::MAX_SIZE];
+		CSnapshot *pSnap = (CSnapshot *)aSnapData;
+		const void *pDeltaData = s_SnapshotDelta.EmptyDelta();
+		int DeltaSize = sizeof(int) * 3;
+
+		const int CompleteSize = (NumParts - 1) * MAX_SNAPSHOT_PACKSIZE + PartSize;
+		if(CompleteSize)
+		{
+			DeltaSize = CVariableInt::Decompress(m_aSnapshotIncomingData, CompleteSize, aDeltaData, sizeof(aDeltaData));
+			if(DeltaSize < 0)
+				return;
+			pDeltaData = aDeltaData;
+		}
+
+		const int SnapSize = s_SnapshotDelta.UnpackDelta(pDeltaShot, pSnap, pDeltaData, DeltaSize);
+		if(SnapSize < 0 || (Msg != NETMSG_SNAPEMPTY && pSnap->Crc() != Crc))
+		{
+			s_NumSnapErrors++;
+			m_AckGameTick = -1;
+			return;
+		}
+
+		m_Snapshots.PurgeUntil(min(DeltaTick, m_AckGameTick));
+		m_Snapshots.Add(GameTick, Now, SnapSize, pSnap, 0);
+		m_AckGameTick = GameTick;
+
+		if(m_LastSnapshotTime)
+			s_aSnapIntervals.push_back((int)((Now - m_LastSnapshotTime) * 1000 / time_freq()));
+		m_LastSnapshotTime = Now;
+		s_NumSnapshots++;
+	}
+
+	void OnPacket(CNetChunk *pPacket, int64 Now)
+	{
+		CUnpacker Unpacker;
+		Unpacker.Reset(pPacket->m_pData, pPacket->m_DataSize);
+		int Msg = Unpacker.GetInt();
+		const int Sys = Msg&1;
+		Msg >>= 1;
+		if(Unpacker.Error())
+			return;
+
+		if(Sys)
+		{
+			if(Msg == NETMSG_MAP_CHANGE)
+			{
+				// the map is not needed, the server does not check the download
+				m_State = STATE_LOADING;
+				m_Snapshots.PurgeAll();
+				m_AckGameTick = -1;
+				CMsgPacker Ready(NETMSG_READY, true);
+				SendMsg(&Ready, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+			}
+			else if(Msg == NETMSG_CON_READY)
+				SendStartInfo();
+			else if(Msg == NETMSG_SNAP || Msg == NETMSG_SNAPSINGLE || Msg == NETMSG_SNAPEMPTY)
+				OnSnapshot(Msg, &Unpacker, Now);
+			else if(Msg == NETMSG_PING_REPLY && m_PingSent)
+			{
+				s_aLatencies.push_back((int)((Now - m_PingSent) * 1000 / time_freq()));
+				m_PingSent = 0;
+			}
+			else if(Msg == NETMSG_RCON_LINE)
+			{
+				const char *pLine = Unpacker.GetString();
+				if(!Unpacker.Error())
+					dbg_msg("rcon", "%s", pLine);
+			}
+			return;
+		}
+
+		if(Msg == NETMSGTYPE_SV_READYTOENTER)
+		{
+			CMsgPacker EnterGame(NETMSG_ENTERGAME, true);
+			SendMsg(&EnterGame, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+
+			if(m_State != STATE_INGAME && !m_EnterTime)
+			{
+				s_NumEntered++;
+				m_EnterTime = Now;
+				if(s_MmoClients)
+				{
+					CNetMsg_Cl_IsMmoServer IsMmo;
+					IsMmo.m_Version = PROTOCOL_VERSION_MMO;
+					SendPackMsg(&IsMmo, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+				}
+			}
+			m_State = STATE_INGAME;
+		}
+		else if(Msg == NETMSGTYPE_SV_VOTECLEAROPTIONS)
+			m_aVoteOptions.clear();
+		else if(Msg == NETMSGTYPE_SV_VOTEOPTIONADD)
+		{
+			const char *pDescription = Unpacker.GetString(CUnpacker::SANITIZE_CC);
+			if(!Unpacker.Error() && pDescription[0])
+				m_aVoteOptions.push_back(pDescription);
+		}
+	}
+
+	void Act(int64 Now)
+	{
+		// walk in one direction for a few seconds, jump, hook and shoot around
+		if(Now > m_NextMove)
+		{
+			m_Input.m_Direction = random_int() % 3 - 1;
+			m_Input.m_WantedWeapon = random_int() % 3 == 0 ? 1 + random_int() % NUM_WEAPONS : 0;
+			m_NextMove = Now + time_freq() * (1 + random_int() % 3);
+		}
+		m_TargetAngle += 0.05f;
+		m_Input.m_TargetX = (int)(cosf(m_TargetAngle) * 200.0f);
+		m_Input.m_TargetY = (int)(sinf(m_TargetAngle) * 200.0f);
+		m_Input.m_Jump = random_int() % 30 == 0;
+		if(random_int() % 8 == 0)
+			m_Input.m_Fire++;
+		if(random_int() % 40 == 0)
+			m_Input.m_Hook ^= 1;
+
+		// register on the first run, the login fails if the account is already there
+		const int64 Entered = Now - m_EnterTime;
+		char aBuf[128];
+		if(m_LoginStep == 0 && Entered > time_freq())
+		{
+			str_format(aBuf, sizeof(aBuf), "/register %s %s", m_aName, s_pAccountPassword);
+			SendChat(aBuf);
+			m_LoginStep++;
+		}
+		else if(m_LoginStep == 1 && Entered > time_freq() * 3)
+		{
+			str_format(aBuf, sizeof(aBuf), "/login %s %s", m_aName, s_pAccountPassword);
+			SendChat(aBuf);
+			m_LoginStep++;
+			m_NextVote = Now + time_freq() * 2;
+		}
+		else if(m_LoginStep == 2 && Now > m_NextVote)
+		{
+			if(!m_aVoteOptions.empty())
+			{
+				const std::string &Option = m_aVoteOptions[random_int() % m_aVoteOptions.size()];
+				CNetMsg_Cl_CallVote Msg;
+				Msg.m_Type = "option";
+				Msg.m_Value = Option.c_str();
+				Msg.m_Reason = "";
+				Msg.m_Force = 0;
+				SendPackMsg(&Msg, MSGFLAG_VITAL);
+				s_NumVotes++;
+			}
+			m_NextVote = Now + time_freq() * (2 + random_int() % 4);
+		}
+
+		// the first client reads the profiler of the server
+		if(m_Index == 0 && s_pRconPassword[0] && !m_RconSent)
+		{
+			CMsgPacker Auth(NETMSG_RCON_AUTH, true);
+			Auth.AddString(s_pRconPassword, 32);
+			SendMsg(&Auth, MSGFLAG_VITAL);
+			Rcon("profiler_reset");
+			m_RconSent = true;
+		}
+	}
+
+public:
+	void Init(int Index)
+	{
+		m_Index = Index;
+		m_State = STATE_OFFLINE;
+		str_format(m_aName, sizeof(m_aName), "%s%d", s_pAccountPrefix, Index);
+		m_Snapshots.Init();
+		m_SnapshotParts = 0;
+		m_CurrentRecvTick = 0;
+		m_AckGameTick = -1;
+		m_LastSnapshotTime = 0;
+		mem_zero(&m_Input, sizeof(m_Input));
+		m_TargetAngle = (random_int() % 628) / 100.0f;
+		m_NextInput = 0;
+		m_NextMove = 0;
+		m_NextPing = 0;
+		m_PingSent = 0;
+		m_EnterTime = 0;
+		m_NextVote = 0;
+		m_LoginStep = 0;
+		m_RconSent = false;
+	}
+
+	bool Connect()
+	{
+		NETADDR BindAddr;
+		mem_zero(&BindAddr, sizeof(BindAddr));
+		BindAddr.type = NETTYPE_ALL;
+		if(!m_Net.Open(BindAddr, NETCREATE_FLAG_RANDOMPORT))
+		{
+			dbg_msg("load_test", "client %d could not open a socket", m_Index);
+			return false;
+		}
+
+		m_Net.Connect(&s_ServerAddr);
+		m_State = STATE_CONNECTING;
+		return true;
+	}
+
+	void Rcon(const char *pCommand)
+	{
+		CMsgPacker Msg(NETMSG_RCON_CMD, true);
+		Msg.AddString(pCommand, 256);
+		SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+	}
+
+	void Update(int64 Now)
+	{
+		if(m_State == STATE_OFFLINE)
+			return;
+
+		m_Net.Update();
+		if(m_Net.State() == NETSTATE_OFFLINE)
+		{
+			dbg_msg("load_test", "client %d dropped: %s", m_Index, m_Net.ErrorString());
+			m_State = STATE_OFFLINE;
+			s_NumDropped++;
+			return;
+		}
+
+		if(m_State == STATE_CONNECTING && m_Net.State() == NETSTATE_ONLINE)
+		{
+			m_State = STATE_LOADING;
+			s_NumConnected++;
+
+			CMsgPacker Msg(NETMSG_INFO, true);
+			Msg.AddString(GAME_NETVERSION, 128);
+			Msg.AddString(g_Config.m_Password, 128);
+			Msg.AddInt(CLIENT_VERSION);
+			SendMsg(&Msg, MSGFLAG_VITAL|MSGFLAG_FLUSH);
+		}
+
+		CNetChunk Packet;
+		while(m_Net.Recv(&Packet))
+		{
+			if(!(Packet.m_Flags&NETSENDFLAG_CONNLESS))
+				OnPacket(&Packet, Now);
+		}
+
+		if(m_State != STATE_INGAME)
+			return;
+
+		if(Now > m_NextPing)
+		{
+			CMsgPacker Msg(NETMSG_PING, true);
+			SendMsg(&Msg, MSGFLAG_FLUSH);
+			m_PingSent = Now;
+			m_NextPing = Now + time_freq();
+		}
+
+		if(Now > m_NextInput && m_CurrentRecvTick > 0)
+		{
+			Act(Now);
+			SendInput();
+			m_NextInput = Now + time_freq() / SERVER_TICK_SPEED;
+		}
+	}
+
+	void Disconnect()
+	{
+		if(m_State != STATE_OFFLINE)
+			m_Net.Disconnect("load test finished");
+		m_Net.Close();
+		m_State = STATE_OFFLINE;
+	}
+};
+
+static void PrintDistribution(const char *pName, std::vector<int> &aSamples)
+{
+	if(aSamples.empty())
+	{
+		dbg_msg("load_test", "%s: no samples", pName);
+		return;
+	}
+
+	std::sort(aSamples.begin(), aSamples.end());
+	const int Num = (int)aSamples.size();
+	dbg_msg("load_test", "%s: samples=%d p50=%dms p90=%dms p99=%dms max=%dms", pName, Num,
+		aSamples[Num / 2], aSamples[(Num * 90) / 100], aSamples[(Num * 99) / 100], aSamples[Num - 1]);
+}
+
+static int Run()
+{
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+	{
+		static CNetObjHandler s_NetObjHandler;
+		s_SnapshotDelta.SetStaticsize(i, s_NetObjHandler.GetObjSize(i));
+	}
+
+	std::vector<CFakeClient> aClients(s_NumClients);
+	for(int i = 0; i < s_NumClients; i++)
+		aClients[i].Init(i);
+
+	NETSTATS StartStats;
+	net_stats(&StartStats);
+
+	const int64 Start = time_get();
+	const int64 End = Start + time_freq() * s_Duration;
+	int NumStarted = 0;
+	while(time_get() < End)
+	{
+		const int64 Now = time_get();
+
+		// connect the clients one by one, so the server is not flooded with handshakes
+		if(NumStarted < s_NumClients && Now >= Start + NumStarted * time_freq() * s_ConnectDelay / 1000)
+		{
+			if(!aClients[NumStarted].Connect())
+				return -1;
+			NumStarted++;
+		}
+
+		for(auto &Client : aClients)
+			Client.Update(Now);
+		thread_sleep(1);
+	}
+
+	NETSTATS EndStats;
+	net_stats(&EndStats);
+
+	// the profiler of the server while the clients are still connected
+	if(s_pRconPassword[0] && s_NumClients > 0)
+	{
+		char aCommand[128];
+		str_format(aCommand, sizeof(aCommand), "profiler %s", s_pProfilerFilter);
+		aClients[0].Rcon(aCommand);
+
+		const int64 WaitEnd = time_get() + time_freq();
+		while(time_get() < WaitEnd)
+		{
+			for(auto &Client : aClients)
+				Client.Update(time_get());
+			thread_sleep(1);
+		}
+	}
+
+	for(auto &Client : aClients)
+		Client.Disconnect();
+
+	const float Seconds = (float)s_Duration;
+	dbg_msg("load_test", "clients=%d connected=%d entered=%d dropped=%d duration=%ds", s_NumClients, s_NumConnected, s_NumEntered, s_NumDropped, s_Duration);
+	dbg_msg("load_test", "snapshots=%d snapshot errors=%d votes=%d", s_NumSnapshots, s_NumSnapErrors, s_NumVotes);
+	dbg_msg("load_test", "bandwidth in=%.1fKB/s (%d packets/s) out=%.1fKB/s (%d packets/s), in per client=%.1fKB/s",
+		(EndStats.recv_bytes - StartStats.recv_bytes) / 1024.0f / Seconds, (int)((EndStats.recv_packets - StartStats.recv_packets) / Seconds),
+		(EndStats.sent_bytes - StartStats.sent_bytes) / 1024.0f / Seconds, (int)((EndStats.sent_packets - StartStats.sent_packets) / Seconds),
+		(EndStats.recv_bytes - StartStats.recv_bytes) / 1024.0f / Seconds / max(s_NumClients, 1));
+	PrintDistribution("latency", s_aLatencies);
+	PrintDistribution("snapshot interval", s_aSnapIntervals);
+	return s_NumDropped > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	dbg_logger_stdout();
+	net_init();
+	CNetBase::Init();
+
+	const char *pServer = "127.0.0.1:8303";
+	for(int i = 1; i < argc; i++)
+	{
+		if(str_comp(argv[i], "-m") == 0)
+			s_MmoClients = true;
+		else if(i + 1 >= argc)
+			break;
+		else if(str_comp(argv[i], "-s") == 0)
+			pServer = argv[++i];
+		else if(str_comp(argv[i], "-n") == 0)
+			s_NumClients = clamp(str_toint(argv[++i]), 1, (int)MAX_CLIENTS);
+		else if(str_comp(argv[i], "-t") == 0)
+			s_Duration = max(str_toint(argv[++i]), 1);
+		else if(str_comp(argv[i], "-c") == 0)
+			s_ConnectDelay = max(str_toint(argv[++i]), 0);
+		else if(str_comp(argv[i], "-a") == 0)
+			s_pAccountPrefix = argv[++i];
+		else if(str_comp(argv[i], "-w") == 0)
+			s_pAccountPassword = argv[++i];
+		else if(str_comp(argv[i], "-r") == 0)
+			s_pRconPassword = argv[++i];
+		else if(str_comp(argv[i], "-f") == 0)
+			s_pProfilerFilter = argv[++i];
+	}
+
+	if(net_host_lookup(pServer, &s_ServerAddr, NETTYPE_ALL) != 0)
+	{
+		dbg_msg("load_test", "could not resolve '%s'", pServer);
+		return -1;
+	}
+	if(!s_ServerAddr.port)
+		s_ServerAddr.port = 8303;
+
+	return Run();
+}